@@ -22,6 +22,7 @@ SUBDIRS = \
     xdg-open \
     xdg-settings \
     display-server \
+    blight-trace \
     fbinfo \
     xclip \
     launcherctl
@@ -48,5 +49,6 @@ desktop-file-install.depends =
 inject_evdev.depends =
 display-server.depends = system-service
 fbinfo.depends =
+blight-trace.depends =
 xclip.depends = system-service
 INSTALLS += $$SUBDIRS
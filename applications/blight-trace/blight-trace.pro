@@ -0,0 +1,16 @@
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+SOURCES += \
+        main.cpp
+
+HEADERS +=
+
+TARGET = blight-trace
+include(../../qmake/common.pri)
+target.path = $$BIN_INSTALL_PATH
+INSTALLS += target
+
+include(../../qmake/libblight.pri)
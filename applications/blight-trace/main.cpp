@@ -0,0 +1,159 @@
+#include <libblight/trace.h>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+#include <vector>
+
+#include "../../shared/liboxide/meta.h"
+
+using namespace Blight;
+
+// Histogram buckets double in size, starting at 250us
+#define BUCKET_COUNT 14
+#define BUCKET_START 0.25
+
+QString
+processName(pid_t pid) {
+  QFile file(QString("/proc/%1/comm").arg(pid));
+  if (!file.open(QFile::ReadOnly)) {
+    return "(exited)";
+  }
+  return QString::fromLocal8Bit(file.readAll()).trimmed();
+}
+
+double
+percentile(const std::vector<double>& sorted, double percent) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t index = (size_t)(percent / 100.0 * (sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void
+printHistogram(QTextStream& out, const std::vector<double>& sorted) {
+  size_t buckets[BUCKET_COUNT] = {0};
+  for (auto value : sorted) {
+    int bucket = 0;
+    double limit = BUCKET_START;
+    while (bucket < BUCKET_COUNT - 1 && value >= limit) {
+      bucket++;
+      limit *= 2;
+    }
+    buckets[bucket]++;
+  }
+  auto max = *std::max_element(buckets, buckets + BUCKET_COUNT);
+  double limit = BUCKET_START;
+  for (int i = 0; i < BUCKET_COUNT; i++, limit *= 2) {
+    if (!buckets[i]) {
+      continue;
+    }
+    auto label = i < BUCKET_COUNT - 1
+                   ? QString("< %1ms").arg(limit)
+                   : QString(">= %1ms").arg(limit / 2);
+    out << "    " << label.leftJustified(12) << " "
+        << QString::number(buckets[i]).rightJustified(6) << " "
+        << QString(buckets[i] * 40 / max, '#') << Qt::endl;
+  }
+}
+
+void
+printProcess(QTextStream& out, pid_t pid, bool histogram) {
+  auto samples = Trace::read(pid);
+  out << "[" << pid << " " << processName(pid) << "] " << samples.size()
+      << " samples" << Qt::endl;
+  if (samples.empty()) {
+    out << Qt::endl;
+    return;
+  }
+  out << "  " << QString("stage").leftJustified(16)
+      << QString("count").rightJustified(8) << QString("p50").rightJustified(10)
+      << QString("p90").rightJustified(10) << QString("p99").rightJustified(10)
+      << QString("max").rightJustified(10) << Qt::endl;
+  for (uint32_t stage = 0; stage < Trace::StageCount; stage++) {
+    std::vector<double> latencies;
+    for (auto& sample : samples) {
+      if (sample.stage != stage || sample.stamp < sample.input) {
+        continue;
+      }
+      latencies.push_back((sample.stamp - sample.input) / 1000000.0);
+    }
+    if (latencies.empty()) {
+      continue;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    QString name = Trace::stage_name((Trace::Stage)stage);
+    out << "  " << name.leftJustified(16)
+        << QString::number(latencies.size()).rightJustified(8);
+    for (auto percent : {50.0, 90.0, 99.0, 100.0}) {
+      out << QString::number(percentile(latencies, percent), 'f', 2)
+               .rightJustified(10);
+    }
+    out << Qt::endl;
+    if (histogram) {
+      printHistogram(out, latencies);
+    }
+  }
+  out << Qt::endl;
+}
+
+int
+main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  app.setOrganizationName("Eeems");
+  app.setOrganizationDomain(OXIDE_SERVICE);
+  app.setApplicationName("blight-trace");
+  app.setApplicationVersion(APP_VERSION);
+  QCommandLineParser parser;
+  parser.setApplicationDescription(
+    "Dump input latency traces recorded by processes run with "
+    "OXIDE_BLIGHT_TRACE set. Latencies are in milliseconds since the input "
+    "event was generated."
+  );
+  parser.addHelpOption();
+  parser.addVersionOption();
+  QCommandLineOption histogramOption(
+    {"H", "histogram"}, "Print a histogram for each stage."
+  );
+  parser.addOption(histogramOption);
+  QCommandLineOption removeOption(
+    {"r", "remove"}, "Remove the trace buffers after printing them."
+  );
+  parser.addOption(removeOption);
+  parser.addPositionalArgument(
+    "pid",
+    "Process to dump, defaults to all processes with a trace.",
+    "[pid...]"
+  );
+  parser.process(app);
+  std::vector<pid_t> pids;
+  for (auto& arg : parser.positionalArguments()) {
+    bool ok;
+    auto pid = arg.toInt(&ok);
+    if (!ok || pid <= 0) {
+      qWarning() << "Invalid pid:" << arg;
+      return EXIT_FAILURE;
+    }
+    pids.push_back(pid);
+  }
+  if (pids.empty()) {
+    pids = Trace::processes();
+    std::sort(pids.begin(), pids.end());
+  }
+  if (pids.empty()) {
+    qWarning() << "No trace buffers found";
+    return EXIT_FAILURE;
+  }
+  QTextStream out(stdout);
+  for (auto pid : pids) {
+    printProcess(out, pid, parser.isSet(histogramOption));
+    if (parser.isSet(removeOption)) {
+      Trace::remove(pid);
+    }
+  }
+  return EXIT_SUCCESS;
+}
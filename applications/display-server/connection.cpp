@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <assert.h>
 #include <libblight/socket.h>
+#include <libblight/trace.h>
 #include <liboxide/debug.h>
 #include <liboxide/signalhandler.h>
 #include <memory>
@@ -22,8 +23,6 @@
 
 #ifdef EPAPER
 #include <fcntl.h>
-#include <liboxide/devicesettings.h>
-#include <mxcfb.h>
 
 #include "guithread.h"
 #endif
@@ -49,6 +48,13 @@ Connection::Connection(pid_t pid, pid_t pgid)
   , m_closed{false}
   , pingId{0}
   , m_surfaceId{0} {
+  m_statFd = ::open(
+    QString("/proc/%1/stat").arg(m_pid).toLocal8Bit().constData(),
+    O_RDONLY | O_CLOEXEC
+  );
+  if (m_statFd < 0) {
+    O_WARNING("Failed to open process status" << std::strerror(errno));
+  }
   m_pidFd = pidfd_open(m_pid, 0);
   if (m_pidFd < 0) {
     O_WARNING(std::strerror(errno));
@@ -68,6 +74,7 @@ Connection::Connection(pid_t pid, pid_t pgid)
   m_clientFd = fds[0];
   m_serverFd = fds[1];
   if (m_serverFd > 0) {
+    m_reader = std::make_unique<BlightProtocol::MessageReader>(m_serverFd);
     m_notifier = new QSocketNotifier(m_serverFd, QSocketNotifier::Read, this);
     connect(
       m_notifier, &QSocketNotifier::activated, this, &Connection::readSocket
@@ -118,6 +125,9 @@ Connection::~Connection() {
   ::close(m_clientFd);
   ::close(m_serverFd);
   ::close(m_pidFd);
+  if (m_statFd >= 0) {
+    ::close(m_statFd);
+  }
   C_INFO("Connection destroyed");
 }
 
@@ -142,21 +152,26 @@ Connection::socketDescriptor() {
 }
 
 int
-Connection::inputFd(unsigned short device) {
+Connection::inputFd(unsigned short device, unsigned int capacity) {
+  QWriteLocker _locker(&inputBuffersLock);
   if (m_inputBuffers.contains(device)) {
     return m_inputBuffers[device].fd;
   }
   if (!QFile::exists(QStringLiteral("/dev/input/event%1").arg(device))) {
     return -1;
   }
-  auto [fd, buffer] = Blight::EvdevRingBuffer::createSharedMemory(true);
+  auto [fd, buffer] =
+    Blight::EvdevRingBuffer::createSharedMemory(true, capacity);
   if (fd < 0 || buffer == nullptr) {
     C_WARNING("Failed to create input buffer for event" << device)
     return -1;
   }
   m_inputBuffers[device] = {fd, buffer};
   buffer->insert({.type = EV_SYN, .code = SYN_DROPPED});
-  C_DEBUG("Created input buffer for event" << device << " (fd=" << fd << ")");
+  C_DEBUG(
+    "Created input buffer for event"
+    << device << " (fd=" << fd << ", capacity=" << buffer->capacity() << ")"
+  );
   return fd;
 }
 
@@ -172,17 +187,21 @@ Connection::isRunning() {
 
 bool
 Connection::isStopped() {
-  QFile file(QString("/proc/%1/stat").arg(m_pid));
-  if (!file.open(QFile::ReadOnly)) {
-    O_WARNING("Failed checking process status" << file.errorString());
+  // This is checked for every input frame, so avoid reopening the file and
+  // allocating each time. The state follows the last ')' in the file.
+  if (m_statFd < 0) {
     return false;
   }
-  auto data = file.readAll();
-  int idx = data.lastIndexOf(')');
-  if (idx < 0 || idx + 2 >= data.size()) {
+  char data[512];
+  ssize_t size = ::pread(m_statFd, data, sizeof(data), 0);
+  if (size <= 0) {
     return false;
   }
-  return data.at(idx + 2) == 'T';
+  auto end = static_cast<const char*>(memrchr(data, ')', size));
+  if (end == nullptr || end + 2 >= data + size) {
+    return false;
+  }
+  return end[2] == 'T';
 }
 
 bool
@@ -370,6 +389,7 @@ Connection::removeSurface(Blight::surface_id_t id) {
     };
     send(header, reinterpret_cast<Blight::data_t>(&id), sizeof(id));
   }
+  dbusInterface->updateScene();
 }
 
 std::shared_ptr<Surface>
@@ -429,23 +449,45 @@ Connection::inputEvents(
   const std::vector<input_event>& events
 ) {
   if (!isRunning() || isStopped()) {
-    dbusInterface->sortZ();
+    // Called from the input thread, focus needs to be updated on the main
+    // thread
+    dbusInterface->requestSortZ();
     return;
   }
   if (!events.size()) {
     return;
   }
-  if (!m_inputBuffers.contains(device)) {
+  QReadLocker _locker(&inputBuffersLock);
+  auto item = m_inputBuffers.find(device);
+  if (item == m_inputBuffers.end()) {
     return;
   }
-  auto* buffer = m_inputBuffers[device].buffer;
+  auto* buffer = item->second.buffer;
   if (buffer == nullptr) {
     C_WARNING("event" << device << " buffer is nullptr");
     return;
   }
   C_DEBUG("Writing" << events.size() << "input events to device" << device);
-  for (const auto& ev : events) {
-    buffer->insert(ev);
+  // Publish a whole SYN_REPORT frame at a time so that the client never
+  // wakes up to a partial frame
+  auto dropped = buffer->dropped();
+  size_t start = 0;
+  for (size_t i = 0; i < events.size(); i++) {
+    const auto& ev = events[i];
+    if (ev.type == EV_SYN && ev.code == SYN_REPORT) {
+      buffer->insert_range(&events[start], i - start + 1);
+      Blight::Trace::input(Blight::Trace::RingInsert, ev.time);
+      start = i + 1;
+    }
+  }
+  if (start < events.size()) {
+    buffer->insert_range(&events[start], events.size() - start);
+  }
+  if (buffer->dropped() != dropped) {
+    C_DEBUG(
+      "event" << device << " buffer is full, dropped"
+              << buffer->dropped() - dropped << "input events"
+    );
   }
 }
 
@@ -477,7 +519,7 @@ Connection::readSocket() {
   C_DEBUG("Data received");
 #endif
   while (true) {
-    auto message = Blight::message_t::from_socket(m_serverFd);
+    auto message = Blight::message_t::from_reader(*m_reader);
     if (
       message == nullptr || message->header.type == Blight::MessageType::Invalid
     ) {
@@ -537,6 +579,46 @@ Connection::readSocket() {
         );
 #else
         emit surface->update(rect);
+#endif
+        do_ack = false;
+        break;
+      }
+      case Blight::MessageType::RepaintRegion: {
+        auto maybe = Blight::repaint_region_t::from_message(message.get());
+        if (!maybe.has_value()) {
+          C_WARNING("Malformed repaint region message");
+          break;
+        }
+        auto& repaint = maybe.value();
+        QRegion region;
+        for (auto& rect : repaint.rects) {
+          region += QRect(rect.x, rect.y, rect.width, rect.height);
+        }
+        C_DEBUG(
+          "Repaint region requested:"
+          << repaint.identifier << region << repaint.waveform
+          << repaint.contenttype << repaint.mode << repaint.marker
+        );
+        auto surface = getSurface(repaint.identifier);
+        if (surface == nullptr) {
+          C_WARNING("Could not find surface" << repaint.identifier);
+          break;
+        }
+#ifdef EPAPER
+        guiThread->enqueue(
+          surface,
+          region,
+          repaint.waveform,
+          repaint.contenttype,
+          repaint.mode,
+          repaint.marker,
+          false,
+          [message, this] { ack(message, 0, nullptr); }
+        );
+#else
+        for (const QRect& rect : std::as_const(region)) {
+          emit surface->update(rect);
+        }
 #endif
         do_ack = false;
         break;
@@ -585,6 +667,22 @@ Connection::readSocket() {
         do_ack = false;
         break;
       }
+      case Blight::MessageType::InkOverlay: {
+        auto overlay = Blight::ink_overlay_t::from_message(message.get());
+        C_DEBUG(
+          "Ink overlay requested:" << overlay.identifier << overlay.enabled
+                                   << overlay.width << overlay.prediction
+        );
+        auto surface = getSurface(overlay.identifier);
+        if (surface == nullptr) {
+          C_WARNING("Could not find surface" << overlay.identifier);
+          break;
+        }
+        surface->setInkOverlay(
+          overlay.enabled, overlay.width, overlay.prediction
+        );
+        break;
+      }
       case Blight::MessageType::Info: {
         auto identifier =
           Blight::scalar_cast<Blight::surface_id_t>(message).value();
@@ -703,26 +801,26 @@ Connection::readSocket() {
       }
       case Blight::MessageType::Wait: {
 #ifdef EPAPER
-        C_DEBUG("Wait requested");
-#ifdef __arm__
-        if (
-          deviceSettings.getDeviceType() ==
-          Oxide::DeviceSettings::DeviceType::RM1
-        ) {
-          auto marker = Blight::scalar_cast<unsigned int>(message);
-          if (marker.has_value()) {
-            int fb = open("/dev/fb0", O_RDWR);
-            if (fb >= 0) {
-              mxcfb_update_marker_data data{marker.value(), 0};
-              if (::ioctl(fb, MXCFB_WAIT_FOR_UPDATE_COMPLETE, &data) == 0) {
-                ::close(fb);
-                break;
-              }
+        auto marker = Blight::scalar_cast<unsigned int>(message);
+        C_DEBUG("Wait requested" << marker.value_or(0));
+        auto connection = dbusInterface->getConnection(this);
+        if (connection == nullptr) {
+          // Being torn down, there is nothing left to wait for
+          break;
+        }
+        // Acked from the completion thread once the update that drew the
+        // marker is on the screen, unless the connection has gone by then
+        guiThread->waitForMarker(
+          this,
+          marker.value_or(0),
+          [message, weak = std::weak_ptr<Connection>(connection)] {
+            auto alive = weak.lock();
+            if (alive != nullptr) {
+              alive->ack(message, 0, nullptr);
             }
           }
-        }
-#endif
-        EPFramebuffer::instance()->sync();
+        );
+        do_ack = false;
 #endif
         break;
       }
@@ -818,18 +916,13 @@ Connection::ping() {
 
 bool
 Connection::send(Blight::header_t header, Blight::data_t data, ssize_t size) {
-  if (!Blight::send_blocking(
-        m_serverFd,
-        reinterpret_cast<Blight::data_t>(&header),
-        sizeof(Blight::header_t)
-      )) {
-    C_WARNING("Failed to write message header:" << strerror(errno));
-    return false;
-  }
-  if (
-    data != nullptr && size && !Blight::send_blocking(m_serverFd, data, size)
-  ) {
-    C_WARNING("Failed to write message data:" << strerror(errno));
+  iovec iov[2];
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(Blight::header_t);
+  iov[1].iov_base = data;
+  iov[1].iov_len = data != nullptr && size ? size : 0;
+  if (!BlightProtocol::send_blocking(m_serverFd, iov, 2)) {
+    C_WARNING("Failed to write message:" << strerror(errno));
     return false;
   }
   return true;
@@ -2,6 +2,7 @@
 
 #include <libblight/connection.h>
 #include <libblight_protocol/ringbuffer.h>
+#include <libblight_protocol/socket.h>
 #include <linux/input.h>
 
 #include <QFile>
@@ -41,7 +42,10 @@ public:
   pid_t pid() const;
   pid_t pgid() const;
   int socketDescriptor();
-  int inputFd(unsigned short device);
+  int inputFd(
+    unsigned short device,
+    unsigned int capacity = BlightProtocol::EVDEV_RING_BUFFER_SIZE
+  );
   bool isValid();
   bool isRunning();
   bool isStopped();
@@ -85,13 +89,16 @@ private:
   pid_t m_pid;
   pid_t m_pgid;
   int m_pidFd;
+  int m_statFd;
   QFile m_process;
   int m_clientFd;
   int m_serverFd;
+  std::unique_ptr<BlightProtocol::MessageReader> m_reader;
   QSocketNotifier* m_notifier = nullptr;
   QLocalSocket m_pidNotifier;
   QReadWriteLock surfacesLock;
   std::map<Blight::surface_id_t, std::shared_ptr<Surface>> surfaces;
+  QReadWriteLock inputBuffersLock;
   std::map<unsigned short, DeviceInputBuffer> m_inputBuffers;
   std::atomic_flag m_closed;
   QTimer m_notRespondingTimer;
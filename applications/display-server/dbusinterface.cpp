@@ -7,8 +7,11 @@
 #include <liboxide/devicesettings.h>
 #include <liboxide/oxideqml.h>
 #include <liboxide/threading.h>
+#include <fcntl.h>
 #include <memory>
+#include <sys/mman.h>
 #include <sys/poll.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <algorithm>
@@ -30,6 +33,9 @@
 DbusInterface::DbusInterface(QObject* parent)
   : QObject(parent)
   , m_focused(nullptr)
+  , m_scene(std::make_shared<const SceneIndex>())
+  , m_inputRoute(std::make_shared<const InputRoute>())
+  , m_clipboardGeneration(0)
   , m_exclusiveMode{false} {
   auto type = qDBusRegisterMetaType<FrameBufferInfo>();
   if (!type.isValid()) {
@@ -110,6 +116,18 @@ DbusInterface::pid() {
   return qApp->applicationPid();
 }
 
+int
+DbusInterface::debugLevel() {
+  return get_blight_debug_level();
+}
+
+void
+DbusInterface::setDebugLevel(int level) {
+  O_INFO("Debug level set to" << level);
+  set_blight_debug_level(level);
+  Oxide::setDebugEnabled(level >= LOG_DEBUG);
+}
+
 #ifndef EPAPER
 QObject*
 DbusInterface::loadComponent(
@@ -191,6 +209,17 @@ DbusInterface::open(QDBusMessage message) {
 
 QDBusUnixFileDescriptor
 DbusInterface::openInput(unsigned short device, QDBusMessage message) {
+  return openInputWithCapacity(
+    device, BlightProtocol::EVDEV_RING_BUFFER_SIZE, message
+  );
+}
+
+QDBusUnixFileDescriptor
+DbusInterface::openInputWithCapacity(
+  unsigned short device,
+  unsigned int capacity,
+  QDBusMessage message
+) {
   auto connection = getConnection(message);
   if (connection == nullptr) {
     sendErrorReply(
@@ -198,8 +227,18 @@ DbusInterface::openInput(unsigned short device, QDBusMessage message) {
     );
     return QDBusUnixFileDescriptor();
   }
-  O_INFO("Open input for: " << connection->pid() << " device: " << device);
-  int fd = connection->inputFd(device);
+  if (capacity > BlightProtocol::EVDEV_RING_BUFFER_MAX_SIZE) {
+    sendErrorReply(QDBusError::InvalidArgs, "Capacity is too large");
+    return QDBusUnixFileDescriptor();
+  }
+  if (capacity == 0) {
+    capacity = BlightProtocol::EVDEV_RING_BUFFER_SIZE;
+  }
+  O_INFO(
+    "Open input for: " << connection->pid() << " device: " << device
+                       << " capacity: " << capacity
+  );
+  int fd = connection->inputFd(device, capacity);
   if (fd < 0) {
     sendErrorReply(QDBusError::InvalidArgs, "Device not available");
     return QDBusUnixFileDescriptor();
@@ -608,6 +647,11 @@ DbusInterface::enterExclusiveMode(QDBusMessage message) {
   if (!m_exclusiveMode) {
     O_INFO("Entering exclusive mode");
     waitForNoRepaints(message);
+#ifdef EPAPER
+    // The exclusive connection draws into the shared framebuffer, make sure
+    // it starts with what is on the screen
+    guiThread->syncMirrors();
+#endif
     m_exclusiveMode = true;
     evdevHandler->clear_buffers();
   }
@@ -726,6 +770,15 @@ DbusInterface::connectionExists(QString identifier, QDBusMessage message) {
   return getConnection(identifier) != nullptr;
 }
 
+QVariantMap
+DbusInterface::repaintQueueDelays() {
+#ifdef EPAPER
+  return guiThread->repaintQueueDelays();
+#else
+  return QVariantMap();
+#endif
+}
+
 std::shared_ptr<Connection>
 DbusInterface::focused() {
   return m_focused;
@@ -734,6 +787,7 @@ DbusInterface::focused() {
 void
 DbusInterface::setFocus(std::shared_ptr<Connection> connection) {
   m_focused = connection;
+  updateInputRoute();
   if (m_focused != nullptr) {
     O_INFO(m_focused->id() << "has focus");
   } else {
@@ -760,19 +814,13 @@ DbusInterface::inputEvents(
   unsigned int device,
   const std::vector<input_event>& events
 ) {
-  if (m_focused != nullptr) {
-    m_focused->inputEvents(device, events);
-  }
-  QList<std::shared_ptr<Connection>> systemConnections;
-  {
-    QReadLocker _locker(&connectionsLock);
-    for (auto connection : std::as_const(connections)) {
-      if (connection->has("system")) {
-        systemConnections.append(connection);
-      }
-    }
+  // This is called from the input thread, so it only uses the published
+  // route instead of touching m_focused or the connection list
+  auto route = inputRoute();
+  if (route->focused != nullptr) {
+    route->focused->inputEvents(device, events);
   }
-  for (auto connection : std::as_const(systemConnections)) {
+  for (auto& connection : route->system) {
     connection->inputEvents(device, events);
   }
 }
@@ -907,13 +955,14 @@ DbusInterface::createConnection(int pid) {
     if (connection == nullptr) {
       return;
     }
-    QReadLocker _locker(&connectionsLock);
-    for (auto& ptr : std::as_const(connections)) {
-      if (ptr == connection && !ptr->has("system")) {
-        setFocus(ptr);
-        break;
+    {
+      // setFocus updates the input route, which takes the lock again
+      QReadLocker _locker(&connectionsLock);
+      if (!connections.contains(connection) || connection->has("system")) {
+        return;
       }
     }
+    setFocus(connection);
   });
   {
     QReadLocker _locker(&connectionsLock);
@@ -947,13 +996,16 @@ DbusInterface::hasRunningConnection(pid_t pgid) {
 
 void
 DbusInterface::removeSurface(QString identifier) {
-  QReadLocker _locker(&connectionsLock);
-  for (auto& connection : std::as_const(connections)) {
-    auto surface = connection->getSurface(identifier);
-    if (surface != nullptr) {
-      connection->removeSurface(surface->identifier());
+  {
+    QReadLocker _locker(&connectionsLock);
+    for (auto& connection : std::as_const(connections)) {
+      auto surface = connection->getSurface(identifier);
+      if (surface != nullptr) {
+        connection->removeSurface(surface->identifier());
+      }
     }
   }
+  updateScene();
 }
 
 QList<std::shared_ptr<Surface>>
@@ -1013,37 +1065,343 @@ DbusInterface::visibleSurfaces() {
   return surfaces;
 }
 
-const QByteArray&
+std::shared_ptr<const SceneIndex>
+DbusInterface::scene() {
+  return std::atomic_load(&m_scene);
+}
+
+void
+DbusInterface::updateScene() {
+  // This is where all the process checks happen, so that the repaint path
+  // can use the result without needing to make any syscalls
+  auto scene = std::make_shared<SceneIndex>();
+  for (auto& surface : visibleSurfaces()) {
+    auto connection = surface->connection();
+    if (!surface->has("system") && getpgid(connection->pgid()) < 0) {
+      O_WARNING(surface->id() << "With no running process");
+      continue;
+    }
+    auto image = surface->image();
+    if (image == nullptr || image->isNull()) {
+      O_WARNING(surface->id() << "Null framebuffer");
+      continue;
+    }
+    scene->surfaces.append(surface);
+    scene->opaque.append(!image->hasAlphaChannel());
+  }
+  std::atomic_store(&m_scene, std::shared_ptr<const SceneIndex>(scene));
+}
+
+std::shared_ptr<const InputRoute>
+DbusInterface::inputRoute() {
+  return std::atomic_load(&m_inputRoute);
+}
+
+void
+DbusInterface::updateInputRoute() {
+  auto route = std::make_shared<InputRoute>();
+  route->focused = m_focused;
+  {
+    QReadLocker _locker(&connectionsLock);
+    for (auto& connection : std::as_const(connections)) {
+      if (connection->has("system")) {
+        route->system.append(connection);
+      }
+    }
+  }
+  std::atomic_store(
+    &m_inputRoute, std::shared_ptr<const InputRoute>(route)
+  );
+}
+
+#define CLIPBOARD_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE)
+// Largest clipboard the display server will hold on to
+#define CLIPBOARD_MAX_SIZE (64 * 1024 * 1024)
+// Size of the buffer used to copy clipboards from unsealed fds
+#define CLIPBOARD_COPY_CHUNK 65536
+
+static int
+openClipboardMemfd(const QString& name) {
+  int fd = memfd_create(
+    ("clipboard-" + name).toStdString().c_str(),
+    MFD_CLOEXEC | MFD_ALLOW_SEALING
+  );
+  if (fd == -1) {
+    O_WARNING("Failed to create memfd for" << name << strerror(errno));
+  }
+  return fd;
+}
+
+static bool
+writeClipboardMemfd(
+  int fd,
+  const QString& name,
+  const char* data,
+  size_t size
+) {
+  size_t written = 0;
+  while (written < size) {
+    auto res = ::write(fd, data + written, size - written);
+    if (res == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      O_WARNING("Failed to write to memfd for" << name << strerror(errno));
+      return false;
+    }
+    written += res;
+  }
+  return true;
+}
+
+static QDBusUnixFileDescriptor
+sealClipboardMemfd(int fd, const QString& name) {
+  if (fcntl(fd, F_ADD_SEALS, CLIPBOARD_SEALS | F_SEAL_SEAL) == -1) {
+    O_WARNING("Failed to seal memfd for" << name << strerror(errno));
+    ::close(fd);
+    return QDBusUnixFileDescriptor();
+  }
+  QDBusUnixFileDescriptor result;
+  result.giveFileDescriptor(fd);
+  return result;
+}
+
+static QDBusUnixFileDescriptor
+createClipboardMemfd(const QString& name, const char* data, size_t size) {
+  int fd = openClipboardMemfd(name);
+  if (fd == -1) {
+    return QDBusUnixFileDescriptor();
+  }
+  if (!writeClipboardMemfd(fd, name, data, size)) {
+    ::close(fd);
+    return QDBusUnixFileDescriptor();
+  }
+  return sealClipboardMemfd(fd, name);
+}
+
+// Copies with pread instead of mapping the source, so that the sender
+// truncating it part way through can't fault the display server
+static QDBusUnixFileDescriptor
+copyClipboardFd(
+  const QString& name,
+  int source,
+  size_t size,
+  qulonglong& copied
+) {
+  copied = 0;
+  int fd = openClipboardMemfd(name);
+  if (fd == -1) {
+    return QDBusUnixFileDescriptor();
+  }
+  char buffer[CLIPBOARD_COPY_CHUNK];
+  while (copied < size) {
+    auto res = ::pread(
+      source, buffer, std::min(sizeof(buffer), size - copied), copied
+    );
+    if (res == -1 && errno == EINTR) {
+      continue;
+    }
+    if (res == -1) {
+      O_WARNING("Failed to read clipboard for" << name << strerror(errno));
+      ::close(fd);
+      return QDBusUnixFileDescriptor();
+    }
+    if (res == 0) {
+      // Truncated while copying, keep what was there
+      break;
+    }
+    if (!writeClipboardMemfd(fd, name, buffer, res)) {
+      ::close(fd);
+      return QDBusUnixFileDescriptor();
+    }
+    copied += res;
+  }
+  return sealClipboardMemfd(fd, name);
+}
+
+ClipboardData*
+DbusInterface::getClipboardData(const QString& name) {
+  if (name == "clipboard") {
+    return &clipboards.clipboard;
+  }
+  if (name == "selection") {
+    return &clipboards.selection;
+  }
+  if (name == "secondary") {
+    return &clipboards.secondary;
+  }
+  return nullptr;
+}
+
+QByteArray
+DbusInterface::readClipboard(const ClipboardData& data) {
+  if (!data.fd.isValid() || !data.size) {
+    return QByteArray();
+  }
+  QByteArray result(data.size, Qt::Uninitialized);
+  size_t offset = 0;
+  while (offset < data.size) {
+    auto res = ::pread(
+      data.fd.fileDescriptor(),
+      result.data() + offset,
+      data.size - offset,
+      offset
+    );
+    if (res == -1 && errno == EINTR) {
+      continue;
+    }
+    if (res <= 0) {
+      O_WARNING("Failed to read clipboard memfd" << strerror(errno));
+      return QByteArray();
+    }
+    offset += res;
+  }
+  return result;
+}
+
+void
+DbusInterface::setClipboardData(
+  const QString& name,
+  QDBusUnixFileDescriptor fd,
+  qulonglong size,
+  const QString& mimeType
+) {
+  auto data = getClipboardData(name);
+  Q_ASSERT(data != nullptr);
+  data->fd = fd;
+  // Clients map size bytes, which must never be more than the fd holds
+  data->size = fd.isValid() ? size : 0;
+  data->mimeType = mimeType;
+  data->generation = ++m_clipboardGeneration;
+  // Only the generation is broadcast, listeners fetch the contents with
+  // openClipboard when they actually need them
+  if (data == &clipboards.clipboard) {
+    emit clipboardChanged(data->generation);
+  } else if (data == &clipboards.selection) {
+    emit selectionChanged(data->generation);
+  } else {
+    emit secondaryChanged(data->generation);
+  }
+}
+
+QByteArray
 DbusInterface::clipboard() {
-  return clipboards.clipboard;
+  return readClipboard(clipboards.clipboard);
 }
 
 void
 DbusInterface::setClipboard(const QByteArray& data) {
-  clipboards.clipboard = data;
-  emit clipboardChanged(clipboard());
+  setClipboardData(
+    "clipboard",
+    createClipboardMemfd("clipboard", data.constData(), data.size()),
+    data.size(),
+    "application/octet-stream"
+  );
 }
 
-const QByteArray&
+QByteArray
 DbusInterface::selection() {
-  return clipboards.selection;
+  return readClipboard(clipboards.selection);
 }
 
 void
 DbusInterface::setSelection(const QByteArray& data) {
-  clipboards.selection = data;
-  emit selectionChanged(selection());
+  setClipboardData(
+    "selection",
+    createClipboardMemfd("selection", data.constData(), data.size()),
+    data.size(),
+    "application/octet-stream"
+  );
 }
 
-const QByteArray&
+QByteArray
 DbusInterface::secondary() {
-  return clipboards.secondary;
+  return readClipboard(clipboards.secondary);
 }
 
 void
 DbusInterface::setSecondary(const QByteArray& data) {
-  clipboards.secondary = data;
-  emit secondaryChanged(secondary());
+  setClipboardData(
+    "secondary",
+    createClipboardMemfd("secondary", data.constData(), data.size()),
+    data.size(),
+    "application/octet-stream"
+  );
+}
+
+QDBusUnixFileDescriptor
+DbusInterface::openClipboard(
+  const QString& name,
+  qulonglong& size,
+  QString& mimeType,
+  qulonglong& generation
+) {
+  auto data = getClipboardData(name);
+  if (data == nullptr) {
+    sendErrorReply(QDBusError::InvalidArgs, "Invalid clipboard name");
+    return QDBusUnixFileDescriptor();
+  }
+  size = data->size;
+  mimeType = data->mimeType;
+  generation = data->generation;
+  if (data->fd.isValid()) {
+    return data->fd;
+  }
+  // QtDBus can't send an invalid fd, so empty contents get an empty memfd
+  data->fd = createClipboardMemfd(name, nullptr, 0);
+  return data->fd;
+}
+
+qulonglong
+DbusInterface::setClipboardFd(
+  const QString& name,
+  QDBusUnixFileDescriptor fd,
+  const QString& mimeType
+) {
+  if (getClipboardData(name) == nullptr) {
+    sendErrorReply(QDBusError::InvalidArgs, "Invalid clipboard name");
+    return 0;
+  }
+  if (!fd.isValid()) {
+    sendErrorReply(QDBusError::InvalidArgs, "Invalid file descriptor");
+    return 0;
+  }
+  struct stat st;
+  if (fstat(fd.fileDescriptor(), &st) == -1 || !S_ISREG(st.st_mode)) {
+    sendErrorReply(QDBusError::InvalidArgs, "Must be a memfd or regular file");
+    return 0;
+  }
+  if (st.st_size > CLIPBOARD_MAX_SIZE) {
+    sendErrorReply(QDBusError::LimitsExceeded, "Clipboard is too large");
+    return 0;
+  }
+  auto seals = fcntl(fd.fileDescriptor(), F_GET_SEALS);
+  if (seals != -1 && (seals & CLIPBOARD_SEALS) == CLIPBOARD_SEALS) {
+    // The sender can no longer change it, so it can be shared as is
+    setClipboardData(name, fd, st.st_size, mimeType);
+    return m_clipboardGeneration;
+  }
+  // Take a private copy of anything that could still change underneath us
+  qulonglong size = 0;
+  auto copy = copyClipboardFd(name, fd.fileDescriptor(), st.st_size, size);
+  if (!copy.isValid()) {
+    sendErrorReply(QDBusError::InternalError, "Failed to copy clipboard");
+    return 0;
+  }
+  setClipboardData(name, copy, size, mimeType);
+  return m_clipboardGeneration;
+}
+
+void
+DbusInterface::requestSortZ() {
+  // Only one sort is queued at a time, however many threads ask for one
+  if (m_sortPending.exchange(true)) {
+    return;
+  }
+  QTimer::singleShot(0, this, [this] {
+    m_sortPending = false;
+    sortZ();
+  });
 }
 
 void
@@ -1056,6 +1414,8 @@ DbusInterface::sortZ() {
     }
     surface->setZ(z++);
   }
+  updateScene();
+  updateInputRoute();
   if (
     m_focused != nullptr && (!m_focused->isRunning() || m_focused->isStopped())
   ) {
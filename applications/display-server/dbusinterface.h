@@ -27,6 +27,29 @@
 
 #define dbusInterface DbusInterface::singleton()
 
+struct SceneIndex {
+  // Visible surfaces that can be drawn, sorted from bottom to top
+  QList<std::shared_ptr<Surface>> surfaces;
+  // If the surface at the same index fully covers what is below it
+  QVector<bool> opaque;
+};
+
+// Clipboard contents are kept in sealed memfds so that they can be handed to
+// clients without copying them through the bus
+struct ClipboardData {
+  QDBusUnixFileDescriptor fd;
+  qulonglong size = 0;
+  QString mimeType;
+  qulonglong generation = 0;
+};
+
+struct InputRoute {
+  // Connection that has focus and receives all input
+  std::shared_ptr<Connection> focused;
+  // System connections that receive all input regardless of focus
+  QList<std::shared_ptr<Connection>> system;
+};
+
 class DbusInterface
   : public QObject
   , public QDBusContext {
@@ -34,6 +57,7 @@ class DbusInterface
   Q_CLASSINFO("Version", OXIDE_INTERFACE_VERSION)
   Q_CLASSINFO("D-Bus Interface", BLIGHT_INTERFACE)
   Q_PROPERTY(int pid READ pid CONSTANT)
+  Q_PROPERTY(int debugLevel READ debugLevel WRITE setDebugLevel)
   Q_PROPERTY(
     QByteArray clipboard READ clipboard WRITE setClipboard NOTIFY
       clipboardChanged
@@ -52,6 +76,8 @@ public:
 
   void startup();
   int pid();
+  int debugLevel();
+  void setDebugLevel(int level);
 #ifndef EPAPER
   QObject* loadComponent(
     QString url,
@@ -66,7 +92,12 @@ public:
   QList<std::shared_ptr<Surface>> surfaces();
   QList<std::shared_ptr<Surface>> sortedSurfaces();
   QList<std::shared_ptr<Surface>> visibleSurfaces();
+  std::shared_ptr<const SceneIndex> scene();
+  void updateScene();
+  std::shared_ptr<const InputRoute> inputRoute();
+  void updateInputRoute();
   void sortZ();
+  void requestSortZ();
   std::shared_ptr<Connection> focused();
   void setFocus(std::shared_ptr<Connection> connection);
   void inputEvents(unsigned int device, const std::vector<input_event>& events);
@@ -74,17 +105,22 @@ public:
   bool hasRunningConnection(pid_t pgid);
 
   // Property getter/setters
-  const QByteArray& clipboard();
+  QByteArray clipboard();
   void setClipboard(const QByteArray& data);
-  const QByteArray& selection();
+  QByteArray selection();
   void setSelection(const QByteArray& data);
-  const QByteArray& secondary();
+  QByteArray secondary();
   void setSecondary(const QByteArray& data);
 
 public slots:
   QDBusUnixFileDescriptor open(QDBusMessage message);
   QDBusUnixFileDescriptor
   openInput(unsigned short device, QDBusMessage message);
+  QDBusUnixFileDescriptor openInputWithCapacity(
+    unsigned short device,
+    unsigned int capacity,
+    QDBusMessage message
+  );
   ushort addSurface(
     QDBusUnixFileDescriptor fd,
     int x,
@@ -121,11 +157,23 @@ public slots:
   );
   void exclusiveModeRepaintFull(QDBusMessage message);
   bool connectionExists(QString identifier, QDBusMessage message);
+  QVariantMap repaintQueueDelays();
+  QDBusUnixFileDescriptor openClipboard(
+    const QString& name,
+    qulonglong& size,
+    QString& mimeType,
+    qulonglong& generation
+  );
+  qulonglong setClipboardFd(
+    const QString& name,
+    QDBusUnixFileDescriptor fd,
+    const QString& mimeType
+  );
 
 signals:
-  void clipboardChanged(const QByteArray& data);
-  void selectionChanged(const QByteArray& data);
-  void secondaryChanged(const QByteArray& data);
+  void clipboardChanged(qulonglong generation);
+  void selectionChanged(qulonglong generation);
+  void secondaryChanged(qulonglong generation);
 
 private slots:
   void serviceOwnerChanged(
@@ -140,15 +188,27 @@ private:
   QReadWriteLock connectionsLock;
   QList<std::shared_ptr<Connection>> connections;
   std::shared_ptr<Connection> m_focused;
+  std::shared_ptr<const SceneIndex> m_scene;
+  std::shared_ptr<const InputRoute> m_inputRoute;
   struct {
-    QByteArray clipboard;
-    QByteArray selection;
-    QByteArray secondary;
+    ClipboardData clipboard;
+    ClipboardData selection;
+    ClipboardData secondary;
   } clipboards;
+  qulonglong m_clipboardGeneration;
   std::atomic<bool> m_exclusiveMode;
+  std::atomic<bool> m_sortPending{false};
 
   std::shared_ptr<Connection> getConnection(QDBusMessage message);
   std::shared_ptr<Connection> getConnection(QString identifier);
   QObject* workspace();
   std::shared_ptr<Connection> createConnection(int pid);
+  ClipboardData* getClipboardData(const QString& name);
+  QByteArray readClipboard(const ClipboardData& data);
+  void setClipboardData(
+    const QString& name,
+    QDBusUnixFileDescriptor fd,
+    qulonglong size,
+    const QString& mimeType
+  );
 };
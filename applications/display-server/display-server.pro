@@ -23,6 +23,7 @@ SOURCES += \
     evdevdevice.cpp \
     evdevhandler.cpp \
     guithread.cpp \
+    inkoverlay.cpp \
     main.cpp \
     surface.cpp \
     surfacewidget.cpp
@@ -60,6 +61,7 @@ HEADERS += \
     evdevdevice.h \
     evdevhandler.h \
     guithread.h \
+    inkoverlay.h \
     surface.h \
     surfacewidget.h
 
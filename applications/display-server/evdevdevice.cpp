@@ -1,8 +1,8 @@
 #include "evdevdevice.h"
 
+#include <libblight/trace.h>
 #include <libevdev/libevdev.h>
 #include <liboxide/debug.h>
-#include <liboxide/threading.h>
 
 #include <QFileInfo>
 #include <QThread>
@@ -19,11 +19,9 @@ EvDevDevice::EvDevDevice(QThread* handler, const event_device& device)
   }
   O_DEBUG(device.device.c_str() << this->device.fd);
   _name = sys.strProperty("name").c_str();
-  notifier = new QSocketNotifier(this->device.fd, QSocketNotifier::Read, this);
-  connect(
-    notifier, &QSocketNotifier::activated, this, &EvDevDevice::readEvents
-  );
-  notifier->setEnabled(true);
+  // Resolved once, this is used for every frame on the input thread
+  m_number = QStringView(devName()).mid(5).toInt();
+  events.reserve(64);
   int rc = libevdev_new_from_fd(this->device.fd, &dev);
   if (rc < 0) {
     O_WARNING(
@@ -31,13 +29,10 @@ EvDevDevice::EvDevDevice(QThread* handler, const event_device& device)
                                            << std::strerror(-rc)
     );
     dev = nullptr;
-    notifier->setEnabled(false);
   }
 }
 
 EvDevDevice::~EvDevDevice() {
-  notifier->setEnabled(false);
-  notifier->deleteLater();
   unlock();
   libevdev_free(dev);
 }
@@ -65,8 +60,21 @@ EvDevDevice::id() {
 }
 
 unsigned int
-EvDevDevice::number() {
-  return QStringView(devName()).mid(5).toInt();
+EvDevDevice::number() const {
+  return m_number;
+}
+
+int
+EvDevDevice::fd() const {
+  return device.fd;
+}
+
+const input_absinfo*
+EvDevDevice::absInfo(unsigned int code) const {
+  if (dev == nullptr) {
+    return nullptr;
+  }
+  return libevdev_get_abs_info(dev, code);
 }
 
 bool
@@ -99,58 +107,41 @@ EvDevDevice::isValid() const {
   return dev != nullptr;
 }
 
-void
-EvDevDevice::readEvents() {
+bool
+EvDevDevice::readEvents(
+  const std::function<void(const std::vector<input_event>&)>& callback
+) {
   if (!isValid()) {
-    return;
+    return false;
   }
-  Oxide::dispatchToThread(thread(), [this] {
-    notifier->setEnabled(false);
-    int res;
-    bool sync = false;
-    do {
-      input_event event;
-      res = libevdev_next_event(
-        dev, sync ? LIBEVDEV_READ_FLAG_SYNC : LIBEVDEV_READ_FLAG_NORMAL, &event
-      );
-      if (res < 0) {
-        break;
-      }
-      sync = res == LIBEVDEV_READ_STATUS_SYNC;
-      events.push_back(event);
-      if (event.type == EV_SYN && event.code == SYN_REPORT) {
-        emit inputEvents(events);
-        events.clear();
-      }
-    } while (libevdev_has_event_pending(dev));
-    emitSomeEvents();
-    if (res == -ENODEV) {
-      // Device went away
-      O_WARNING("Device disapeared while reading events");
-      return;
-    }
-    if (res && res != -EAGAIN) {
-      O_WARNING("Failed to read input for " << name() << ":" << strerror(-res));
+  int res;
+  bool sync = false;
+  do {
+    input_event event;
+    res = libevdev_next_event(
+      dev, sync ? LIBEVDEV_READ_FLAG_SYNC : LIBEVDEV_READ_FLAG_NORMAL, &event
+    );
+    if (res < 0) {
+      break;
     }
-    notifier->setEnabled(true);
-  });
-}
-
-void
-EvDevDevice::emitSomeEvents() {
-  if (events.empty()) {
-    return;
-  }
-  for (auto i = events.rbegin(); i != events.rend(); ++i) {
-    auto& event = *i;
+    sync = res == LIBEVDEV_READ_STATUS_SYNC;
+    events.push_back(event);
     if (event.type == EV_SYN && event.code == SYN_REPORT) {
-      auto index = std::next(i - 1).base();
-      auto some = std::vector(events.begin(), index);
-      emit inputEvents(some);
-      events.erase(events.begin(), index);
-      break;
+      Blight::Trace::input(Blight::Trace::EvdevRead, event.time);
+      callback(events);
+      // Keeps the capacity so that the next frame doesn't allocate
+      events.clear();
     }
+  } while (libevdev_has_event_pending(dev));
+  if (res == -ENODEV) {
+    // Device went away
+    O_WARNING("Device disapeared while reading events");
+    return false;
+  }
+  if (res && res != -EAGAIN) {
+    O_WARNING("Failed to read input for " << name() << ":" << strerror(-res));
   }
+  return true;
 }
 
 input_event
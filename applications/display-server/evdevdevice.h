@@ -5,7 +5,7 @@
 #include <liboxide/sysobject.h>
 
 #include <QObject>
-#include <QSocketNotifier>
+#include <functional>
 
 using namespace Oxide;
 
@@ -19,28 +19,37 @@ public:
   QString name();
   QString path();
   QString id();
-  unsigned int number();
+  unsigned int number() const;
+  int fd() const;
+  /*!
+   * \brief Get the range of an absolute axis
+   * \param code Axis code, for example ABS_X
+   * \return The axis information, or nullptr if the device doesn't have it
+   */
+  const input_absinfo* absInfo(unsigned int code) const;
   bool exists();
   void lock();
   void unlock();
   void clear_buffer();
   bool isValid() const;
 
-signals:
-  void inputEvents(const std::vector<input_event> events);
-
-public slots:
-  void readEvents();
+  /*!
+   * \brief Read all pending events from the device
+   * \param callback Called with each complete frame of events
+   * \return If the device is still usable
+   */
+  bool readEvents(
+    const std::function<void(const std::vector<input_event>&)>& callback
+  );
 
 private:
   event_device device;
   SysObject sys;
   QString _name;
-  QSocketNotifier* notifier;
+  unsigned int m_number;
   std::vector<input_event> events;
   libevdev* dev;
 
-  void emitSomeEvents();
   input_event createEvent(ushort type, ushort code, int value);
   input_event* build_flood();
 };
@@ -5,7 +5,10 @@
 #include <liboxide/threading.h>
 #include <linux/input.h>
 #include <private/qdevicediscovery_p.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 #include <QFileInfo>
 #include <QKeyEvent>
@@ -13,6 +16,9 @@
 #include <utility>
 
 #include "dbusinterface.h"
+#ifdef EPAPER
+#include "guithread.h"
+#endif
 
 EvDevHandler*
 EvDevHandler::init() {
@@ -28,9 +34,28 @@ EvDevHandler::init() {
 
 EvDevHandler::EvDevHandler()
   : QThread()
-  , m_clearing{false} {
+  , m_clearing{false}
+  , m_epollFd{epoll_create1(EPOLL_CLOEXEC)}
+  , m_wakeFd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}
+  , m_inputThread{nullptr} {
   setObjectName("EvDevHandler");
+  if (m_epollFd < 0) {
+    O_WARNING("Failed to create epoll instance" << std::strerror(errno));
+  }
+  if (m_wakeFd < 0) {
+    O_WARNING("Failed to create eventfd" << std::strerror(errno));
+  } else if (m_epollFd >= 0) {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+  }
   reloadDevices();
+  // Events are read and written to the connection buffers on a dedicated
+  // thread, so input isn't delayed by anything else happening in the server
+  m_inputThread = QThread::create([this] { readInput(); });
+  m_inputThread->setObjectName("EvDevInput");
+  Oxide::startThreadWithPriority(m_inputThread, QThread::TimeCriticalPriority);
   auto deviceDiscovery =
     QDeviceDiscovery::create(QDeviceDiscovery::Device_InputMask, this);
   connect(
@@ -47,10 +72,21 @@ EvDevHandler::EvDevHandler()
   );
 }
 
-EvDevHandler::~EvDevHandler() {}
+EvDevHandler::~EvDevHandler() {
+  if (m_inputThread != nullptr) {
+    uint64_t value = 1;
+    ::write(m_wakeFd, &value, sizeof(value));
+    m_inputThread->wait();
+    delete m_inputThread;
+  }
+  ::close(m_wakeFd);
+  ::close(m_epollFd);
+}
 
 void
 EvDevHandler::clear_buffers() {
+  // devices is changed by reloadDevices and walked by the input thread
+  std::lock_guard lock(m_inputMutex);
   m_clearing = true;
   for (auto input : std::as_const(devices)) {
     input->clear_buffer();
@@ -68,9 +104,61 @@ EvDevHandler::hasDevice(event_device device) {
   return false;
 }
 
+void
+EvDevHandler::readInput() {
+  if (m_epollFd < 0) {
+    return;
+  }
+  epoll_event items[8];
+  while (true) {
+    int count = epoll_wait(m_epollFd, items, 8, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      O_WARNING("Failed to wait for input" << std::strerror(errno));
+      return;
+    }
+    std::lock_guard lock(m_inputMutex);
+    for (int i = 0; i < count; i++) {
+      auto input = static_cast<EvDevDevice*>(items[i].data.ptr);
+      if (input == nullptr) {
+        // Woken up to exit
+        return;
+      }
+      if (!devices.contains(input)) {
+        // Removed after epoll_wait returned
+        continue;
+      }
+      auto number = input->number();
+#ifdef EPAPER
+      auto ink = input == m_inkDevice ? m_inkOverlay.get() : nullptr;
+#endif
+      auto alive = input->readEvents([&](auto& events) {
+        if (m_clearing) {
+          return;
+        }
+#ifdef EPAPER
+        // Drawn before the events are forwarded so that the ink doesn't wait
+        // on anything the clients are doing
+        if (ink != nullptr) {
+          ink->handleEvents(events);
+        }
+#endif
+        dbusInterface->inputEvents(number, events);
+      });
+      if (!alive) {
+        // Stop polling until reloadDevices removes it
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, input->fd(), nullptr);
+      }
+    }
+  }
+}
+
 void
 EvDevHandler::reloadDevices() {
   O_DEBUG("Reloading devices");
+  std::lock_guard lock(m_inputMutex);
   for (auto& device : deviceSettings.inputDevices()) {
     if (!hasDevice(device) && device.fd > 0) {
       EvDevDevice* input;
@@ -88,20 +176,31 @@ EvDevHandler::reloadDevices() {
         input->deleteLater();
         continue;
       }
-      connect(
-        input,
-        &EvDevDevice::inputEvents,
-        this,
-        [this, input](auto events) {
-          if (!m_clearing) {
-            dbusInterface->inputEvents(input->number(), events);
-          }
-        },
-        Qt::QueuedConnection
-      );
+      epoll_event event{};
+      event.events = EPOLLIN;
+      event.data.ptr = input;
+      if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, input->fd(), &event) < 0) {
+        O_WARNING(
+          "Failed to watch" << input->name() << "for input:"
+                            << std::strerror(errno)
+        );
+        delete input;
+        continue;
+      }
       O_DEBUG(input->name() << "added");
       devices.append(input);
-      input->readEvents();
+#ifdef EPAPER
+      if (device.device == deviceSettings.getWacomDevicePath()) {
+        auto x = input->absInfo(ABS_X);
+        auto y = input->absInfo(ABS_Y);
+        if (x != nullptr && y != nullptr) {
+          m_inkDevice = input;
+          m_inkOverlay = std::make_unique<InkOverlay>(
+            *x, *y, guiThread->screenGeometry()
+          );
+        }
+      }
+#endif
     }
   }
   QMutableListIterator<EvDevDevice*> i(devices);
@@ -111,7 +210,14 @@ EvDevHandler::reloadDevices() {
       continue;
     }
     O_DEBUG(device->name() << "removed");
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, device->fd(), nullptr);
     i.remove();
+#ifdef EPAPER
+    if (device == m_inkDevice) {
+      m_inkDevice = nullptr;
+      m_inkOverlay.reset();
+    }
+#endif
     delete device;
   }
 }
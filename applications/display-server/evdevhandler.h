@@ -3,9 +3,15 @@
 #include <liboxide/event_device.h>
 
 #include <QThread>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "evdevdevice.h"
+#ifdef EPAPER
+#include "inkoverlay.h"
+#endif
 
 using namespace Oxide;
 
@@ -22,7 +28,19 @@ public:
 
 private:
   QList<EvDevDevice*> devices;
-  bool m_clearing;
+  std::atomic<bool> m_clearing;
+  // Held by the input thread while reading, and when the device list changes
+  std::mutex m_inputMutex;
+  int m_epollFd;
+  int m_wakeFd;
+  QThread* m_inputThread;
+#ifdef EPAPER
+  // Tablet that provisional ink is drawn for, only used by the input thread
+  // and while reloading devices
+  EvDevDevice* m_inkDevice = nullptr;
+  std::unique_ptr<InkOverlay> m_inkOverlay;
+#endif
   bool hasDevice(event_device device);
   void reloadDevices();
+  void readInput();
 };
@@ -3,6 +3,8 @@
 #include <epframebuffer.h>
 #include <fcntl.h>
 #include <libblight/clock.h>
+#include <libblight/trace.h>
+#include <libblight_protocol/pixel.h>
 #include <liboxide/debug.h>
 #include <liboxide/devicesettings.h>
 #include <liboxide/oxideqml.h>
@@ -16,9 +18,25 @@
 #include <QPainter>
 #include <QTimer>
 
+#include <algorithm>
+#include <cstring>
+
 #include "connection.h"
 #include "dbusinterface.h"
 
+// Maximum number of requests drained into a single batch, so that a
+// connection flooding the queue can't push out everyone else
+constexpr int REPAINT_BATCH_SIZE = 64;
+// How many normal requests the focused connection is served in a row
+// before moving on to the next connection
+constexpr int REPAINT_FOCUS_WEIGHT = 4;
+// Number of markers remembered after they have been drawn, so that a wait
+// that arrives after the update still resolves against the right update
+constexpr size_t MARKER_HISTORY = 256;
+// How long provisional ink is left on the screen after the pen is lifted,
+// waiting for the client to paint over it
+constexpr int INK_EXPIRY = 1000;
+
 void
 GUIThread::run() {
   O_DEBUG("Thread started");
@@ -28,26 +46,65 @@ GUIThread::run() {
     QMutexLocker locker(&m_repaintMutex);
     Q_UNUSED(locker);
     while (!isInterruptionRequested()) {
+      // Ink goes out before anything else, it is what the user is waiting on
+      flushInk();
+      serveMirrorRequest();
       // New repaint request each loop as we have a shared pointer we need
       // to clear
       RepaintRequest event;
-      if (!m_repaintEvents.try_dequeue(event)) {
+      if (!dequeue(event)) {
+        // Nothing is drawing right now, so bring the mirrors up to date. In
+        // exclusive mode the connection owns the shared framebuffer.
+        if (!dbusInterface->inExclusiveMode()) {
+          flushMirrors();
+        }
         emit settled();
-        // Wait for up to 500ms before trying again
-        m_repaintWait.wait(&m_repaintMutex, 500);
-        auto found = m_repaintEvents.try_dequeue(event);
+        pruneRepaintQueues();
+        // Wait for up to 500ms, or until provisional ink is due to expire
+        m_repaintWait.wait(&m_repaintMutex, idleDeadline());
+        serveMirrorRequest();
+        flushInk();
+        expireInk();
+        auto found = dequeue(event);
         if (!found) {
           // Woken by something needing to cleanup
           // connections/surfaces
           continue;
         }
       }
-      do {
-        redraw(event);
-        if (event.callback != nullptr) {
-          event.callback();
+      // Drain everything that arrives within the coalesce window so that
+      // bursts of small repaints turn into as few swaps as possible
+      std::vector<RepaintRequest> pending;
+      // Pen updates are flushed right away, waiting would only add latency
+      QDeadlineTimer deadline(
+        repaintClass(event) == PenRepaint ? 0 : m_coalesceWindow,
+        Qt::PreciseTimer
+      );
+      coalesce(pending, event);
+      int count = 1;
+      while (true) {
+        while (count < REPAINT_BATCH_SIZE && dequeue(event)) {
+          coalesce(pending, event);
+          count++;
+        }
+        if (
+          count >= REPAINT_BATCH_SIZE || deadline.hasExpired() ||
+          isInterruptionRequested()
+        ) {
+          break;
+        }
+        m_repaintWait.wait(&m_repaintMutex, deadline);
+        serveMirrorRequest();
+      }
+      for (auto& request : pending) {
+        redraw(request);
+        // Requests that were skipped still resolve, against whatever has
+        // been sent to the screen so far
+        markersSwapped(request.markers, m_swapCount.load());
+        if (request.callback != nullptr) {
+          request.callback();
         }
-      } while (m_repaintEvents.try_dequeue(event));
+      }
       eventDispatcher()->processEvents(QEventLoop::AllEvents);
     }
   });
@@ -75,6 +132,13 @@ GUIThread::GUIThread(QRect screenGeometry)
   , m_screenGeometry{screenGeometry}
   , m_screenOffset{screenGeometry.topLeft()}
   , m_screenRect{m_screenGeometry.translated(-m_screenOffset)} {
+  bool ok = false;
+  m_coalesceWindow =
+    qEnvironmentVariableIntValue("OXIDE_BLIGHT_COALESCE_WINDOW", &ok);
+  if (!ok || m_coalesceWindow < 0) {
+    m_coalesceWindow = 2;
+  }
+  O_INFO("Repaint coalesce window:" << m_coalesceWindow << "ms");
   auto frameBuffer = getFrameBuffer();
   O_INFO(
     "Framebuffer:" << frameBuffer->width() << "x" << frameBuffer->height()
@@ -122,13 +186,24 @@ GUIThread::GUIThread(QRect screenGeometry)
     qFatal("Failed to open framebuffer");
   }
   m_frameBufferImage = Oxide::QML::getImageForSurface(m_frameBuffer);
+  m_completionThread = QThread::create([this] { completeUpdates(); });
+  m_completionThread->setObjectName("update-complete");
+  m_completionThread->start();
   moveToThread(this);
 }
 
 GUIThread::~GUIThread() {
-  RepaintRequest event;
-  while (m_repaintEvents.try_dequeue(event))
-    ;
+  {
+    QWriteLocker locker(&m_repaintQueuesLock);
+    m_repaintQueues.clear();
+  }
+  {
+    QMutexLocker locker(&m_markersMutex);
+    m_stopCompletion = true;
+    m_markersWait.wakeAll();
+  }
+  m_completionThread->wait();
+  delete m_completionThread;
   requestInterruption();
   quit();
   wait();
@@ -137,7 +212,7 @@ GUIThread::~GUIThread() {
 void
 GUIThread::enqueue(
   std::shared_ptr<Surface> surface,
-  QRect region,
+  QRegion region,
   Blight::WaveformMode waveform,
   Blight::ContentType contentType,
   Blight::UpdateMode mode,
@@ -152,7 +227,8 @@ GUIThread::enqueue(
     return;
   }
   Q_ASSERT(global || surface != nullptr);
-  QRect intersected;
+  Blight::Trace::mark(Blight::Trace::Enqueue);
+  QRegion intersected;
   if (global) {
     intersected = region;
   } else {
@@ -166,12 +242,16 @@ GUIThread::enqueue(
     auto surfaceGeometry = surface->geometry();
     double scale = surface->scale();
     if (scale != 1.0) {
-      region = QRect(
-        region.x() * scale,
-        region.y() * scale,
-        region.width() * scale,
-        region.height() * scale
-      );
+      QRegion scaled;
+      for (const QRect& rect : std::as_const(region)) {
+        scaled += QRect(
+          rect.x() * scale,
+          rect.y() * scale,
+          rect.width() * scale,
+          rect.height() * scale
+        );
+      }
+      region = scaled;
     }
     intersected = region.translated(surfaceGeometry.topLeft())
                     .intersected(surfaceGeometry)
@@ -187,26 +267,20 @@ GUIThread::enqueue(
     }
     return;
   }
-  auto visibleSurfaces = this->visibleSurfaces();
   QRegion repaintRegion(intersected);
   if (!global) {
     // Don't repaint portions covered by another surface that doesn't have
     // alpha channel
-    auto i = visibleSurfaces.constEnd();
-    while (i != visibleSurfaces.constBegin()) {
-      --i;
-      auto _surface = *i;
+    auto scene = dbusInterface->scene();
+    for (int i = scene->surfaces.size() - 1; i >= 0; --i) {
+      auto& _surface = scene->surfaces.at(i);
       if (surface == _surface) {
         break;
       }
-      auto image = _surface->image();
-      if (image != nullptr && !image->isNull() && image->hasAlphaChannel()) {
+      if (!scene->opaque.at(i)) {
         continue;
       }
-      auto geometry = _surface->geometry();
-      repaintRegion -= region.intersected(geometry)
-                         .translated(-geometry.topLeft())
-                         .intersected(m_screenRect);
+      repaintRegion -= intersected.intersected(_surface->geometry());
     }
   }
   if (repaintRegion.isEmpty()) {
@@ -216,18 +290,29 @@ GUIThread::enqueue(
     }
     return;
   }
-  m_repaintEvents.enqueue(
-    RepaintRequest{
-      .surface = surface,
-      .region = repaintRegion,
-      .waveform = waveform,
-      .contentType = contentType,
-      .mode = mode,
-      .marker = marker,
-      .global = global,
-      .callback = callback
-    }
-  );
+  RepaintRequest request{
+    .surface = surface,
+    .region = repaintRegion,
+    .waveform = waveform,
+    .contentType = contentType,
+    .mode = mode,
+    .marker = marker,
+    .markers = {},
+    .global = global,
+    .callback = callback
+  };
+  // Looked up first, as replacing a stale queue forgets the markers for its
+  // connection
+  auto queue = repaintQueue(global ? nullptr : surface);
+  if (marker && surface != nullptr) {
+    request.markers.emplace_back(surface->connection().get(), marker);
+    registerMarkers(request.markers);
+  }
+  if (repaintClass(request) == PenRepaint) {
+    queue->pen.enqueue(std::move(request));
+  } else {
+    queue->normal.enqueue(std::move(request));
+  }
   notify();
 }
 
@@ -238,6 +323,95 @@ GUIThread::notify() {
   }
 }
 
+void
+GUIThread::drawInk(const InkSegment& segment) {
+  if (isInterruptionRequested() || dbusInterface->inExclusiveMode()) {
+    return;
+  }
+  m_ink.enqueue(segment);
+  notify();
+}
+
+void
+GUIThread::flushInk() {
+  Q_ASSERT(QThread::currentThread() == (QThread*)this);
+  InkSegment segment;
+  QPainter painter;
+  QRect dirty;
+  while (m_ink.try_dequeue(segment)) {
+    if (segment.end) {
+      m_inkExpiry.setRemainingTime(INK_EXPIRY, Qt::CoarseTimer);
+      continue;
+    }
+    m_inkExpiry = QDeadlineTimer(QDeadlineTimer::Forever);
+    if (!painter.isActive()) {
+      painter.begin(getFrameBuffer());
+    }
+    painter.setClipRegion(segment.clip);
+    painter.setPen(QPen(
+      Qt::black, segment.width, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin
+    ));
+    painter.drawLine(segment.from, segment.to);
+    QRect rect = QRect(segment.from, segment.to).normalized();
+    if (segment.predicted != segment.to) {
+      painter.drawLine(segment.to, segment.predicted);
+      rect |= QRect(segment.to, segment.predicted).normalized();
+    }
+    int margin = segment.width / 2 + 1;
+    dirty |= segment.clip
+               .intersected(rect.adjusted(-margin, -margin, margin, margin))
+               .boundingRect()
+               .intersected(m_screenRect);
+  }
+  if (painter.isActive()) {
+    painter.end();
+  }
+  if (dirty.isEmpty()) {
+    return;
+  }
+  m_inkRegion += dirty;
+  sendUpdate(
+    dirty,
+    Blight::WaveformMode::UltraFast,
+    Blight::ContentType::Monochrome,
+    Blight::UpdateMode::PenUpdate
+  );
+}
+
+void
+GUIThread::expireInk() {
+  if (m_inkExpiry.isForever() || !m_inkExpiry.hasExpired()) {
+    return;
+  }
+  m_inkExpiry = QDeadlineTimer(QDeadlineTimer::Forever);
+  if (m_inkRegion.isEmpty()) {
+    return;
+  }
+  // Whatever the client hasn't painted over was mispredicted, or the client
+  // decided not to draw it
+  O_DEBUG("Removing provisional ink" << m_inkRegion.boundingRect());
+  auto region = m_inkRegion;
+  m_inkRegion = QRegion();
+  enqueue(
+    nullptr,
+    region,
+    Blight::WaveformMode::Fast,
+    Blight::ContentType::Monochrome,
+    Blight::UpdateMode::PartialUpdate,
+    0,
+    true
+  );
+}
+
+QDeadlineTimer
+GUIThread::idleDeadline() {
+  QDeadlineTimer deadline(500, Qt::CoarseTimer);
+  if (!m_inkExpiry.isForever() && m_inkExpiry < deadline) {
+    return m_inkExpiry;
+  }
+  return deadline;
+}
+
 void
 GUIThread::clearFrameBuffer() {
   getFrameBuffer()->fill(Qt::white);
@@ -249,11 +423,350 @@ GUIThread::clearFrameBuffer() {
   );
 }
 
+// Must be called with m_mirrorMutex held
+void
+GUIThread::flushPrevious(const QRegion& region) {
+  auto stale = m_previousDirty.intersected(region);
+  if (stale.isEmpty()) {
+    return;
+  }
+  auto instance = EPFramebuffer::instance();
+  QPainter painter(&instance->previousBuffer);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  for (const QRect& rect : std::as_const(stale)) {
+    painter.drawImage(rect, instance->frameBuffer, rect);
+  }
+  m_previousDirty -= stale;
+}
+
+void
+GUIThread::flushMirrors() {
+  Q_ASSERT(QThread::currentThread() == (QThread*)this);
+  QMutexLocker locker(&m_mirrorMutex);
+  flushPrevious(m_previousDirty);
+  if (!m_mirrorDirty.isEmpty()) {
+    auto instance = EPFramebuffer::instance();
+    QPainter painter(&m_frameBufferImage);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (const QRect& rect : std::as_const(m_mirrorDirty)) {
+      painter.drawImage(rect, instance->frameBuffer, rect);
+    }
+    m_mirrorDirty = QRegion();
+  }
+}
+
+void
+GUIThread::serveMirrorRequest() {
+  if (m_mirrorRequested) {
+    flushMirrors();
+    m_mirrorRequested = false;
+    m_mirrorWait.wakeAll();
+  }
+}
+
+void
+GUIThread::syncMirrors() {
+  if (QThread::currentThread() == (QThread*)this) {
+    flushMirrors();
+    return;
+  }
+  // The mirrors are only ever painted on this thread, so ask it to flush them
+  // and wait until it has
+  QMutexLocker locker(&m_repaintMutex);
+  m_mirrorRequested = true;
+  m_repaintWait.wakeAll();
+  while (m_mirrorRequested && isRunning() && !isInterruptionRequested()) {
+    m_mirrorWait.wait(&m_repaintMutex, QDeadlineTimer(100));
+  }
+}
+
 Blight::shared_buf_t
 GUIThread::framebuffer() {
+  // Something is about to read the shared framebuffer
+  syncMirrors();
   return m_frameBuffer;
 }
 
+QVariantMap
+GUIThread::repaintQueueDelays() {
+  static const char* names[RepaintClassCount] = {"pen", "normal"};
+  QVariantMap result;
+  for (int i = 0; i < RepaintClassCount; i++) {
+    auto& delay = m_repaintDelays[i];
+    auto count = delay.count.load(std::memory_order_relaxed);
+    auto total = delay.total.load(std::memory_order_relaxed);
+    QVariantMap stats;
+    stats["count"] = count;
+    stats["average"] = count ? total / count : 0;
+    stats["max"] = delay.max.load(std::memory_order_relaxed);
+    stats["last"] = delay.last.load(std::memory_order_relaxed);
+    result[names[i]] = stats;
+  }
+  return result;
+}
+
+RepaintClass
+GUIThread::repaintClass(const RepaintRequest& event) {
+  if (
+    (event.mode & Blight::UpdateMode::PenUpdate) ||
+    event.waveform == Blight::WaveformMode::UltraFast
+  ) {
+    return PenRepaint;
+  }
+  return NormalRepaint;
+}
+
+std::shared_ptr<RepaintQueue>
+GUIThread::repaintQueue(std::shared_ptr<Surface> surface) {
+  std::shared_ptr<Connection> connection;
+  if (surface != nullptr) {
+    connection = surface->connection();
+  }
+  auto key = connection.get();
+  {
+    QReadLocker locker(&m_repaintQueuesLock);
+    auto it = m_repaintQueues.find(key);
+    if (
+      it != m_repaintQueues.end() &&
+      (key == nullptr || !it->second->connection.expired())
+    ) {
+      return it->second;
+    }
+  }
+  QWriteLocker locker(&m_repaintQueuesLock);
+  auto& queue = m_repaintQueues[key];
+  if (
+    queue == nullptr || (key != nullptr && queue->connection.expired())
+  ) {
+    if (queue != nullptr) {
+      // A new connection was allocated where an old one used to be, its
+      // markers would otherwise never be drawn and would block pruning
+      forgetMarkers(key);
+    }
+    queue = std::make_shared<RepaintQueue>();
+    queue->connection = connection;
+  }
+  return queue;
+}
+
+bool
+GUIThread::dequeue(RepaintRequest& event) {
+  Q_ASSERT(QThread::currentThread() == (QThread*)this);
+  // Focus is changed on the main thread, the route is an atomic snapshot
+  auto route = dbusInterface->inputRoute();
+  auto focused = route->focused.get();
+  QReadLocker locker(&m_repaintQueuesLock);
+  if (m_repaintQueues.empty()) {
+    return false;
+  }
+  auto isLive = [](const auto& item) {
+    return item.first == nullptr || !item.second->connection.expired();
+  };
+  auto found = [this, &event](RepaintClass type) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                     event.queued.diff()
+    )
+                     .count();
+    auto& delay = m_repaintDelays[type];
+    delay.count.fetch_add(1, std::memory_order_relaxed);
+    delay.total.fetch_add(elapsed, std::memory_order_relaxed);
+    delay.last.store(elapsed, std::memory_order_relaxed);
+    if ((quint64)elapsed > delay.max.load(std::memory_order_relaxed)) {
+      delay.max.store(elapsed, std::memory_order_relaxed);
+    }
+    return true;
+  };
+  // Pen work is always served first, starting with the focused connection
+  auto focusedQueue = m_repaintQueues.find(focused);
+  if (
+    focused != nullptr && focusedQueue != m_repaintQueues.end() &&
+    isLive(*focusedQueue) && focusedQueue->second->pen.try_dequeue(event)
+  ) {
+    return found(PenRepaint);
+  }
+  for (auto& item : m_repaintQueues) {
+    if (isLive(item) && item.second->pen.try_dequeue(event)) {
+      return found(PenRepaint);
+    }
+  }
+  // Round-robin the remaining work between connections, letting the focused
+  // connection have a few requests in a row before moving on
+  if (
+    m_lastServed != nullptr && m_lastServed == focused &&
+    m_servedCount < REPAINT_FOCUS_WEIGHT &&
+    focusedQueue != m_repaintQueues.end() && isLive(*focusedQueue) &&
+    focusedQueue->second->normal.try_dequeue(event)
+  ) {
+    m_servedCount++;
+    return found(NormalRepaint);
+  }
+  auto it = m_repaintQueues.upper_bound(m_lastServed);
+  for (size_t i = 0; i < m_repaintQueues.size(); i++, ++it) {
+    if (it == m_repaintQueues.end()) {
+      it = m_repaintQueues.begin();
+    }
+    if (isLive(*it) && it->second->normal.try_dequeue(event)) {
+      m_lastServed = it->first;
+      m_servedCount = 1;
+      return found(NormalRepaint);
+    }
+  }
+  return false;
+}
+
+void
+GUIThread::pruneRepaintQueues() {
+  QWriteLocker locker(&m_repaintQueuesLock);
+  auto it = m_repaintQueues.begin();
+  while (it != m_repaintQueues.end()) {
+    auto& [key, queue] = *it;
+    if (key == nullptr || !queue->connection.expired()) {
+      ++it;
+      continue;
+    }
+    // The connection is gone, so there is nothing left to ack
+    if (m_lastServed == key) {
+      m_lastServed = nullptr;
+    }
+    forgetMarkers(key);
+    it = m_repaintQueues.erase(it);
+  }
+}
+
+void
+GUIThread::registerMarkers(const std::vector<MarkerKey>& markers) {
+  QMutexLocker locker(&m_markersMutex);
+  for (auto& key : markers) {
+    auto [it, inserted] = m_markers.try_emplace(key);
+    if (inserted) {
+      m_markerOrder.push_back(key);
+    } else {
+      // The client reused the marker, waits now refer to the new request
+      it->second.swap = 0;
+    }
+  }
+  while (m_markerOrder.size() > MARKER_HISTORY) {
+    auto it = m_markers.find(m_markerOrder.front());
+    if (it != m_markers.end()) {
+      if (!it->second.swap) {
+        // Oldest marker hasn't been drawn yet, keep everything for now
+        break;
+      }
+      m_markers.erase(it);
+    }
+    m_markerOrder.pop_front();
+  }
+}
+
+void
+GUIThread::markersSwapped(
+  const std::vector<MarkerKey>& markers,
+  quint64 swap
+) {
+  if (markers.empty()) {
+    return;
+  }
+  QMutexLocker locker(&m_markersMutex);
+  bool waiting = false;
+  for (auto& key : markers) {
+    auto it = m_markers.find(key);
+    if (it == m_markers.end()) {
+      continue;
+    }
+    auto& state = it->second;
+    state.swap = swap;
+    for (auto& waiter : state.waiters) {
+      m_swapWaiters.emplace(swap, std::move(waiter));
+      waiting = true;
+    }
+    state.waiters.clear();
+  }
+  if (waiting) {
+    m_markersWait.wakeAll();
+  }
+}
+
+void
+GUIThread::forgetMarkers(Connection* connection) {
+  QMutexLocker locker(&m_markersMutex);
+  auto it = m_markers.lower_bound({connection, 0});
+  while (it != m_markers.end() && it->first.first == connection) {
+    it = m_markers.erase(it);
+  }
+}
+
+void
+GUIThread::waitForMarker(
+  Connection* connection,
+  unsigned int marker,
+  std::function<void()> callback
+) {
+  QMutexLocker locker(&m_markersMutex);
+  quint64 swap = 0;
+  if (marker) {
+    auto it = m_markers.find({connection, marker});
+    if (it != m_markers.end()) {
+      auto& state = it->second;
+      if (!state.swap) {
+        // Still queued, resolved once it has been sent to the screen
+        state.waiters.push_back({connection, callback});
+        return;
+      }
+      swap = state.swap;
+    }
+  }
+  if (!swap) {
+    // Unknown markers wait for everything that has been sent so far
+    swap = m_swapCount.load();
+  }
+  if (swap <= m_completedSwap) {
+    locker.unlock();
+    callback();
+    return;
+  }
+  m_swapWaiters.emplace(swap, MarkerWaiter{connection, callback});
+  m_markersWait.wakeAll();
+}
+
+void
+GUIThread::completeUpdates() {
+  QMutexLocker locker(&m_markersMutex);
+  while (!m_stopCompletion) {
+    if (m_swapWaiters.empty() && !m_tracedSwap) {
+      m_markersWait.wait(&m_markersMutex);
+      continue;
+    }
+    // Only sync while something is waiting or being traced, and resolve
+    // every waiter the sync covers at once. The framebuffer only exposes a
+    // global sync, so completion is tracked per swap rather than per marker:
+    // a waiter is resolved once every update sent so far is on the screen,
+    // which can include other clients' updates sent after its own
+    quint64 target = m_swapCount.load();
+    if (m_completedSwap < target) {
+      locker.unlock();
+      EPFramebuffer::instance()->sync();
+      locker.relock();
+      m_completedSwap = std::max(m_completedSwap, target);
+    }
+    if (m_tracedSwap && m_tracedSwap <= m_completedSwap) {
+      Blight::Trace::mark(Blight::Trace::UpdateComplete, m_tracedInput);
+      m_tracedSwap = 0;
+    }
+    std::vector<MarkerWaiter> ready;
+    auto end = m_swapWaiters.upper_bound(m_completedSwap);
+    for (auto it = m_swapWaiters.begin(); it != end; ++it) {
+      ready.push_back(std::move(it->second));
+    }
+    m_swapWaiters.erase(m_swapWaiters.begin(), end);
+    locker.unlock();
+    for (auto& waiter : ready) {
+      waiter.callback();
+    }
+    ready.clear();
+    locker.relock();
+  }
+}
+
 void
 GUIThread::repaintSurface(
   QPainter* painter,
@@ -296,9 +809,103 @@ GUIThread::repaintSurface(
       imageRect.height() / scale
     );
   }
+  if (scale == 1.0 && imageRect.size() == sourceRect.size()) {
+    // Common formats have their own kernels that avoid QPainter's generic
+    // conversion and blending
+    auto frameBuffer = static_cast<QImage*>(painter->device());
+    auto topLeft = imageRect.topLeft();
+    if (blit(frameBuffer, sourceRect, *image.get(), topLeft, true)) {
+      return;
+    }
+  }
   painter->drawImage(sourceRect, *image.get(), imageRect);
 }
 
+bool
+GUIThread::blit(
+  QImage* frameBuffer,
+  const QRect& rect,
+  const QImage& image,
+  const QPoint& source,
+  bool blend
+) {
+  if (!BlightProtocol::Pixel::supported(
+        (Blight::Format)image.format(),
+        (Blight::Format)frameBuffer->format()
+      )) {
+    return false;
+  }
+  const int srcDepth = image.depth() / 8;
+  const int dstDepth = frameBuffer->depth() / 8;
+  return BlightProtocol::Pixel::blit(
+    image.constScanLine(source.y()) + source.x() * srcDepth,
+    image.bytesPerLine(),
+    (Blight::Format)image.format(),
+    frameBuffer->scanLine(rect.y()) + rect.x() * dstDepth,
+    frameBuffer->bytesPerLine(),
+    (Blight::Format)frameBuffer->format(),
+    rect.width(),
+    rect.height(),
+    blend
+  );
+}
+
+void
+GUIThread::coalesce(
+  std::vector<RepaintRequest>& pending,
+  RepaintRequest& event
+) {
+  // Walk backwards so that a request is never merged past a newer request
+  // with a different update mode that it overlaps, which would change the
+  // order the waveforms are applied in
+  const QRect bounds = event.region.boundingRect().adjusted(-1, -1, 1, 1);
+  for (auto i = pending.rbegin(); i != pending.rend(); ++i) {
+    auto& request = *i;
+    bool touches = request.region.intersects(bounds);
+    if (
+      request.waveform != event.waveform ||
+      request.contentType != event.contentType || request.mode != event.mode
+    ) {
+      if (touches) {
+        break;
+      }
+      continue;
+    }
+    if (!touches) {
+      continue;
+    }
+    O_DEBUG(
+      "Coalescing repaint" << event.region.boundingRect() << "into"
+                           << request.region.boundingRect()
+    );
+    request.region += event.region;
+    if (event.marker) {
+      request.marker = event.marker;
+    }
+    request.markers.insert(
+      request.markers.end(), event.markers.begin(), event.markers.end()
+    );
+    if (event.global || request.global || event.surface != request.surface) {
+      // Different surfaces are involved, so everything visible in the region
+      // needs to be composed
+      request.global = true;
+      request.surface = nullptr;
+    }
+    if (event.callback != nullptr) {
+      if (request.callback == nullptr) {
+        request.callback = event.callback;
+      } else {
+        request.callback = [first = request.callback, second = event.callback] {
+          first();
+          second();
+        };
+      }
+    }
+    return;
+  }
+  pending.push_back(event);
+}
+
 void
 GUIThread::redraw(RepaintRequest& event) {
   Q_ASSERT(QThread::currentThread() == (QThread*)this);
@@ -320,6 +927,7 @@ GUIThread::redraw(RepaintRequest& event) {
     O_WARNING("Empty repaint region" << region);
     return;
   }
+  Blight::Trace::mark(Blight::Trace::RedrawStart);
   Blight::ClockWatch cw;
   // Get visible region on the screen to repaint
   O_DEBUG("Repainting" << region.boundingRect());
@@ -327,18 +935,42 @@ GUIThread::redraw(RepaintRequest& event) {
   // "QPainter::begin: A paint device can only be painted by one painter at a
   // time." Ignore this warning, Nothing is displayed if the painter is not
   // active when calling sendUpdate currently
-  for (QRect rect : event.region) {
-    bool hasAlpha = event.global;
-    if (!hasAlpha) {
-      auto image = event.surface->image();
-      hasAlpha =
-        image != nullptr && !image->isNull() && image->hasAlphaChannel();
+  bool hasAlpha = event.global;
+  if (!hasAlpha) {
+    auto image = event.surface->image();
+    hasAlpha = image != nullptr && !image->isNull() && image->hasAlphaChannel();
+  }
+  auto direct = scanoutSurface(event);
+  if (direct != nullptr) {
+    // Only one opaque surface covering the whole screen is visible, so its
+    // buffer can be copied as is without composing anything
+    auto image = direct->image();
+    for (const QRect& rect : event.region) {
+      scanout(frameBuffer, *image.get(), rect);
     }
-    QPainter painter(frameBuffer);
-    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    m_inkRegion -= region;
+    sendUpdate(
+      region.boundingRect(),
+      event.waveform,
+      event.contentType,
+      event.mode
+    );
+    O_DEBUG(
+      "Scanout" << region.boundingRect() << "done in" << region.rectCount()
+                << "copies, and" << cw.elapsed() << "seconds"
+    );
+    return;
+  }
+  QList<std::shared_ptr<Surface>> surfaces;
+  if (hasAlpha) {
+    surfaces = visibleSurfaces();
+  }
+  QPainter painter(frameBuffer);
+  painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+  for (QRect rect : event.region) {
     if (hasAlpha) {
       painter.fillRect(rect, Qt::white);
-      for (auto& surface : visibleSurfaces()) {
+      for (auto& surface : std::as_const(surfaces)) {
         if (surface != nullptr) {
           repaintSurface(&painter, &rect, surface);
         }
@@ -346,37 +978,130 @@ GUIThread::redraw(RepaintRequest& event) {
     } else {
       repaintSurface(&painter, &rect, event.surface);
     }
-    painter.end();
-    sendUpdate(
-      rect, event.waveform, event.contentType, event.mode, event.marker
-    );
   }
+  painter.end();
+  m_inkRegion -= region;
+  // Only a single swap is needed for the whole region, portions that were
+  // not painted still contain what is currently on the screen
+  sendUpdate(
+    region.boundingRect(),
+    event.waveform,
+    event.contentType,
+    event.mode
+  );
   O_DEBUG(
     "Repaint" << region.boundingRect() << "done in" << region.rectCount()
               << "paints, and" << cw.elapsed() << "seconds"
   );
 }
 
+std::shared_ptr<Surface>
+GUIThread::scanoutSurface(const RepaintRequest& event) {
+  auto scene = dbusInterface->scene();
+  if (scene->surfaces.isEmpty() || !scene->opaque.last()) {
+    return nullptr;
+  }
+  auto surface = scene->surfaces.last();
+  if (!event.global && event.surface != surface) {
+    return nullptr;
+  }
+  if (surface->isRemoved() || surface->scale() != 1.0) {
+    return nullptr;
+  }
+  if (
+    surface->geometry().translated(-m_screenGeometry.topLeft()) != m_screenRect
+  ) {
+    return nullptr;
+  }
+  auto image = surface->image();
+  if (image == nullptr || image->size() != m_screenRect.size()) {
+    return nullptr;
+  }
+  return surface;
+}
+
 void
+GUIThread::scanout(
+  QImage* frameBuffer,
+  const QImage& image,
+  const QRect& rect
+) {
+  const QRect target = rect.intersected(m_screenRect);
+  if (target.isEmpty()) {
+    return;
+  }
+  if (image.format() != frameBuffer->format()) {
+    if (blit(frameBuffer, target, image, target.topLeft(), false)) {
+      return;
+    }
+    QPainter painter(frameBuffer);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(target, image, target);
+    return;
+  }
+  // Same format, copy the lines directly
+  const int bytesPerPixel = image.depth() / 8;
+  const size_t offset = target.x() * bytesPerPixel;
+  const size_t length = target.width() * bytesPerPixel;
+  for (int y = target.top(); y <= target.bottom(); y++) {
+    memcpy(
+      frameBuffer->scanLine(y) + offset, image.constScanLine(y) + offset, length
+    );
+  }
+}
+
+quint64
 GUIThread::sendUpdate(
+  const QRect& rect,
+  Blight::WaveformMode waveform,
+  Blight::ContentType contentType,
+  Blight::UpdateMode mode
+) {
+  return submitUpdate(rect, waveform, contentType, mode, true);
+}
+
+quint64
+GUIThread::submitUpdate(
   const QRect& rect,
   Blight::WaveformMode waveform,
   Blight::ContentType contentType,
   Blight::UpdateMode mode,
-  unsigned int marker
+  bool mirror
 ) {
-  Q_UNUSED(marker);
   auto instance = EPFramebuffer::instance();
   O_DEBUG("Sending screen update" << rect << waveform << contentType << mode);
+  // The update is worked out against previousBuffer, so it has to be up to
+  // date for this rect even if the mirrors haven't been flushed yet
+  QMutexLocker locker(&m_mirrorMutex);
+  flushPrevious(rect);
   instance->swapBuffers(
     rect,
     (EPContentType)contentType,
     (EPScreenMode)waveform,
     (EPFramebuffer::UpdateFlag)mode
   );
-  QPainter(&instance->previousBuffer)
-    .drawImage(rect, instance->frameBuffer, rect);
-  QPainter(&m_frameBufferImage).drawImage(rect, instance->frameBuffer, rect);
+  // Only counted once submitted, so that a sync issued for this update
+  // can't complete before it has been queued
+  auto swap = ++m_swapCount;
+  if (Blight::Trace::enabled()) {
+    QMutexLocker markersLocker(&m_markersMutex);
+    auto input = Blight::Trace::last_input();
+    // Only one update is traced at a time, a sync covers the later ones
+    if (!m_tracedSwap && input != m_tracedInput) {
+      m_tracedSwap = swap;
+      m_tracedInput = input;
+      m_markersWait.wakeAll();
+    }
+  }
+  // The mirrors are only copied once there is a pause in drawing, or
+  // something needs to read them
+  m_previousDirty += rect;
+  if (mirror) {
+    m_mirrorDirty += rect;
+  } else {
+    m_mirrorDirty -= rect;
+  }
+  return swap;
 }
 
 void
@@ -393,44 +1118,16 @@ GUIThread::swap(
   QPainter painter(getFrameBuffer());
   painter.drawImage(rect, m_frameBufferImage, rect);
   painter.end();
-  guiThread->sendUpdate(rect, waveform, contentType, mode, 0);
+  // m_frameBufferImage is where this content came from, and the client may
+  // already be drawing the next frame into it
+  submitUpdate(rect, waveform, contentType, mode, false);
 }
 
 QList<std::shared_ptr<Surface>>
 GUIThread::visibleSurfaces() {
-  auto visibleSurfaces = dbusInterface->visibleSurfaces();
-  visibleSurfaces.erase(
-    std::remove_if(
-      visibleSurfaces.begin(),
-      visibleSurfaces.end(),
-      [](std::shared_ptr<Surface> surface) {
-        auto connection = surface->connection();
-        if (connection == nullptr) {
-          return true;
-        }
-        if (
-          !connection->isRunning() &&
-          (!connection->has("unified") ||
-           !dbusInterface->hasRunningConnection(connection->pgid()))
-        ) {
-          return true;
-        }
-        if (!surface->has("system") && getpgid(connection->pgid()) < 0) {
-          O_WARNING(surface->id() << "With no running process");
-          return true;
-        }
-        auto image = surface->image();
-        if (image == nullptr || image->isNull()) {
-          O_WARNING(surface->id() << "Null framebuffer");
-          return true;
-        }
-        return false;
-      }
-    ),
-    visibleSurfaces.end()
-  );
-  return visibleSurfaces;
+  return dbusInterface->scene()->surfaces;
 }
+
 QImage*
 GUIThread::getFrameBuffer() {
   auto* instance = EPFramebuffer::instance();
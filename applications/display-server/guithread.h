@@ -4,17 +4,27 @@
 #include <libblight/libblight.h>
 #include <liboxide/threading.h>
 
+#include <QDeadlineTimer>
 #include <QMetaType>
 #include <QMutex>
 #include <QQueue>
+#include <QReadWriteLock>
 #include <QSemaphore>
 #include <QThread>
 #include <QWaitCondition>
 
+#include <array>
+#include <atomic>
+#include <deque>
+#include <map>
+
 #include "surface.h"
 
 #define guiThread GUIThread::singleton()
 
+// Markers are chosen by clients, so they are only unique per connection
+typedef std::pair<Connection*, unsigned int> MarkerKey;
+
 struct RepaintRequest {
   std::shared_ptr<Surface> surface;
   QRegion region;
@@ -22,8 +32,54 @@ struct RepaintRequest {
   Blight::ContentType contentType;
   Blight::UpdateMode mode;
   unsigned int marker;
+  // Every marker that this request covers after coalescing
+  std::vector<MarkerKey> markers;
   bool global;
   std::function<void()> callback;
+  Blight::ClockWatch queued;
+};
+
+enum RepaintClass {
+  PenRepaint = 0,
+  NormalRepaint,
+  RepaintClassCount,
+};
+
+struct RepaintQueue {
+  std::weak_ptr<Connection> connection;
+  moodycamel::ConcurrentQueue<RepaintRequest> pen;
+  moodycamel::ConcurrentQueue<RepaintRequest> normal;
+};
+
+struct MarkerWaiter {
+  Connection* connection;
+  std::function<void()> callback;
+};
+
+struct MarkerState {
+  // Screen update that drew the marker, 0 while it is still queued
+  quint64 swap = 0;
+  std::vector<MarkerWaiter> waiters;
+};
+
+// Provisional ink drawn straight from pen input, see InkOverlay
+struct InkSegment {
+  QPoint from;
+  QPoint to;
+  // Where the stroke is expected to be by the time the update is visible
+  QPoint predicted;
+  // Part of the surface that isn't covered by anything above it
+  QRegion clip;
+  int width = 1;
+  // The pen has been lifted
+  bool end = false;
+};
+
+struct RepaintDelay {
+  std::atomic<quint64> count{0};
+  std::atomic<quint64> total{0};
+  std::atomic<quint64> max{0};
+  std::atomic<quint64> last{0};
 };
 
 class GUIThread : public QThread {
@@ -42,7 +98,7 @@ signals:
 public slots:
   void enqueue(
     std::shared_ptr<Surface> surface,
-    QRect region,
+    QRegion region,
     Blight::WaveformMode waveform,
     Blight::ContentType contentType,
     Blight::UpdateMode mode,
@@ -51,13 +107,19 @@ public slots:
     std::function<void()> callback = nullptr
   );
   void notify();
+  void syncMirrors();
   Blight::shared_buf_t framebuffer();
-  void sendUpdate(
+  QVariantMap repaintQueueDelays();
+  void waitForMarker(
+    Connection* connection,
+    unsigned int marker,
+    std::function<void()> callback
+  );
+  quint64 sendUpdate(
     const QRect& rect,
     Blight::WaveformMode waveform,
     Blight::ContentType contentType,
-    Blight::UpdateMode mode,
-    unsigned int marker
+    Blight::UpdateMode mode
   );
   void swap(
     const QRect& rect,
@@ -65,26 +127,87 @@ public slots:
     Blight::ContentType contentType,
     Blight::UpdateMode mode
   );
+  void drawInk(const InkSegment& segment);
+  const QRect& screenGeometry() const { return m_screenGeometry; }
 
 private:
   GUIThread(QRect screenGeometry);
-  moodycamel::ConcurrentQueue<RepaintRequest> m_repaintEvents;
+  QReadWriteLock m_repaintQueuesLock;
+  std::map<Connection*, std::shared_ptr<RepaintQueue>> m_repaintQueues;
+  Connection* m_lastServed = nullptr;
+  int m_servedCount = 0;
+  std::array<RepaintDelay, RepaintClassCount> m_repaintDelays;
+  int m_coalesceWindow;
   Blight::shared_buf_t m_frameBuffer = nullptr;
-  QAtomicInteger<unsigned int> m_currentMarker;
+  QMutex m_markersMutex;
+  QWaitCondition m_markersWait;
+  std::map<MarkerKey, MarkerState> m_markers;
+  std::deque<MarkerKey> m_markerOrder;
+  std::multimap<quint64, MarkerWaiter> m_swapWaiters;
+  std::atomic<quint64> m_swapCount{0};
+  quint64 m_completedSwap = 0;
+  // Swap whose completion is recorded as UpdateComplete, and the input frame
+  // it is recorded against, protected by m_markersMutex
+  quint64 m_tracedSwap = 0;
+  quint64 m_tracedInput = 0;
+  bool m_stopCompletion = false;
+  QThread* m_completionThread = nullptr;
   QMutex m_repaintMutex;
   QWaitCondition m_repaintWait;
   QRect m_screenGeometry;
   QPoint m_screenOffset;
   QRect m_screenRect;
   QImage m_frameBufferImage;
+  QMutex m_mirrorMutex;
+  QRegion m_mirrorDirty;
+  QRegion m_previousDirty;
+  // Set when another thread is waiting on m_mirrorWait for the mirrors to be
+  // flushed, protected by m_repaintMutex
+  bool m_mirrorRequested = false;
+  QWaitCondition m_mirrorWait;
+  moodycamel::ConcurrentQueue<InkSegment> m_ink;
+  // Provisional ink that hasn't been painted over by a surface yet
+  QRegion m_inkRegion;
+  QDeadlineTimer m_inkExpiry{QDeadlineTimer::Forever};
 
   void clearFrameBuffer();
+  void flushPrevious(const QRegion& region);
+  void flushMirrors();
+  void serveMirrorRequest();
+  quint64 submitUpdate(
+    const QRect& rect,
+    Blight::WaveformMode waveform,
+    Blight::ContentType contentType,
+    Blight::UpdateMode mode,
+    bool mirror
+  );
+  void flushInk();
+  void expireInk();
+  QDeadlineTimer idleDeadline();
   void repaintSurface(
     QPainter* painter,
     const QRect* rect,
     std::shared_ptr<Surface> surface
   );
   void redraw(RepaintRequest& event);
+  std::shared_ptr<Surface> scanoutSurface(const RepaintRequest& event);
+  void scanout(QImage* frameBuffer, const QImage& image, const QRect& rect);
+  bool blit(
+    QImage* frameBuffer,
+    const QRect& rect,
+    const QImage& image,
+    const QPoint& source,
+    bool blend
+  );
+  void coalesce(std::vector<RepaintRequest>& pending, RepaintRequest& event);
+  std::shared_ptr<RepaintQueue> repaintQueue(std::shared_ptr<Surface> surface);
+  bool dequeue(RepaintRequest& event);
+  void pruneRepaintQueues();
+  void registerMarkers(const std::vector<MarkerKey>& markers);
+  void markersSwapped(const std::vector<MarkerKey>& markers, quint64 swap);
+  void forgetMarkers(Connection* connection);
+  void completeUpdates();
+  static RepaintClass repaintClass(const RepaintRequest& event);
   QList<std::shared_ptr<Surface>> visibleSurfaces();
   static QImage* getFrameBuffer();
 };
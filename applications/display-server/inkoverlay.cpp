@@ -0,0 +1,197 @@
+#include "inkoverlay.h"
+#ifdef EPAPER
+#include <algorithm>
+#include <cmath>
+
+#include "dbusinterface.h"
+#include "guithread.h"
+#include "surface.h"
+
+// Limits on what clients can ask for, so that a bad request can't cover the
+// screen in ink
+constexpr unsigned int INK_MAX_WIDTH = 32;
+constexpr unsigned int INK_MAX_PREDICTION = 50;
+// Furthest the stroke is extended past the latest sample, in pixels
+constexpr double INK_MAX_PREDICTION_DISTANCE = 48;
+// Weight given to the newest sample when smoothing the velocity
+constexpr double INK_VELOCITY_SMOOTHING = 0.5;
+
+InkOverlay::InkOverlay(
+  const input_absinfo& x,
+  const input_absinfo& y,
+  const QRect& screenGeometry
+)
+  : m_x(x)
+  , m_y(y)
+  , m_screenGeometry(screenGeometry) {}
+
+void
+InkOverlay::handleEvents(const std::vector<input_event>& events) {
+  bool down = m_down;
+  for (auto& event : events) {
+    if (event.type == EV_ABS) {
+      switch (event.code) {
+        case ABS_X:
+          m_rawX = event.value;
+          break;
+        case ABS_Y:
+          m_rawY = event.value;
+          break;
+        default:
+          break;
+      }
+    } else if (event.type == EV_KEY) {
+      switch (event.code) {
+        case BTN_TOUCH:
+          down = event.value != 0;
+          break;
+        case BTN_TOOL_RUBBER:
+          m_eraser = event.value != 0;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  if (!down) {
+    if (m_down) {
+      m_down = false;
+      endStroke();
+    }
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  auto point = position();
+  if (!m_down) {
+    m_down = true;
+    startStroke(point, now);
+    return;
+  }
+  if (m_surface != nullptr) {
+    continueStroke(point, now);
+  }
+}
+
+QPoint
+InkOverlay::position() {
+  // Same mapping the QPA uses, so that the ink lands where the client will
+  // draw it
+  auto rangeX = m_x.maximum - m_x.minimum;
+  auto rangeY = m_y.maximum - m_y.minimum;
+  double nx = rangeX ? (m_rawX - m_x.minimum) / double(rangeX) : 0;
+  double ny = rangeY ? (m_rawY - m_y.minimum) / double(rangeY) : 0;
+  return QPoint(
+    m_screenGeometry.x() + std::lround(nx * m_screenGeometry.width()),
+    m_screenGeometry.y() + std::lround(ny * m_screenGeometry.height())
+  );
+}
+
+std::shared_ptr<Surface>
+InkOverlay::surfaceAt(const QPoint& point) {
+  auto route = dbusInterface->inputRoute();
+  if (route->focused == nullptr) {
+    return nullptr;
+  }
+  // Only the topmost surface under the pen can be drawn on, and only if the
+  // input is going to the connection that owns it
+  auto scene = dbusInterface->scene();
+  for (int i = scene->surfaces.size() - 1; i >= 0; --i) {
+    auto& surface = scene->surfaces.at(i);
+    if (!surface->geometry().contains(point)) {
+      continue;
+    }
+    if (
+      surface->isRemoved() || !surface->inkOverlay() ||
+      surface->connection() != route->focused
+    ) {
+      return nullptr;
+    }
+    return surface;
+  }
+  return nullptr;
+}
+
+QRegion
+InkOverlay::visibleRegion(const std::shared_ptr<Surface>& surface) {
+  // Anything above the surface is drawn over it, popups included, so the ink
+  // must not go there either. Checked on every segment as the scene may
+  // change during the stroke.
+  QRegion region(surface->geometry());
+  auto scene = dbusInterface->scene();
+  for (int i = scene->surfaces.size() - 1; i >= 0; --i) {
+    auto& above = scene->surfaces.at(i);
+    if (above == surface) {
+      return region;
+    }
+    region -= above->geometry();
+  }
+  // No longer in the scene
+  return QRegion();
+}
+
+void
+InkOverlay::startStroke(const QPoint& point, time_point now) {
+  m_surface = m_eraser ? nullptr : surfaceAt(point);
+  if (m_surface == nullptr) {
+    return;
+  }
+  m_last = point;
+  m_lastTime = now;
+  m_velocity = QPointF();
+  guiThread->drawInk(InkSegment{
+    .from = point,
+    .to = point,
+    .predicted = point,
+    .clip = visibleRegion(m_surface),
+    .width = (int)std::clamp(m_surface->inkWidth(), 1u, INK_MAX_WIDTH),
+    .end = false,
+  });
+}
+
+void
+InkOverlay::continueStroke(const QPoint& point, time_point now) {
+  if (m_surface->isRemoved() || !m_surface->inkOverlay()) {
+    endStroke();
+    return;
+  }
+  if (point == m_last) {
+    return;
+  }
+  double elapsed =
+    std::chrono::duration<double, std::milli>(now - m_lastTime).count();
+  if (elapsed > 0) {
+    QPointF velocity = QPointF(point - m_last) / elapsed;
+    m_velocity = m_velocity * (1 - INK_VELOCITY_SMOOTHING) +
+                 velocity * INK_VELOCITY_SMOOTHING;
+  }
+  QPoint predicted = point;
+  auto prediction = std::min(m_surface->inkPrediction(), INK_MAX_PREDICTION);
+  if (prediction) {
+    QPointF offset = m_velocity * prediction;
+    double distance = std::hypot(offset.x(), offset.y());
+    if (distance > INK_MAX_PREDICTION_DISTANCE) {
+      offset *= INK_MAX_PREDICTION_DISTANCE / distance;
+    }
+    predicted = point + offset.toPoint();
+  }
+  guiThread->drawInk(InkSegment{
+    .from = m_last,
+    .to = point,
+    .predicted = predicted,
+    .clip = visibleRegion(m_surface),
+    .width = (int)std::clamp(m_surface->inkWidth(), 1u, INK_MAX_WIDTH),
+    .end = false,
+  });
+  m_last = point;
+  m_lastTime = now;
+}
+
+void
+InkOverlay::endStroke() {
+  if (m_surface == nullptr) {
+    return;
+  }
+  m_surface = nullptr;
+  guiThread->drawInk(InkSegment{.end = true});
+}
+#endif
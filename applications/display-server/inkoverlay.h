@@ -0,0 +1,54 @@
+#pragma once
+#ifdef EPAPER
+#include <linux/input.h>
+
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRegion>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+class Surface;
+
+// Draws provisional ink for pen strokes as soon as they are read from the
+// device, so that ink appears under the pen without waiting for the client
+// to receive the events, draw them and request a repaint
+class InkOverlay {
+public:
+  InkOverlay(
+    const input_absinfo& x,
+    const input_absinfo& y,
+    const QRect& screenGeometry
+  );
+  // Called on the input thread with each complete frame from the tablet
+  void handleEvents(const std::vector<input_event>& events);
+
+private:
+  typedef std::chrono::steady_clock::time_point time_point;
+
+  input_absinfo m_x;
+  input_absinfo m_y;
+  QRect m_screenGeometry;
+  int m_rawX = 0;
+  int m_rawY = 0;
+  bool m_down = false;
+  bool m_eraser = false;
+  // Surface the current stroke is being drawn over, nullptr if the stroke
+  // isn't being drawn
+  std::shared_ptr<Surface> m_surface;
+  QPoint m_last;
+  time_point m_lastTime;
+  // Smoothed pen velocity in pixels per millisecond
+  QPointF m_velocity;
+
+  QPoint position();
+  std::shared_ptr<Surface> surfaceAt(const QPoint& point);
+  QRegion visibleRegion(const std::shared_ptr<Surface>& surface);
+  void startStroke(const QPoint& point, time_point now);
+  void continueStroke(const QPoint& point, time_point now);
+  void endStroke();
+};
+#endif
@@ -32,7 +32,10 @@ Surface::Surface(
   , m_format(format)
   , m_fd{fd}
   , m_removed{false}
-  , m_scale{scale} {
+  , m_scale{scale}
+  , m_inkOverlay{false}
+  , m_inkWidth{2}
+  , m_inkPrediction{0} {
   m_connection = dbusInterface->getConnection(connection);
   if (m_connection == nullptr) {
     S_WARNING("Failed to get shared pointer to connection");
@@ -292,6 +295,32 @@ Surface::removed() {
   m_removed = true;
 }
 
+void
+Surface::setInkOverlay(
+  bool enabled,
+  unsigned int width,
+  unsigned int prediction
+) {
+  m_inkWidth = width;
+  m_inkPrediction = prediction;
+  m_inkOverlay = enabled;
+}
+
+bool
+Surface::inkOverlay() {
+  return m_inkOverlay;
+}
+
+unsigned int
+Surface::inkWidth() {
+  return m_inkWidth;
+}
+
+unsigned int
+Surface::inkPrediction() {
+  return m_inkPrediction;
+}
+
 #ifndef EPAPER
 void
 Surface::activeFocusChanged(bool focus) {
@@ -6,6 +6,7 @@
 #include <QQuickPaintedItem>
 #include <QRect>
 
+#include <atomic>
 #include <memory>
 #include <sys/mman.h>
 
@@ -55,6 +56,10 @@ public:
   std::shared_ptr<Connection> connection();
   bool isRemoved();
   void removed();
+  void setInkOverlay(bool enabled, unsigned int width, unsigned int prediction);
+  bool inkOverlay();
+  unsigned int inkWidth();
+  unsigned int inkPrediction();
 
 signals:
   void update(const QRect& geometry);
@@ -81,4 +86,8 @@ private:
   QStringList flags;
   bool m_removed;
   double m_scale;
+  // Read from the input thread
+  std::atomic<bool> m_inkOverlay;
+  std::atomic<unsigned int> m_inkWidth;
+  std::atomic<unsigned int> m_inkPrediction;
 };
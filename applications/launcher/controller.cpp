@@ -261,39 +261,41 @@ Controller::saveSettings() {
 }
 QList<QObject*>
 Controller::getApps() {
-  auto bus = QDBusConnection::systemBus();
-  auto running = appsApi->runningApplications();
-  auto paused = appsApi->pausedApplications();
-  for (auto key : paused.keys()) {
-    if (running.contains(key)) {
+  // Everything comes from a single call, instead of a round-trip for each
+  // property of each application
+  QDBusPendingReply<QVariantMap> reply = appsApi->applicationSnapshot();
+  reply.waitForFinished();
+  if (reply.isError()) {
+    qDebug() << "Failed to get applications:" << reply.error().message();
+    return applications;
+  }
+  auto snapshot = reply.value();
+  auto entries = qdbus_cast<QVariantMap>(snapshot["applications"]);
+  for (auto item : entries) {
+    auto app = qdbus_cast<QVariantMap>(item);
+    if (app["hidden"].toBool() || app["transient"].toBool()) {
       continue;
     }
-    running.insert(key, paused[key]);
-  }
-  for (auto item : appsApi->applications()) {
-    auto path = item.value<QDBusObjectPath>().path();
-    Application app(OXIDE_SERVICE, path, bus, this);
-    if (app.hidden() || app.transient()) {
-      continue;
-    }
-    auto name = app.name();
+    auto name = app["name"].toString();
     auto appItem = getApplication(name);
     if (appItem == nullptr) {
       qDebug() << "New application:" << name;
       appItem = new AppItem(this);
       applications.append(appItem);
     }
-    auto displayName = app.displayName();
+    auto displayName = app["displayName"].toString();
     if (displayName.isEmpty()) {
       displayName = name;
     }
-    appItem->setProperty("path", path);
+    // Anything other than Inactive is either running or paused
+    auto state = app["state"].toInt();
+    appItem->setProperty("path", app["path"].toString());
     appItem->setProperty("name", name);
     appItem->setProperty("displayName", displayName);
-    appItem->setProperty("desc", app.description());
-    appItem->setProperty("call", app.bin());
-    appItem->setProperty("running", running.contains(name));
-    auto icon = app.icon();
+    appItem->setProperty("desc", app["description"].toString());
+    appItem->setProperty("call", app["bin"].toString());
+    appItem->setProperty("running", state != 0);
+    auto icon = app["icon"].toString();
     if (!icon.isEmpty() && QFile(icon).exists()) {
       appItem->setProperty("imgFile", "file:" + icon);
     } else {
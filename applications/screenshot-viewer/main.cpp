@@ -9,6 +9,7 @@
 #include <cstdlib>
 
 #include "controller.h"
+#include "thumbnailprovider.h"
 
 using namespace std;
 using namespace Oxide;
@@ -34,6 +35,7 @@ main(int argc, char* argv[]) {
   Controller controller(&app);
   QQmlApplicationEngine engine;
   registerQML(&engine);
+  engine.addImageProvider("thumbnail", new ThumbnailProvider());
   QQmlContext* context = engine.rootContext();
   context->setContextProperty("controller", &controller);
 
@@ -153,7 +153,7 @@ OxideWindow {
                 delegate: AppItem {
                     enabled: screenshots.enabled
                     text: model.display.name
-                    source: 'file:' + model.display.path
+                    source: model.display.thumbnail
                     width: screenshots.cellWidth
                     height: screenshots.cellHeight
                     onClicked: {
@@ -27,7 +27,8 @@ INSTALLS += icons
 
 HEADERS += \
     controller.h \
-    screenshotlist.h
+    screenshotlist.h \
+    thumbnailprovider.h
 
 RESOURCES += \
     qml.qrc
@@ -11,12 +11,20 @@ class ScreenshotItem : public QObject {
   Q_OBJECT
   Q_PROPERTY(QString path READ path NOTIFY pathChanged)
   Q_PROPERTY(QString name READ name NOTIFY nameChanged)
+  Q_PROPERTY(QString thumbnail READ thumbnail NOTIFY thumbnailChanged)
 
 public:
   ScreenshotItem(Screenshot* screenshot, QObject* parent)
-    : QObject(parent) {
+    : QObject(parent)
+    , m_revision(0) {
     m_screenshot = screenshot;
     connect(screenshot, &Screenshot::modified, this, &ScreenshotItem::modified);
+    connect(
+      screenshot,
+      &Screenshot::thumbnailChanged,
+      this,
+      &ScreenshotItem::updateThumbnail
+    );
   }
   ~ScreenshotItem() {
     if (m_screenshot != nullptr) {
@@ -30,6 +38,13 @@ public:
     return m_screenshot->path();
   }
   QString name() { return QFileInfo(path()).baseName(); }
+  QString thumbnail() {
+    if (m_screenshot == nullptr) {
+      return "";
+    }
+    // The revision makes the image cache load the new thumbnail
+    return QString("image://thumbnail/%1%2").arg(m_revision).arg(qPath());
+  }
   bool is(Screenshot* screenshot) { return screenshot == m_screenshot; }
   Screenshot* screenshot() { return m_screenshot; }
   bool remove() {
@@ -46,15 +61,21 @@ public:
 signals:
   void pathChanged(QString);
   void nameChanged(QString);
+  void thumbnailChanged(QString);
 
 public slots:
   void modified() {
     emit pathChanged(path());
     emit nameChanged(name());
   }
+  void updateThumbnail() {
+    m_revision++;
+    emit thumbnailChanged(thumbnail());
+  }
 
 private:
   Screenshot* m_screenshot;
+  int m_revision;
 };
 
 class ScreenshotList : public QAbstractListModel {
@@ -0,0 +1,67 @@
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include <liboxide/dbus.h>
+
+#include <QFile>
+#include <QImageReader>
+#include <QQuickImageProvider>
+#include <unistd.h>
+
+using namespace codes::eeems::oxide1;
+
+// Loads grid thumbnails from the cache tarnish keeps instead of decoding every
+// full size screenshot. Ids are "<revision>/<screenshot object path>".
+class ThumbnailProvider : public QQuickImageProvider {
+public:
+  ThumbnailProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image) {}
+
+  QImage
+  requestImage(const QString& id, QSize* size, const QSize& requestedSize)
+    override {
+    auto objectPath = id.mid(id.indexOf('/'));
+    Screenshot screenshot(
+      OXIDE_SERVICE, objectPath, QDBusConnection::systemBus()
+    );
+    QImage image = readThumbnail(screenshot);
+    if (image.isNull()) {
+      // Not generated yet, fall back to scaling the screenshot while decoding
+      QImageReader reader(screenshot.path());
+      auto imageSize = reader.size();
+      if (imageSize.isValid() && requestedSize.isValid()) {
+        reader.setScaledSize(
+          imageSize.scaled(requestedSize, Qt::KeepAspectRatio)
+        );
+      }
+      image = reader.read();
+    }
+    if (size != nullptr) {
+      *size = image.size();
+    }
+    return image;
+  }
+
+private:
+  QImage readThumbnail(Screenshot& screenshot) {
+    auto reply = screenshot.thumbnail();
+    reply.waitForFinished();
+    if (reply.isError() || !reply.value().isValid()) {
+      return QImage();
+    }
+    QFile file;
+    // QFile takes ownership of the duplicated descriptor
+    if (!file.open(
+          ::dup(reply.value().fileDescriptor()),
+          QIODevice::ReadOnly,
+          QFileDevice::AutoCloseHandle
+        )) {
+      return QImage();
+    }
+    QImage image;
+    image.load(&file, "png");
+    return image;
+  }
+};
+
+#endif // THUMBNAILPROVIDER_H
@@ -12,6 +12,7 @@
 
 #include "apibase.h"
 #include "appsapi.h"
+#include "framebuffersnapshot.h"
 #include "notificationapi.h"
 #include "screenapi.h"
 #include "systemapi.h"
@@ -212,7 +213,7 @@ Application::interruptApplication() {
       Q_UNUSED(t);
 #endif
       if (flags().contains("exclusive")) {
-        m_backup = new QImage(getFrameBuffer()->copy());
+        backupFrameBuffer();
       }
       if (!onPause().isEmpty()) {
         Oxide::Sentry::sentry_span(
@@ -263,6 +264,57 @@ Application::interruptApplication() {
   );
 }
 void
+Application::backupFrameBuffer() {
+  if (m_backup != nullptr) {
+    delete m_backup;
+    m_backup = nullptr;
+  }
+  auto frameBuffer = getFrameBuffer();
+  if (frameBuffer == nullptr) {
+    return;
+  }
+  QElapsedTimer elapsed;
+  elapsed.start();
+  auto backup = new FrameBufferSnapshot(*frameBuffer);
+  auto compressTime = elapsed.nsecsElapsed() / 1000;
+  if (!backup->isValid()) {
+    O_WARNING("Unable to back up framebuffer" << frameBuffer->format());
+    delete backup;
+    return;
+  }
+  m_backup = backup;
+  m_backupStats = QVariantMap{
+    {"size", (qlonglong)m_backup->size()},
+    {"compressedSize", (qlonglong)m_backup->compressedSize()},
+    {"compressionRatio", m_backup->compressionRatio()},
+    {"compressTime", (qlonglong)compressTime},
+  };
+  O_DEBUG(
+    "Framebuffer backup for" << name() << m_backup->compressedSize()
+                             << "bytes, ratio" << m_backup->compressionRatio()
+                             << "in" << compressTime << "us"
+  );
+}
+bool
+Application::restoreFrameBuffer(QImage* frameBuffer) {
+  if (m_backup == nullptr) {
+    return false;
+  }
+  QElapsedTimer elapsed;
+  elapsed.start();
+  auto restored = m_backup->restore(frameBuffer);
+  auto restoreTime = elapsed.nsecsElapsed() / 1000;
+  delete m_backup;
+  m_backup = nullptr;
+  if (!restored) {
+    O_WARNING("Unable to restore framebuffer backup for" << name());
+    return false;
+  }
+  m_backupStats["restoreTime"] = (qlonglong)restoreTime;
+  O_DEBUG("Framebuffer restored for" << name() << "in" << restoreTime << "us");
+  return true;
+}
+void
 Application::waitForPause() {
   if (stateNoSecurityCheck() == Paused) {
     return;
@@ -347,15 +399,11 @@ Application::uninterruptApplication() {
         auto compositor = getCompositorDBus();
         compositor->enterExclusiveMode().waitForFinished();
         auto frameBuffer = getFrameBuffer();
-        QPainter p(frameBuffer);
-        if (m_backup == nullptr) {
+        if (!restoreFrameBuffer(frameBuffer)) {
+          QPainter p(frameBuffer);
           p.fillRect(frameBuffer->rect(), Qt::white);
-        } else {
-          p.drawImage(frameBuffer->rect(), *m_backup, m_backup->rect());
-          delete m_backup;
-          m_backup = nullptr;
+          p.end();
         }
-        p.end();
         compositor->exclusiveModeRepaintFull().waitForFinished();
       }
 #ifdef SENTRY
@@ -639,6 +687,11 @@ Application::directories() {
   return value("directories", QStringList()).toStringList();
 }
 
+QVariantMap
+Application::frameBufferBackup() {
+  return m_backupStats;
+}
+
 const QVariantMap&
 Application::getConfig() {
   return m_config;
@@ -967,6 +1020,10 @@ Application::Application(QString path, QObject* parent)
 Application::~Application() {
   stopNoSecurityCheck();
   unregisterPath();
+  if (m_backup != nullptr) {
+    delete m_backup;
+    m_backup = nullptr;
+  }
   if (m_screenCapture != nullptr) {
     delete m_screenCapture;
     m_screenCapture = nullptr;
@@ -34,6 +34,8 @@
 class Notification;
 #include "notification.h"
 
+class FrameBufferSnapshot;
+
 // Must be included so that generate_xml.sh will work
 #include "../../shared/liboxide/meta.h"
 
@@ -99,6 +101,7 @@ class Application : public QObject {
   Q_PROPERTY(QString user READ user)
   Q_PROPERTY(QString group READ group)
   Q_PROPERTY(QStringList directories READ directories)
+  Q_PROPERTY(QVariantMap frameBufferBackup READ frameBufferBackup)
 
 public:
   Application(QDBusObjectPath path, QObject* parent)
@@ -158,6 +161,7 @@ public:
   QString user();
   QString group();
   QStringList directories();
+  QVariantMap frameBufferBackup();
 
   const QVariantMap& getConfig();
   void setConfig(const QVariantMap& config);
@@ -214,12 +218,15 @@ private:
   int p_stderr_fd = -1;
   QTextStream* p_stderr = nullptr;
   Notification* m_notification = nullptr;
-  QImage* m_backup = nullptr;
+  FrameBufferSnapshot* m_backup = nullptr;
+  QVariantMap m_backupStats;
 
   bool
   hasPermission(QString permission, const char* sender = __builtin_FUNCTION());
   void delayUpTo(int milliseconds);
   void updateEnvironment();
+  void backupFrameBuffer();
+  bool restoreFrameBuffer(QImage* frameBuffer);
   void startSpan(std::string operation, std::string description);
 };
 
@@ -8,6 +8,10 @@
 #include "notificationapi.h"
 #include "systemapi.h"
 
+// Number of snapshot versions that removals are remembered for. Callers
+// asking for changes from before that get a full snapshot instead
+#define SNAPSHOT_VERSION_HISTORY 256
+
 using namespace Oxide;
 
 AppsAPI*
@@ -32,6 +36,26 @@ AppsAPI::AppsAPI(QObject* parent)
   , m_processManagerApplication("/")
   , m_taskSwitcherApplication("/")
   , m_sleeping(false) {
+  // Changes are collected for a loop iteration so that bursts, like a
+  // reload, turn into a single applicationsChanged signal
+  m_snapshotTimer.setSingleShot(true);
+  m_snapshotTimer.setInterval(0);
+  connect(&m_snapshotTimer, &QTimer::timeout, this, &AppsAPI::updateSnapshot);
+  for (auto signal :
+       {&AppsAPI::applicationRegistered,
+        &AppsAPI::applicationUnregistered,
+        &AppsAPI::applicationLaunched,
+        &AppsAPI::applicationPaused,
+        &AppsAPI::applicationResumed,
+        &AppsAPI::applicationSignaled}) {
+    connect(this, signal, &m_snapshotTimer, qOverload<>(&QTimer::start));
+  }
+  connect(
+    this,
+    &AppsAPI::applicationExited,
+    &m_snapshotTimer,
+    qOverload<>(&QTimer::start)
+  );
   Oxide::Sentry::sentry_transaction(
     "Init Apps API", "init", [this](Oxide::Sentry::Transaction* t) {
       Oxide::Sentry::sentry_span(
@@ -280,6 +304,18 @@ AppsAPI::registerApplicationNoSecurityCheck(QVariantMap properties) {
       auto displayName = properties.value("displayName", name).toString();
       app->setConfig(properties);
       applications.insert(name, app);
+      connect(
+        app,
+        &Application::displayNameChanged,
+        &m_snapshotTimer,
+        qOverload<>(&QTimer::start)
+      );
+      connect(
+        app,
+        &Application::iconChanged,
+        &m_snapshotTimer,
+        qOverload<>(&QTimer::start)
+      );
       app->registerPath();
       emit applicationRegistered(path);
     }
@@ -315,6 +351,7 @@ AppsAPI::reload() {
       readApplications();
     }
   );
+  m_snapshotTimer.start();
 }
 
 QDBusObjectPath
@@ -460,6 +497,127 @@ AppsAPI::pausedApplications() {
   return result;
 }
 
+QVariantMap
+AppsAPI::applicationSnapshot() {
+  QVariantMap result;
+  if (!hasPermission("apps")) {
+    return result;
+  }
+  updateSnapshot();
+  QVariantMap entries;
+  for (auto it = m_snapshot.cbegin(); it != m_snapshot.cend(); ++it) {
+    entries.insert(it.key(), it.value());
+  }
+  result["version"] = (qulonglong)m_snapshotVersion;
+  result["applications"] = entries;
+  return result;
+}
+
+QVariantMap
+AppsAPI::applicationChanges(qulonglong since) {
+  if (!hasPermission("apps")) {
+    return QVariantMap();
+  }
+  updateSnapshot();
+  // A version from before a restart or older than the removals that are
+  // still remembered can't be compared against, so the caller gets
+  // everything and should drop anything it doesn't see
+  if (since == 0 || since < m_snapshotHorizon || since > m_snapshotVersion) {
+    auto result = applicationSnapshot();
+    result["full"] = true;
+    result["removed"] = QStringList();
+    return result;
+  }
+  QVariantMap changed;
+  for (auto it = m_snapshotVersions.cbegin(); it != m_snapshotVersions.cend();
+       ++it) {
+    if (it.value() > since) {
+      changed.insert(it.key(), m_snapshot.value(it.key()));
+    }
+  }
+  QStringList removed;
+  for (auto it = m_removedVersions.cbegin(); it != m_removedVersions.cend();
+       ++it) {
+    if (it.value() > since) {
+      removed.append(it.key());
+    }
+  }
+  QVariantMap result;
+  result["version"] = (qulonglong)m_snapshotVersion;
+  result["full"] = false;
+  result["applications"] = changed;
+  result["removed"] = removed;
+  return result;
+}
+
+QVariantMap
+AppsAPI::snapshotEntry(Application* app) {
+  QVariantMap entry;
+  // Stored as a string so that entries compare by value
+  entry["path"] = app->qPath().path();
+  entry["name"] = app->name();
+  entry["displayName"] = app->displayName();
+  entry["description"] = app->description();
+  entry["bin"] = app->bin();
+  entry["icon"] = app->icon();
+  entry["type"] = app->type();
+  entry["state"] = app->stateNoSecurityCheck();
+  entry["hidden"] = app->hidden();
+  entry["transient"] = app->transient();
+  entry["systemApp"] = app->systemApp();
+  return entry;
+}
+
+void
+AppsAPI::updateSnapshot() {
+  m_snapshotTimer.stop();
+  // Properties are read locally, so comparing everything is cheaper than
+  // trying to catch every way an application can change
+  QVariantMap changed;
+  QStringList removed;
+  for (auto app : std::as_const(applications)) {
+    auto name = app->name();
+    auto entry = snapshotEntry(app);
+    auto it = m_snapshot.find(name);
+    if (it != m_snapshot.end() && it.value() == entry) {
+      continue;
+    }
+    m_snapshot.insert(name, entry);
+    changed.insert(name, entry);
+  }
+  for (auto it = m_snapshot.begin(); it != m_snapshot.end();) {
+    if (applications.contains(it.key())) {
+      ++it;
+      continue;
+    }
+    removed.append(it.key());
+    it = m_snapshot.erase(it);
+  }
+  if (changed.isEmpty() && removed.isEmpty()) {
+    return;
+  }
+  m_snapshotVersion++;
+  for (auto& name : changed.keys()) {
+    m_snapshotVersions[name] = m_snapshotVersion;
+    m_removedVersions.remove(name);
+  }
+  for (auto& name : std::as_const(removed)) {
+    m_snapshotVersions.remove(name);
+    m_removedVersions[name] = m_snapshotVersion;
+  }
+  if (m_snapshotVersion > SNAPSHOT_VERSION_HISTORY) {
+    m_snapshotHorizon = m_snapshotVersion - SNAPSHOT_VERSION_HISTORY;
+    for (auto it = m_removedVersions.begin(); it != m_removedVersions.end();) {
+      if (it.value() <= m_snapshotHorizon) {
+        it = m_removedVersions.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  emit applicationsChanged(m_snapshotVersion, changed, removed);
+}
+
 void
 AppsAPI::unregisterApplication(Application* app) {
   Oxide::Sentry::sentry_transaction(
@@ -918,19 +1076,15 @@ AppsAPI::readApplications() {
     }
   }
   settings.endArray();
-  // Load system applications from disk
-  QDir dir(OXIDE_APPLICATION_REGISTRATIONS_DIRECTORY);
-  dir.setNameFilters(QStringList() << "*.oxide");
-  QMap<QString, QJsonObject> apps;
-  for (auto entry : dir.entryInfoList()) {
-    auto app = getRegistration(entry.filePath());
-    if (app.isEmpty()) {
-      O_WARNING("Invalid file " << entry.filePath());
+  // Load system applications from disk, only files that have changed since
+  // the last load are parsed again
+  QMap<QString, QVariantMap> apps;
+  for (auto& registration : getRegistrations()) {
+    if (registration.properties.isEmpty()) {
+      O_WARNING("Invalid file " << registration.path);
       continue;
     }
-    auto name = entry.completeBaseName();
-    app["name"] = name;
-    apps.insert(name, app);
+    apps.insert(registration.name, registration.properties);
   }
   // Unregister any system applications that no longer exist on disk.
   for (auto application : applications.values()) {
@@ -941,21 +1095,17 @@ AppsAPI::readApplications() {
     }
   }
   // Register/Update any system application.
-  for (auto app : apps) {
-    auto name = app["name"].toString();
-    auto bin = app["bin"].toString();
+  for (auto properties : apps) {
+    auto name = properties["name"].toString();
+    auto bin = properties["bin"].toString();
     if (bin.isEmpty() || !QFile::exists(bin)) {
       O_WARNING(name << "Can't find application binary:" << bin);
-      O_DEBUG(app);
+      O_DEBUG(properties);
       continue;
     }
-    if (!app.contains("flags") || !app["flags"].isArray()) {
-      app["flags"] = QJsonArray();
-    }
-    auto flags = app["flags"].toArray();
+    auto flags = properties["flags"].toStringList();
     flags.prepend("system");
-    app["flags"] = flags;
-    auto properties = registrationToMap(app);
+    properties["flags"] = flags;
     if (applications.contains(name)) {
       O_DEBUG("Updating " << name);
       O_DEBUG(properties);
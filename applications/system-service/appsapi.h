@@ -91,6 +91,8 @@ public:
   Application* getApplication(QDBusObjectPath path);
   QStringList getPreviousApplications();
   Q_INVOKABLE QDBusObjectPath getApplicationPath(const QString& name);
+  Q_INVOKABLE QVariantMap applicationSnapshot();
+  Q_INVOKABLE QVariantMap applicationChanges(qulonglong since);
   Application* getApplication(const QString& name);
   void connectSignals(Application* app, int signal);
   void disconnectSignals(Application* app, int signal);
@@ -108,6 +110,7 @@ signals:
   void applicationResumed(QDBusObjectPath);
   void applicationSignaled(QDBusObjectPath);
   void applicationExited(QDBusObjectPath, int);
+  void applicationsChanged(qulonglong, QVariantMap, QStringList);
 
 public slots:
   QT_DEPRECATED void leftHeld();
@@ -131,6 +134,12 @@ private:
   QDBusObjectPath m_taskSwitcherApplication;
   bool m_sleeping;
   Application* resumeApp = nullptr;
+  quint64 m_snapshotVersion = 0;
+  quint64 m_snapshotHorizon = 0;
+  QMap<QString, QVariantMap> m_snapshot;
+  QMap<QString, quint64> m_snapshotVersions;
+  QMap<QString, quint64> m_removedVersions;
+  QTimer m_snapshotTimer;
   QString getPath(QString name);
   QString _noApplicationsMessage =
     "No applications have been found. This is the result of invalid "
@@ -147,5 +156,7 @@ private:
   static void migrate(QSettings* settings, int fromVersion);
   bool locked();
   void ensureForegroundApp();
+  QVariantMap snapshotEntry(Application* app);
+  void updateSnapshot();
 };
 #endif // APPSAPI_H
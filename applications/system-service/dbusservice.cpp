@@ -248,6 +248,18 @@ DBusService::tarnishPid() {
   return qApp->applicationPid();
 }
 
+int
+DBusService::debugLevel() {
+  return get_blight_debug_level();
+}
+
+void
+DBusService::setDebugLevel(int level) {
+  O_INFO("Debug level set to" << level);
+  set_blight_debug_level(level);
+  Oxide::setDebugEnabled(level >= LOG_DEBUG);
+}
+
 QDBusObjectPath
 DBusService::requestAPI(QString name, QDBusMessage message) {
 #ifdef SENTRY
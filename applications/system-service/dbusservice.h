@@ -32,6 +32,7 @@ class DBusService : public APIBase {
   Q_OBJECT
   Q_CLASSINFO("D-Bus Interface", OXIDE_GENERAL_INTERFACE)
   Q_PROPERTY(int tarnishPid READ tarnishPid)
+  Q_PROPERTY(int debugLevel READ debugLevel WRITE setDebugLevel)
 
 public:
   static DBusService* singleton();
@@ -43,6 +44,8 @@ public:
   QQmlApplicationEngine* engine();
 
   int tarnishPid();
+  int debugLevel();
+  void setDebugLevel(int level);
   void startup();
   void exit(int exitCode);
   void reload();
@@ -0,0 +1,233 @@
+#include "framebuffersnapshot.h"
+
+#include <QPainter>
+#include <algorithm>
+#include <cstring>
+
+// Tiles are PackBits encoded over whole pixels. A control byte below 128 is
+// followed by control + 1 literal pixels, anything else is followed by a
+// single pixel that repeats control - 126 times. Runs shorter than
+// MIN_RUN are stored as literals, which keeps the encoded size within one
+// byte per MAX_LITERAL pixels of the raw size.
+#define MAX_LITERAL 128
+#define MIN_RUN 3
+#define MAX_RUN 129
+
+template<int BPP>
+static qsizetype
+encodePixels(const uchar* in, int count, uchar* out) {
+  uchar* start = out;
+  uchar* control = nullptr;
+  int literals = 0;
+  int i = 0;
+  while (i < count) {
+    const uchar* pixel = in + i * BPP;
+    int run = 1;
+    while (
+      i + run < count && run < MAX_RUN &&
+      std::memcmp(pixel, in + (i + run) * BPP, BPP) == 0
+    ) {
+      run++;
+    }
+    if (run >= MIN_RUN) {
+      control = nullptr;
+      *out++ = (uchar)(run + 126);
+      std::memcpy(out, pixel, BPP);
+      out += BPP;
+      i += run;
+      continue;
+    }
+    for (int j = 0; j < run; j++) {
+      if (control == nullptr || literals == MAX_LITERAL) {
+        control = out++;
+        literals = 0;
+      }
+      std::memcpy(out, pixel, BPP);
+      out += BPP;
+      *control = (uchar)literals++;
+    }
+    i += run;
+  }
+  return out - start;
+}
+
+template<int BPP>
+static bool
+decodePixels(const uchar* in, qsizetype length, uchar* out, int count) {
+  const uchar* end = in + length;
+  int i = 0;
+  while (in < end) {
+    int control = *in++;
+    if (control < MAX_LITERAL) {
+      int literals = control + 1;
+      if (i + literals > count || end - in < (qsizetype)literals * BPP) {
+        return false;
+      }
+      std::memcpy(out + i * BPP, in, literals * BPP);
+      in += literals * BPP;
+      i += literals;
+      continue;
+    }
+    int run = control - 126;
+    if (i + run > count || end - in < BPP) {
+      return false;
+    }
+    for (int j = 0; j < run; j++, i++) {
+      std::memcpy(out + i * BPP, in, BPP);
+    }
+    in += BPP;
+  }
+  return i == count;
+}
+
+static qsizetype
+encodeTile(int bytesPerPixel, const uchar* in, int count, uchar* out) {
+  switch (bytesPerPixel) {
+    case 1:
+      return encodePixels<1>(in, count, out);
+    case 2:
+      return encodePixels<2>(in, count, out);
+    case 3:
+      return encodePixels<3>(in, count, out);
+    case 4:
+      return encodePixels<4>(in, count, out);
+    case 8:
+      return encodePixels<8>(in, count, out);
+    default:
+      return -1;
+  }
+}
+
+static bool
+decodeTile(
+  int bytesPerPixel,
+  const uchar* in,
+  qsizetype length,
+  uchar* out,
+  int count
+) {
+  switch (bytesPerPixel) {
+    case 1:
+      return decodePixels<1>(in, length, out, count);
+    case 2:
+      return decodePixels<2>(in, length, out, count);
+    case 3:
+      return decodePixels<3>(in, length, out, count);
+    case 4:
+      return decodePixels<4>(in, length, out, count);
+    case 8:
+      return decodePixels<8>(in, length, out, count);
+    default:
+      return false;
+  }
+}
+
+FrameBufferSnapshot::FrameBufferSnapshot(const QImage& image)
+  : m_valid{false}
+  , m_imageSize{image.size()}
+  , m_format{image.format()}
+  , m_bytesPerPixel{image.depth() / 8}
+  , m_size{0} {
+  if (image.isNull() || image.depth() % 8) {
+    return;
+  }
+  const int bpp = m_bytesPerPixel;
+  const int maxPixels = TILE_SIZE * TILE_SIZE;
+  // Each tile is gathered into a contiguous buffer first so that runs can
+  // continue from one row of the tile to the next
+  QByteArray pixels(maxPixels * bpp, Qt::Uninitialized);
+  QByteArray encoded(
+    maxPixels * bpp + maxPixels / MAX_LITERAL + 1, Qt::Uninitialized
+  );
+  auto* tile = reinterpret_cast<uchar*>(pixels.data());
+  auto* out = reinterpret_cast<uchar*>(encoded.data());
+  for (int y = 0; y < image.height(); y += TILE_SIZE) {
+    for (int x = 0; x < image.width(); x += TILE_SIZE) {
+      Tile t{
+        .x = x,
+        .y = y,
+        .width = std::min(TILE_SIZE, image.width() - x),
+        .height = std::min(TILE_SIZE, image.height() - y),
+        .offset = m_data.size(),
+        .length = 0,
+        .raw = false,
+      };
+      const int rowBytes = t.width * bpp;
+      for (int row = 0; row < t.height; row++) {
+        std::memcpy(
+          tile + row * rowBytes,
+          image.constScanLine(y + row) + x * bpp,
+          rowBytes
+        );
+      }
+      const qsizetype rawLength = (qsizetype)rowBytes * t.height;
+      auto length = encodeTile(bpp, tile, t.width * t.height, out);
+      if (length < 0) {
+        m_tiles.clear();
+        m_data.clear();
+        return;
+      }
+      // Noisy content can grow when encoded, so it is kept as is
+      t.raw = length >= rawLength;
+      t.length = t.raw ? rawLength : length;
+      auto* source = t.raw ? tile : out;
+      m_data.append(reinterpret_cast<const char*>(source), t.length);
+      m_tiles.append(t);
+    }
+  }
+  m_data.squeeze();
+  m_size = (qsizetype)image.width() * image.height() * bpp;
+  m_valid = true;
+}
+
+double
+FrameBufferSnapshot::compressionRatio() const {
+  if (m_data.isEmpty()) {
+    return 0;
+  }
+  return (double)m_size / m_data.size();
+}
+
+bool
+FrameBufferSnapshot::restore(QImage* image) const {
+  if (!m_valid || image == nullptr || image->isNull()) {
+    return false;
+  }
+  if (image->size() == m_imageSize && image->format() == m_format) {
+    return decode(image);
+  }
+  QImage decoded(m_imageSize, m_format);
+  if (decoded.isNull() || !decode(&decoded)) {
+    return false;
+  }
+  QPainter painter(image);
+  painter.drawImage(image->rect(), decoded, decoded.rect());
+  painter.end();
+  return true;
+}
+
+bool
+FrameBufferSnapshot::decode(QImage* image) const {
+  const int bpp = m_bytesPerPixel;
+  QByteArray pixels(TILE_SIZE * TILE_SIZE * bpp, Qt::Uninitialized);
+  auto* tile = reinterpret_cast<uchar*>(pixels.data());
+  auto* data = reinterpret_cast<const uchar*>(m_data.constData());
+  for (auto& t : m_tiles) {
+    const int rowBytes = t.width * bpp;
+    const uchar* source = data + t.offset;
+    if (!t.raw) {
+      if (!decodeTile(bpp, source, t.length, tile, t.width * t.height)) {
+        return false;
+      }
+      source = tile;
+    }
+    for (int row = 0; row < t.height; row++) {
+      std::memcpy(
+        image->scanLine(t.y + row) + t.x * bpp,
+        source + row * rowBytes,
+        rowBytes
+      );
+    }
+  }
+  return true;
+}
@@ -0,0 +1,65 @@
+#ifndef FRAMEBUFFERSNAPSHOT_H
+#define FRAMEBUFFERSNAPSHOT_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QVector>
+
+/*!
+ * \brief Compressed copy of the framebuffer kept while an application is
+ * paused
+ *
+ * The image is split into tiles that are each run length encoded over whole
+ * pixels. E-ink content is mostly white or flat, so most tiles shrink to a
+ * few bytes. Tiles are only decoded when the snapshot is restored.
+ */
+class FrameBufferSnapshot {
+public:
+  static constexpr int TILE_SIZE = 64;
+
+  FrameBufferSnapshot(const QImage& image);
+
+  bool isValid() const { return m_valid; }
+  /*!
+   * \brief Size of the image before compression in bytes
+   */
+  qsizetype size() const { return m_size; }
+  /*!
+   * \brief Size of the compressed tiles in bytes
+   */
+  qsizetype compressedSize() const { return m_data.size(); }
+  double compressionRatio() const;
+  /*!
+   * \brief Draw the snapshot into an image
+   *
+   * Tiles are decoded straight into the image when it has the same size and
+   * format as the snapshot, otherwise the snapshot is decoded and scaled to
+   * fit.
+   * \param image Image to draw into
+   * \return If the snapshot could be restored
+   */
+  bool restore(QImage* image) const;
+
+private:
+  struct Tile {
+    int x;
+    int y;
+    int width;
+    int height;
+    qsizetype offset;
+    qsizetype length;
+    bool raw;
+  };
+
+  bool m_valid;
+  QSize m_imageSize;
+  QImage::Format m_format;
+  int m_bytesPerPixel;
+  qsizetype m_size;
+  QVector<Tile> m_tiles;
+  QByteArray m_data;
+
+  bool decode(QImage* image) const;
+};
+
+#endif // FRAMEBUFFERSNAPSHOT_H
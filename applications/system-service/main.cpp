@@ -65,11 +65,11 @@ main(int argc, char* argv[]) {
     // TODO - attempt to start display server instance
     bool enabled = Oxide::debugEnabled();
     if (!enabled) {
-      qputenv("DEBUG", "1");
+      Oxide::setDebugEnabled(true);
     }
     O_WARNING("Display server not available. Running xochitl instead!");
     if (!enabled) {
-      qputenv("DEBUG", "0");
+      Oxide::setDebugEnabled(false);
     }
     return QProcess::execute("/usr/bin/xochitl", QStringList());
   }
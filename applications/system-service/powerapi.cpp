@@ -2,6 +2,12 @@
 
 #include <liboxide/udev.h>
 
+// The battery is read this often when nothing has notified. The rM2 fuel
+// gauge doesn't send a uevent for every capacity change, which matters most
+// while charging, when the level changes quickly.
+#define POWER_FALLBACK_INTERVAL (60 * 1000)
+#define POWER_CHARGING_FALLBACK_INTERVAL (15 * 1000)
+
 PowerAPI*
 PowerAPI::singleton(PowerAPI* self) {
   static PowerAPI* instance;
@@ -29,21 +35,31 @@ PowerAPI::PowerAPI(QObject* parent)
         update();
       });
       Oxide::Sentry::sentry_span(t, "monitor", "Setup monitor", [this] {
-        if (deviceSettings.getDeviceType() == Oxide::DeviceSettings::RM1) {
-          Oxide::UDev::singleton()->addMonitor("platform", NULL);
-          Oxide::UDev::singleton()->subsystem("power_supply", [this] {
-            QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
-          });
-        } else {
-          timer = new QTimer(this);
-          timer->setSingleShot(false);
-          timer->setInterval(3 * 1000); // 3 seconds
-          timer->moveToThread(qApp->thread());
-          connect(
-            timer, &QTimer::timeout, this, QOverload<>::of(&PowerAPI::update)
-          );
-          timer->start();
+        watcher = new Oxide::SysObjectWatcher(this);
+        for (Oxide::SysObject battery : *Oxide::Power::batteries()) {
+          for (auto name :
+               {"capacity", "status", "present", "health", "temp"}) {
+            watcher->watch(battery, name);
+          }
+        }
+        for (Oxide::SysObject charger : *Oxide::Power::chargers()) {
+          watcher->watch(charger, "online");
+        }
+        for (Oxide::SysObject usb : *Oxide::Power::usbs()) {
+          watcher->watch(usb, "uevent");
         }
+        // Chargers and batteries send uevents when they change, the usbphy
+        // devices are platform devices
+        watcher->watchSubsystem("power_supply");
+        watcher->watchSubsystem("platform");
+        connect(
+          watcher,
+          &Oxide::SysObjectWatcher::changed,
+          this,
+          QOverload<>::of(&PowerAPI::update)
+        );
+        // Picks the fallback interval for the current charging state
+        update();
       });
     }
   );
@@ -51,30 +67,18 @@ PowerAPI::PowerAPI(QObject* parent)
 
 void
 PowerAPI::shutdown() {
-  if (timer != nullptr) {
-    qDebug() << "Killing timer";
-    timer->stop();
-    delete timer;
-  } else {
-    qDebug() << "Killing UDev monitor";
-    Oxide::UDev::singleton()->stop();
+  if (watcher != nullptr) {
+    O_DEBUG("Stopping sysfs watcher");
+    watcher->setEnabled(false);
   }
+  O_DEBUG("Killing UDev monitor");
+  Oxide::UDev::singleton()->stop();
 }
 
 void
 PowerAPI::setEnabled(bool enabled) {
-  if (deviceSettings.getDeviceType() == Oxide::DeviceSettings::RM1) {
-    if (enabled) {
-      Oxide::UDev::singleton()->start();
-    } else {
-      Oxide::UDev::singleton()->stop();
-    }
-    return;
-  }
-  if (enabled) {
-    timer->start();
-  } else {
-    timer->stop();
+  if (watcher != nullptr) {
+    watcher->setEnabled(enabled);
   }
 }
 
@@ -237,4 +241,14 @@ void
 PowerAPI::update() {
   updateBattery();
   updateCharger();
+  if (watcher == nullptr) {
+    return;
+  }
+  int interval =
+    m_batteryState == BatteryCharging || m_chargerState == ChargerConnected
+      ? POWER_CHARGING_FALLBACK_INTERVAL
+      : POWER_FALLBACK_INTERVAL;
+  if (watcher->fallbackInterval() != interval) {
+    watcher->setFallbackInterval(interval);
+  }
 }
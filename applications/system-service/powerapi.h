@@ -8,7 +8,6 @@
 #include <QDir>
 #include <QException>
 #include <QObject>
-#include <QTimer>
 
 #include "apibase.h"
 
@@ -71,7 +70,7 @@ signals:
   void chargerWarning();
 
 private:
-  QTimer* timer = nullptr;
+  Oxide::SysObjectWatcher* watcher = nullptr;
   int m_state = Normal;
   int m_batteryState = BatteryUnknown;
   int m_batteryLevel = 0;
@@ -2,9 +2,76 @@
 
 #include <liboxide/oxideqml.h>
 
+#include <QCryptographicHash>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+
 #include "notificationapi.h"
 #include "systemapi.h"
 
+// Maps to zlib level 1. Screenshots are mostly flat areas that compress well
+// at any level, so the extra time spent on higher levels isn't worth it.
+#define SCREENSHOT_PNG_QUALITY 85
+#define SCREENSHOT_DIRECTORY "/home/root/screenshots"
+#define THUMBNAIL_DIRECTORY "/home/root/.cache/oxide/thumbnails"
+// Large enough to fill a grid cell on the widest supported screen
+#define THUMBNAIL_SIZE 512
+
+static bool
+encodeScreenshot(QImage image, bool landscape, const QString& filePath) {
+  // The panel is grayscale, so converting first loses nothing and leaves a
+  // third of the data to rotate and compress
+  image = image.convertToFormat(QImage::Format_Grayscale8);
+  if (landscape) {
+    image = image.transformed(QTransform().rotate(270.0));
+  }
+  // Written to a temporary file first so that a partial screenshot is never
+  // picked up from the screenshots directory
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    O_WARNING("Failed to open" << filePath << file.errorString());
+    return false;
+  }
+  QImageWriter writer(&file, "png");
+  writer.setQuality(SCREENSHOT_PNG_QUALITY);
+  if (!writer.write(image)) {
+    O_WARNING("Failed to encode screenshot" << writer.errorString());
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
+
+static bool
+generateThumbnail(const QString& filePath, const QString& thumbnailPath) {
+  QImageReader reader(filePath);
+  auto size = reader.size();
+  if (size.isValid()) {
+    reader.setScaledSize(
+      size.scaled(THUMBNAIL_SIZE, THUMBNAIL_SIZE, Qt::KeepAspectRatio)
+    );
+  }
+  auto image = reader.read();
+  if (image.isNull()) {
+    O_WARNING("Failed to read" << filePath << reader.errorString());
+    return false;
+  }
+  QSaveFile file(thumbnailPath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    O_WARNING("Failed to open" << thumbnailPath << file.errorString());
+    return false;
+  }
+  QImageWriter writer(&file, "png");
+  writer.setQuality(SCREENSHOT_PNG_QUALITY);
+  if (!writer.write(image.convertToFormat(QImage::Format_Grayscale8))) {
+    O_WARNING("Failed to encode thumbnail" << writer.errorString());
+    file.cancelWriting();
+    return false;
+  }
+  return file.commit();
+}
+
 QDBusObjectPath
 ScreenAPI::screenshot() {
   if (!hasPermission("screen")) {
@@ -13,7 +80,7 @@ ScreenAPI::screenshot() {
   O_INFO("Taking screenshot");
   auto filePath = getNextPath();
   O_DEBUG("Using path" << filePath);
-  auto notification = notificationAPI->add(
+  QPointer<Notification> notification = notificationAPI->add(
     QUuid::createUuid().toString(),
     "codes.eeems.tarnish",
     "codes.eeems.tarnish",
@@ -22,23 +89,52 @@ ScreenAPI::screenshot() {
   );
   notification->display();
   auto screen = getFrameBuffer();
-  QDBusObjectPath path("/");
-  bool saved = false;
   if (screen == nullptr || screen->size().isEmpty()) {
     O_WARNING("Could not get copy of screen");
+    finishScreenshot(filePath, false, notification);
+    return QDBusObjectPath("/");
+  }
+  // Only the copy happens here, everything else is done on the encode thread
+  // so that tarnish keeps handling DBus calls in the meantime
+  QImage snapshot = screen->copy();
+  bool landscape = systemAPI->landscape();
+  m_pendingPaths.insert(filePath);
+  QMetaObject::invokeMethod(
+    m_encoder,
+    [this, snapshot, landscape, filePath, notification] {
+      bool saved = encodeScreenshot(snapshot, landscape, filePath);
+      QMetaObject::invokeMethod(
+        this,
+        [this, filePath, saved, notification] {
+          finishScreenshot(filePath, saved, notification);
+        },
+        Qt::QueuedConnection
+      );
+    },
+    Qt::QueuedConnection
+  );
+  return QDBusObjectPath(getObjectPath(filePath));
+}
+
+void
+ScreenAPI::finishScreenshot(
+  const QString& filePath,
+  bool saved,
+  QPointer<Notification> notification
+) {
+  m_pendingPaths.remove(filePath);
+  QDBusObjectPath path(getObjectPath(filePath));
+  if (saved) {
+    addScreenshot(filePath);
   } else {
-    if (systemAPI->landscape()) {
-      saved = screen->transformed(QTransform().rotate(270.0)).save(filePath);
-    } else {
-      saved = screen->save(filePath);
-    }
-    if (saved) {
-      path = addScreenshot(filePath)->qPath();
-    } else if (!saved) {
-      O_WARNING("Failed to save screenshot");
-    }
+    O_WARNING("Failed to save screenshot");
+  }
+  if (m_enabled) {
+    emit screenshotFinished(path, saved);
+  }
+  if (notification != nullptr) {
+    notification->remove();
   }
-  notification->remove();
   notificationAPI
     ->add(
       QUuid::createUuid().toString(),
@@ -48,7 +144,6 @@ ScreenAPI::screenshot() {
       saved ? filePath : ""
     )
     ->display();
-  return path;
 }
 
 QDBusObjectPath
@@ -80,10 +175,7 @@ ScreenAPI::addScreenshot(QString filePath) {
     [this, filePath, &instance](Oxide::Sentry::Transaction* t) {
       Oxide::Sentry::sentry_span(
         t, "screenshot", "Create screenshot", [this, filePath, &instance] {
-          auto path =
-            QString(OXIDE_SERVICE_PATH "/screenshots/") +
-            QFileInfo(filePath).completeBaseName().remove('-').remove('.');
-          instance = new Screenshot(path, filePath, this);
+          instance = new Screenshot(getObjectPath(filePath), filePath, this);
           m_screenshots.append(instance);
         }
       );
@@ -97,6 +189,7 @@ ScreenAPI::addScreenshot(QString filePath) {
             delete instance;
           });
           connect(instance, &Screenshot::modified, [this, instance] {
+            updateThumbnail(instance);
             if (m_enabled) {
               emit screenshotModified(instance->qPath());
             }
@@ -107,11 +200,71 @@ ScreenAPI::addScreenshot(QString filePath) {
           }
         }
       );
+      Oxide::Sentry::sentry_span(
+        t, "thumbnail", "Queue thumbnail", [this, &instance] {
+          updateThumbnail(instance);
+        }
+      );
     }
   );
   return instance;
 }
 
+void
+ScreenAPI::updateThumbnail(Screenshot* instance) {
+  auto filePath = instance->filePath();
+  auto thumbnailPath = getThumbnailPath(filePath);
+  auto previous = instance->thumbnailPath();
+  if (previous == thumbnailPath) {
+    return;
+  }
+  if (!previous.isEmpty()) {
+    QFile::remove(previous);
+    instance->setThumbnailPath("");
+  }
+  if (QFile::exists(thumbnailPath)) {
+    instance->setThumbnailPath(thumbnailPath);
+    return;
+  }
+  QPointer<Screenshot> pointer(instance);
+  QMetaObject::invokeMethod(
+    m_encoder,
+    [this, filePath, thumbnailPath, pointer] {
+      if (!generateThumbnail(filePath, thumbnailPath)) {
+        return;
+      }
+      QMetaObject::invokeMethod(
+        this,
+        [thumbnailPath, pointer] {
+          if (pointer == nullptr) {
+            QFile::remove(thumbnailPath);
+            return;
+          }
+          pointer->setThumbnailPath(thumbnailPath);
+        },
+        Qt::QueuedConnection
+      );
+    },
+    Qt::QueuedConnection
+  );
+}
+
+void
+ScreenAPI::removeUnusedThumbnails() {
+  QSet<QString> used;
+  for (auto screenshot : m_screenshots) {
+    used.insert(getThumbnailPath(screenshot->filePath()));
+  }
+  QDir dir(THUMBNAIL_DIRECTORY);
+  dir.setNameFilters(QStringList() << "*.png");
+  for (auto& entry : dir.entryInfoList(QDir::Files)) {
+    if (!used.contains(entry.filePath())) {
+      O_DEBUG("Removing unused thumbnail" << entry.filePath());
+      QFile::remove(entry.filePath());
+    }
+  }
+}
+
 void
 ScreenAPI::mkdirs(const QString& path, mode_t mode) {
   QDir dir(path);
@@ -136,11 +289,30 @@ QString
 ScreenAPI::getNextPath() {
   QString filePath;
   do {
-    filePath = "/home/root/screenshots/" + getTimestamp() + ".png";
-  } while (QFile::exists(filePath));
+    filePath = SCREENSHOT_DIRECTORY "/" + getTimestamp() + ".png";
+  } while (QFile::exists(filePath) || m_pendingPaths.contains(filePath));
   return filePath;
 }
 
+QString
+ScreenAPI::getObjectPath(const QString& filePath) {
+  return QString(OXIDE_SERVICE_PATH "/screenshots/") +
+         QFileInfo(filePath).completeBaseName().remove('-').remove('.');
+}
+
+QString
+ScreenAPI::getThumbnailPath(const QString& filePath) {
+  // Keyed on the modification time as well so that a changed screenshot
+  // never gets a stale thumbnail
+  auto key = filePath.toUtf8() + ':' +
+             QByteArray::number(
+               QFileInfo(filePath).lastModified().toMSecsSinceEpoch()
+             );
+  return THUMBNAIL_DIRECTORY "/" +
+         QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex() +
+         ".png";
+}
+
 ScreenAPI*
 ScreenAPI::singleton(ScreenAPI* self) {
   static ScreenAPI* instance;
@@ -153,13 +325,26 @@ ScreenAPI::singleton(ScreenAPI* self) {
 ScreenAPI::ScreenAPI(QObject* parent)
   : APIBase(parent)
   , m_screenshots()
-  , m_enabled(false) {
+  , m_enabled(false)
+  , m_encodeThread()
+  , m_encoder(new QObject())
+  , m_pendingPaths() {
   Oxide::Sentry::sentry_transaction(
     "Screen API Init", "init", [this](Oxide::Sentry::Transaction* t) {
       qDBusRegisterMetaType<QList<double>>();
+      Oxide::Sentry::sentry_span(
+        t, "thread", "Start screenshot encode thread", [this] {
+          m_encodeThread.setObjectName("screenshot");
+          m_encoder->moveToThread(&m_encodeThread);
+          Oxide::startThreadWithPriority(
+            &m_encodeThread, QThread::LowPriority
+          );
+        }
+      );
       Oxide::Sentry::sentry_span(
         t, "mkdirs", "Create screenshots directory", [this] {
-          mkdirs("/home/root/screenshots/");
+          mkdirs(SCREENSHOT_DIRECTORY);
+          mkdirs(THUMBNAIL_DIRECTORY);
         }
       );
       Oxide::Sentry::sentry_span(t, "singleton", "Setup singleton", [this] {
@@ -167,17 +352,28 @@ ScreenAPI::ScreenAPI(QObject* parent)
       });
       Oxide::Sentry::sentry_span(
         t, "screenshots", "Load existing screenshots", [this] {
-          QDir dir("/home/root/screenshots/");
+          QDir dir(SCREENSHOT_DIRECTORY);
           dir.setNameFilters(QStringList() << "*.png");
           for (auto entry : dir.entryInfoList()) {
             addScreenshot(entry.filePath());
           }
         }
       );
+      Oxide::Sentry::sentry_span(
+        t, "thumbnails", "Remove unused thumbnails", [this] {
+          removeUnusedThumbnails();
+        }
+      );
     }
   );
 }
 
+ScreenAPI::~ScreenAPI() {
+  m_encodeThread.quit();
+  m_encodeThread.wait();
+  delete m_encoder;
+}
+
 void
 ScreenAPI::setEnabled(bool enabled) {
   m_enabled = enabled;
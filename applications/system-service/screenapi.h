@@ -14,6 +14,9 @@
 #include <QMutex>
 #include <QObject>
 #include <QPainter>
+#include <QPointer>
+#include <QSet>
+#include <QThread>
 
 #include "apibase.h"
 #include "screenshot.h"
@@ -26,6 +29,8 @@
 
 #define screenAPI ScreenAPI::singleton()
 
+class Notification;
+
 class ScreenAPI : public APIBase {
   Q_OBJECT
   Q_CLASSINFO("D-Bus Interface", OXIDE_SCREEN_INTERFACE)
@@ -35,6 +40,7 @@ class ScreenAPI : public APIBase {
 public:
   static ScreenAPI* singleton(ScreenAPI* self = nullptr);
   ScreenAPI(QObject* parent);
+  ~ScreenAPI();
   void setEnabled(bool enabled);
   bool enabled();
   QList<QDBusObjectPath> screenshots();
@@ -47,16 +53,29 @@ signals:
   void screenshotAdded(QDBusObjectPath);
   void screenshotRemoved(QDBusObjectPath);
   void screenshotModified(QDBusObjectPath);
+  void screenshotFinished(QDBusObjectPath path, bool success);
 
 private:
   QList<Screenshot*> m_screenshots;
   bool m_enabled;
   QMutex mutex;
+  QThread m_encodeThread;
+  QObject* m_encoder;
+  QSet<QString> m_pendingPaths;
 
   Screenshot* addScreenshot(QString filePath);
+  void updateThumbnail(Screenshot* instance);
+  void removeUnusedThumbnails();
+  void finishScreenshot(
+    const QString& filePath,
+    bool saved,
+    QPointer<Notification> notification
+  );
   void mkdirs(const QString& path, mode_t mode = 0700);
   QString getTimestamp();
   QString getNextPath();
+  QString getObjectPath(const QString& filePath);
+  QString getThumbnailPath(const QString& filePath);
 };
 
 #endif // SCREENSHOTAPI_H
@@ -1,15 +1,18 @@
 #include "screenshot.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "screenapi.h"
 
 Screenshot::Screenshot(QString path, QString filePath, QObject* parent)
   : QObject(parent)
   , m_path(path)
+  , m_thumbnail()
   , mutex() {
+  // Only opened when the blob is accessed, a few hundred screenshots would
+  // otherwise keep a few hundred fds open
   m_file = new QFile(filePath);
-  if (!m_file->open(QIODevice::ReadWrite)) {
-    O_WARNING("Unable to open screenshot file" << m_file->fileName());
-  }
 }
 
 Screenshot::~Screenshot() {
@@ -102,6 +105,55 @@ Screenshot::getPath() {
   return m_file->fileName();
 }
 
+QString
+Screenshot::filePath() {
+  return m_file->fileName();
+}
+
+QString
+Screenshot::thumbnailPath() {
+  QMutexLocker locker(&mutex);
+  return m_thumbnail;
+}
+
+void
+Screenshot::setThumbnailPath(const QString& thumbnailPath) {
+  mutex.lock();
+  if (m_thumbnail == thumbnailPath) {
+    mutex.unlock();
+    return;
+  }
+  m_thumbnail = thumbnailPath;
+  mutex.unlock();
+  emit thumbnailChanged();
+}
+
+QDBusUnixFileDescriptor
+Screenshot::thumbnail() {
+  if (!hasPermission("screen")) {
+    return QDBusUnixFileDescriptor();
+  }
+  auto thumbnail = thumbnailPath();
+  if (thumbnail.isEmpty()) {
+    if (calledFromDBus()) {
+      sendErrorReply(QDBusError::Failed, "Thumbnail is not ready");
+    }
+    return QDBusUnixFileDescriptor();
+  }
+  int fd = ::open(thumbnail.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    O_WARNING("Unable to open thumbnail" << thumbnail << strerror(errno));
+    if (calledFromDBus()) {
+      sendErrorReply(QDBusError::Failed, "Unable to open thumbnail");
+    }
+    return QDBusUnixFileDescriptor();
+  }
+  // The fd is duplicated when it is sent
+  QDBusUnixFileDescriptor result(fd);
+  ::close(fd);
+  return result;
+}
+
 void
 Screenshot::remove() {
   if (!hasPermission("screen")) {
@@ -116,6 +168,10 @@ Screenshot::remove() {
   if (m_file->isOpen()) {
     m_file->close();
   }
+  if (!m_thumbnail.isEmpty()) {
+    QFile::remove(m_thumbnail);
+    m_thumbnail.clear();
+  }
   mutex.unlock();
   O_INFO("Removed screenshot" << path());
   emit removed();
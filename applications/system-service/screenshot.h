@@ -11,7 +11,9 @@
 // Must be included so that generate_xml.sh will work
 #include "../../shared/liboxide/meta.h"
 
-class Screenshot : public QObject {
+class Screenshot
+  : public QObject
+  , protected QDBusContext {
   Q_OBJECT
   Q_CLASSINFO("Version", OXIDE_INTERFACE_VERSION)
   Q_CLASSINFO("D-Bus Interface", OXIDE_SCREENSHOT_INTERFACE)
@@ -28,17 +30,23 @@ public:
   QByteArray blob();
   void setBlob(QByteArray blob);
   QString getPath();
+  QString filePath();
+  QString thumbnailPath();
+  void setThumbnailPath(const QString& thumbnailPath);
 
 signals:
   void modified();
   void removed();
+  void thumbnailChanged();
 
 public slots:
   void remove();
+  QDBusUnixFileDescriptor thumbnail();
 
 private:
   QString m_path;
   QFile* m_file;
+  QString m_thumbnail;
   QMutex mutex;
 
   bool
@@ -15,6 +15,7 @@ SOURCES += \
     bss.cpp \
     dbusservice.cpp \
     eventlistener.cpp \
+    framebuffersnapshot.cpp \
     frontlightapi.cpp \
     network.cpp \
     notification.cpp \
@@ -77,6 +78,7 @@ HEADERS += \
     csl_light.h \
     dbusservice.h \
     eventlistener.h \
+    framebuffersnapshot.h \
     frontlightapi.h \
     network.h \
     notification.h \
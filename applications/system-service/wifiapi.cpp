@@ -1,5 +1,13 @@
 #include "wifiapi.h"
 
+#include <algorithm>
+
+// Signal strength and internet access are polled while associated with a
+// network. The poll starts fast after a change and slows down while nothing
+// changes.
+#define WIFI_POLL_MIN_INTERVAL (3 * 1000)
+#define WIFI_POLL_MAX_INTERVAL (60 * 1000)
+
 WifiAPI*
 WifiAPI::singleton(WifiAPI* self) {
   static WifiAPI* instance;
@@ -17,7 +25,8 @@ WifiAPI::WifiAPI(QObject* parent)
   , m_state(Unknown)
   , m_currentNetwork("/")
   , m_link(0)
-  , m_scanning(false) {
+  , m_scanning(false)
+  , m_updating(true) {
   Oxide::Sentry::sentry_transaction(
     "Wifi API Init", "init", [this](Oxide::Sentry::Transaction* t) {
       Oxide::Sentry::sentry_span(t, "singleton", "Setup singleton", [this] {
@@ -227,12 +236,36 @@ WifiAPI::WifiAPI(QObject* parent)
           Oxide::Sentry::sentry_span(s, "timer", "Setup timer", [this] {
             timer = new QTimer(this);
             timer->setSingleShot(false);
-            timer->setInterval(3 * 1000); // 3 seconds
+            timer->setInterval(WIFI_POLL_MIN_INTERVAL);
             timer->moveToThread(qApp->thread());
             connect(
               timer, &QTimer::timeout, this, QOverload<>::of(&WifiAPI::update)
             );
           });
+          Oxide::Sentry::sentry_span(s, "monitor", "Setup monitor", [this] {
+            watcher = new Oxide::SysObjectWatcher(this);
+            for (auto wlan : wlans) {
+              for (auto name : {"flags", "operstate", "carrier"}) {
+                watcher->watch(*wlan, name);
+              }
+            }
+            watcher->watchSubsystem("net");
+            // operstate and carrier changes are only announced over
+            // rtnetlink
+            watcher->watchLinks();
+            connect(
+              watcher,
+              &Oxide::SysObjectWatcher::changed,
+              this,
+              QOverload<>::of(&WifiAPI::update)
+            );
+            connect(
+              &xochitlSettings,
+              &Oxide::XochitlSettings::wifionChanged,
+              this,
+              [this] { update(); }
+            );
+          });
           Oxide::Sentry::sentry_span(
             s, "networks", "Load networks from disk", [this] { loadNetworks(); }
           );
@@ -254,9 +287,6 @@ WifiAPI::WifiAPI(QObject* parent)
               setEnabled(m_enabled);
             }
           );
-          Oxide::Sentry::sentry_span(s, "timer", "Start timer", [this] {
-            timer->start();
-          });
         }
       );
     }
@@ -276,6 +306,7 @@ WifiAPI::shutdown() {
   O_DEBUG("Killing timer");
   timer->stop();
   timer->deleteLater();
+  watcher->setEnabled(false);
 }
 
 void
@@ -813,7 +844,9 @@ WifiAPI::NetworkSelected(Wlan* wlan, const QDBusObjectPath& path) {
 void
 WifiAPI::InterfacePropertiesChanged(Wlan* wlan, const QVariantMap& properties) {
   Q_UNUSED(wlan);
-  Q_UNUSED(properties);
+  if (m_updating && properties.contains("State")) {
+    update();
+  }
 }
 
 void
@@ -831,12 +864,16 @@ WifiAPI::BSSPropertiesChanged(const QVariantMap& properties) {
 
 void
 WifiAPI::stopUpdating() {
+  m_updating = false;
   timer->stop();
+  watcher->setEnabled(false);
 }
 
 void
 WifiAPI::resumeUpdating() {
-  timer->start();
+  m_updating = true;
+  watcher->setEnabled(true);
+  update();
 }
 
 void
@@ -982,7 +1019,8 @@ WifiAPI::update() {
     m_currentNetwork.setPath("/");
     emit disconnected();
   }
-  if (m_state != state) {
+  bool changed = m_state != state;
+  if (changed) {
     setState(state);
   }
   auto clink = link();
@@ -995,6 +1033,20 @@ WifiAPI::update() {
     m_rssi = crssi;
     emit rssiChanged(crssi);
   }
+  // Nothing notifies when the signal strength or internet access changes, so
+  // those are only polled while associated with a network. The poll backs
+  // off until the state changes again, the signal strength jitters too much
+  // to count as a change.
+  if (m_updating && (state == Online || state == Offline)) {
+    int interval = changed
+                     ? WIFI_POLL_MIN_INTERVAL
+                     : std::min(timer->interval() * 2, WIFI_POLL_MAX_INTERVAL);
+    if (!timer->isActive() || timer->interval() != interval) {
+      timer->start(interval);
+    }
+  } else if (timer->isActive()) {
+    timer->stop();
+  }
 }
 
 WifiAPI::State
@@ -117,7 +117,9 @@ private:
   int m_rssi;
   QList<BSS*> bsss;
   bool m_scanning;
+  bool m_updating;
   Wpa_Supplicant* supplicant;
+  Oxide::SysObjectWatcher* watcher;
 
   QList<Interface*> interfaces();
 
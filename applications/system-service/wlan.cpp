@@ -1,5 +1,7 @@
 #include "wlan.h"
 
+#include <net/if.h>
+
 #include "bss.h"
 #include "wifiapi.h"
 
@@ -112,10 +114,12 @@ Wlan::down() {
 
 bool
 Wlan::isUp() {
-  return !system(("/sbin/ip addr show " + iface() +
-                  " 2>&1 | /bin/grep UP > /dev/null")
-                   .toStdString()
-                   .c_str());
+  // Same flag that ip addr reports as UP, without forking a shell
+  try {
+    return std::stoul(strProperty("flags"), nullptr, 16) & IFF_UP;
+  } catch (const std::logic_error&) {
+    return false;
+  }
 }
 
 Interface*
@@ -83,8 +83,8 @@ public:
       this,
       &Controller::registerApplication
     );
-    connect(appsApi, &Apps::applicationLaunched, this, &Controller::reload);
-    connect(appsApi, &Apps::applicationExited, this, &Controller::reload);
+    // Covers launches and exits, and is only sent once for a burst of them
+    connect(appsApi, &Apps::applicationsChanged, this, &Controller::reload);
   }
   ~Controller() {}
 
@@ -115,41 +115,40 @@ public:
     }
   }
   Q_INVOKABLE QList<QObject*> getApps() {
-    auto bus = QDBusConnection::systemBus();
-    auto running = appsApi->runningApplications();
-    auto paused = appsApi->pausedApplications();
-    for (auto key : paused.keys()) {
-      if (running.contains(key)) {
-        continue;
-      }
-      running.insert(key, paused[key]);
+    // Everything comes from a single call, instead of a round-trip for each
+    // property of each application
+    QDBusPendingReply<QVariantMap> reply = appsApi->applicationSnapshot();
+    reply.waitForFinished();
+    if (reply.isError()) {
+      qDebug() << "Failed to get applications:" << reply.error().message();
+      return applications;
     }
-    auto runningApplications = appsApi->runningApplications().values();
-    runningApplications.append(appsApi->pausedApplications().values());
-    for (auto item : runningApplications) {
-      auto path = item.value<QDBusObjectPath>().path();
-      Application app(OXIDE_SERVICE, path, bus, this);
-      if (app.hidden()) {
+    auto snapshot = reply.value();
+    auto entries = qdbus_cast<QVariantMap>(snapshot["applications"]);
+    for (auto item : entries) {
+      auto app = qdbus_cast<QVariantMap>(item);
+      // Only running and paused applications are shown, Inactive is 0
+      if (app["hidden"].toBool() || !app["state"].toInt()) {
         continue;
       }
-      auto name = app.name();
+      auto name = app["name"].toString();
       auto appItem = getApplication(name);
       if (appItem == nullptr) {
         qDebug() << name;
         appItem = new AppItem(this);
         applications.append(appItem);
       }
-      auto displayName = app.displayName();
+      auto displayName = app["displayName"].toString();
       if (displayName.isEmpty()) {
         displayName = name;
       }
-      appItem->setProperty("path", path);
+      appItem->setProperty("path", app["path"].toString());
       appItem->setProperty("name", name);
       appItem->setProperty("displayName", displayName);
-      appItem->setProperty("desc", app.description());
-      appItem->setProperty("call", app.bin());
-      appItem->setProperty("running", running.contains(name));
-      auto icon = app.icon();
+      appItem->setProperty("desc", app["description"].toString());
+      appItem->setProperty("call", app["bin"].toString());
+      appItem->setProperty("running", true);
+      auto icon = app["icon"].toString();
       if (!icon.isEmpty() && QFile(icon).exists()) {
         appItem->setProperty("imgFile", "file:" + icon);
       }
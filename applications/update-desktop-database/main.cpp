@@ -69,24 +69,31 @@ main(int argc, char* argv[]) {
   }
   Apps apps(OXIDE_SERVICE, path.path(), bus);
   LOG("Loading applications from disk");
-  QDir dir(OXIDE_APPLICATION_REGISTRATIONS_DIRECTORY);
-  dir.setNameFilters(QStringList() << "*.oxide");
-  for (auto entry : dir.entryInfoList()) {
-    auto path = entry.filePath();
-    auto reg = getRegistration(path);
-    auto name = entry.completeBaseName();
-    auto errors = validateRegistration(name, reg);
-    bool cache = true;
-    for (auto error : errors) {
+  // Shares the registration cache with tarnish, so only files that have
+  // changed since either last loaded them are parsed again
+  for (auto& registration : getRegistrations()) {
+    bool cache = !registration.properties.isEmpty();
+    for (auto error : registration.errors) {
       if (
         error.level == ErrorLevel::Error || error.level == ErrorLevel::Critical
       ) {
-        LOG_VERBOSE("  " << path.toStdString().c_str() << ": " << error);
+        LOG_VERBOSE(
+          "  " << registration.path.toStdString().c_str() << ": " << error
+        );
         cache = false;
       }
     }
-    if (cache && !addToTarnishCache(name, reg)) {
-      LOG("  " << path << ": Failed to cache")
+    if (!cache) {
+      continue;
+    }
+    // Registrations with warnings are not cached either
+    if (!registration.errors.isEmpty()) {
+      LOG("  " << registration.path << ": Failed to cache")
+      continue;
+    }
+    path = apps.registerApplication(registration.properties);
+    if (path.path() == "/") {
+      LOG("  " << registration.path << ": Failed to cache")
     }
   }
   LOG_VERBOSE("Finished reloading applications");
@@ -120,7 +120,7 @@ main(int argc, char* argv[]) {
   parser.process(app);
   auto verbose = parser.isSet(verboseOption);
   if (verbose) {
-    qputenv("DEBUG", "1");
+    Oxide::setDebugEnabled(true);
   }
 #ifdef EPAPER
   auto connected = Blight::connect(true);
@@ -5,6 +5,7 @@
 #include <sys/prctl.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <mutex>
@@ -14,6 +15,7 @@
 #include "debug.h"
 #include "libblight.h"
 #include "socket.h"
+#include "trace.h"
 
 using namespace std::chrono_literals;
 
@@ -77,6 +79,7 @@ namespace Blight {
 
   Connection::Connection(int fd)
     : m_fd(fcntl(fd, F_DUPFD_CLOEXEC, 3))
+    , m_reader(m_fd)
     , stop_requested(false)
     , thread(run, this) {
     int flags = fcntl(m_fd, F_GETFD, NULL);
@@ -134,7 +137,7 @@ namespace Blight {
   }
 
   message_ptr_t Connection::read() {
-    return message_t::from_socket(m_fd);
+    return message_t::from_reader(m_reader, 250);
   }
 
   maybe_ackid_ptr_t Connection::send(
@@ -143,61 +146,62 @@ namespace Blight {
     size_t size,
     unsigned int __ackid
   ) {
-    _DEBUG("[Blight::Connection::send(%d, [data], %d)", type, size);
-    auto _ackid = __ackid ? __ackid : ++ackid;
-    auto ack = ackid_ptr_t(new ackid_t(_ackid));
+    bool track;
     switch (type) {
       case MessageType::Repaint:
+      case MessageType::RepaintRegion:
       case MessageType::Move:
+      case MessageType::InkOverlay:
       case MessageType::Raise:
       case MessageType::Lower:
       case MessageType::Focus:
       case MessageType::Ack:
-#ifdef ACK_DEBUG
-        _DEBUG("No ack enqueue needed: %u", _ackid);
-#endif
+        track = false;
         break;
       default:
-        // Adding acks to queue to make sure it's there by the time a
-        // response comes back from the server
-        acks.enqueue(ack);
+        track = true;
+    }
+    return sendMessage(type, data, size, __ackid, track);
+  }
+
+  maybe_ackid_ptr_t Connection::sendMessage(
+    MessageType type,
+    data_t data,
+    size_t size,
+    unsigned int __ackid,
+    bool track
+  ) {
+    _DEBUG("[Blight::Connection::send(%d, [data], %d)", type, size);
+    auto _ackid = __ackid ? __ackid : ++ackid;
+    auto ack = ackid_ptr_t(new ackid_t(_ackid));
+    if (track) {
+      // Adding acks to queue to make sure it's there by the time a
+      // response comes back from the server
+      acks.enqueue(ack);
 #ifdef ACK_DEBUG
-        _DEBUG("Ack enqueued: %u", _ackid);
+      _DEBUG("Ack enqueued: %u", _ackid);
 #endif
-        break;
     }
+#ifdef ACK_DEBUG
+    else {
+      _DEBUG("No ack enqueue needed: %u", _ackid);
+    }
+#endif
     header_t header{
       {.type = type, .ackid = _ackid, .size = size}
     };
     [[maybe_unused]] std::lock_guard locker(mutex);
     (void)locker;
-    if (!Blight::send_blocking(
-          m_fd, reinterpret_cast<data_t>(&header), sizeof(header_t)
-        )) {
-      _WARN(
-        "Failed to write connection message header: %s", std::strerror(errno)
-      );
-      return {};
-    }
-    if (size && !Blight::send_blocking(m_fd, data, size)) {
-      _WARN(
-        "Failed to write connection message data: %s", std::strerror(errno)
-      );
+    if (!Blight::send_blocking(m_fd, header, data)) {
+      _WARN("Failed to write connection message: %s", std::strerror(errno));
       return {};
     }
 #ifdef ACK_DEBUG
     _DEBUG("Sent: %u %d", _ackid, type);
 #endif
-    switch (type) {
-      case MessageType::Repaint:
-      case MessageType::Move:
-      case MessageType::Raise:
-      case MessageType::Lower:
-      case MessageType::Focus:
-      case MessageType::Ack:
-        // Clear the ackid so that it will not block on wait
-        ack->ackid = 0;
-        break;
+    if (!track) {
+      // Clear the ackid so that it will not block on wait
+      ack->ackid = 0;
     }
     return ack;
   }
@@ -219,6 +223,20 @@ namespace Blight {
   }
 
   void Connection::waitForMarker(unsigned int marker) {
+    ackid_ptr_t pending;
+    {
+      std::lock_guard lock(markersMutex);
+      for (auto& [_marker, ack] : markers) {
+        if (_marker == marker) {
+          pending = ack;
+        }
+      }
+    }
+    if (pending != nullptr) {
+      // Resolved once the display server has drawn the repaint, the Wait
+      // below then only needs to wait for the screen to finish updating
+      pending->wait();
+    }
     auto maybe = send(
       MessageType::Wait, reinterpret_cast<data_t>(&marker), sizeof(marker)
     );
@@ -227,6 +245,33 @@ namespace Blight {
     }
   }
 
+  bool Connection::hasMarker(unsigned int marker) {
+    std::lock_guard lock(markersMutex);
+    return std::any_of(markers.begin(), markers.end(), [marker](auto& item) {
+      return item.first == marker;
+    });
+  }
+
+  void Connection::trackMarker(unsigned int marker, maybe_ackid_ptr_t ack) {
+    if (!marker || !ack.has_value()) {
+      return;
+    }
+    std::lock_guard lock(markersMutex);
+    auto iter =
+      std::find_if(markers.begin(), markers.end(), [marker](auto& item) {
+        return item.first == marker;
+      });
+    if (iter != markers.end()) {
+      markers.erase(iter);
+    }
+    markers.emplace_back(marker, ack.value());
+    // Similar to the kernel driver, only a limited number of markers are
+    // remembered
+    while (markers.size() > 64) {
+      markers.pop_front();
+    }
+  }
+
   maybe_ackid_ptr_t Connection::repaint(
     surface_id_t identifier,
     int x,
@@ -255,10 +300,62 @@ namespace Blight {
        .identifier = identifier,
        }
     };
-    auto ackid = send(MessageType::Repaint, (data_t)&repaint, sizeof(repaint));
+    Trace::mark(Trace::RepaintSend);
+    // The display server acks repaints once they are drawn, only wait for
+    // that when there is a marker that can be waited on later
+    auto ackid = sendMessage(
+      MessageType::Repaint, (data_t)&repaint, sizeof(repaint), 0, marker != 0
+    );
     if (!ackid.has_value()) {
       return {};
     }
+    trackMarker(marker, ackid);
+    return ackid;
+  }
+
+  maybe_ackid_ptr_t Connection::repaint(
+    surface_id_t identifier,
+    const std::vector<rect_t>& rects,
+    WaveformMode waveform,
+    ContentType contentType,
+    UpdateMode mode,
+    unsigned int marker
+  ) {
+    if (!identifier || rects.empty()) {
+      errno = EINVAL;
+      return {};
+    }
+    if (rects.size() == 1) {
+      auto& rect = rects.front();
+      return repaint(
+        identifier,
+        rect.x,
+        rect.y,
+        rect.width,
+        rect.height,
+        waveform,
+        contentType,
+        mode,
+        marker
+      );
+    }
+    BlightProtocol::blight_packet_repaint_region_t repaint{
+      .waveform = waveform,
+      .contenttype = contentType,
+      .mode = mode,
+      .marker = marker,
+      .identifier = identifier,
+      .count = (uint32_t)rects.size(),
+    };
+    const size_t rectsSize = rects.size() * sizeof(rect_t);
+    std::vector<unsigned char> data(sizeof(repaint) + rectsSize);
+    memcpy(data.data(), &repaint, sizeof(repaint));
+    memcpy(data.data() + sizeof(repaint), rects.data(), rectsSize);
+    Trace::mark(Trace::RepaintSend);
+    auto ackid = sendMessage(
+      MessageType::RepaintRegion, data.data(), data.size(), 0, marker != 0
+    );
+    trackMarker(marker, ackid);
     return ackid;
   }
 
@@ -348,6 +445,40 @@ namespace Blight {
     return send(MessageType::Move, (data_t)&move, sizeof(move));
   }
 
+  maybe_ackid_ptr_t Connection::inkOverlay(
+    surface_id_t identifier,
+    bool enabled,
+    unsigned int width,
+    unsigned int prediction
+  ) {
+    if (!identifier) {
+      errno = EINVAL;
+      return {};
+    }
+    ink_overlay_t overlay{
+      {
+       .identifier = identifier,
+       .enabled = enabled ? 1 : 0,
+       .width = width,
+       .prediction = prediction,
+       }
+    };
+    return send(MessageType::InkOverlay, (data_t)&overlay, sizeof(overlay));
+  }
+
+  maybe_ackid_ptr_t Connection::inkOverlay(
+    shared_buf_t buf,
+    bool enabled,
+    unsigned int width,
+    unsigned int prediction
+  ) {
+    if (buf == nullptr) {
+      errno = EINVAL;
+      return {};
+    }
+    return inkOverlay(buf->surface, enabled, width, prediction);
+  }
+
   std::optional<shared_buf_t> Connection::getBuffer(surface_id_t identifier) {
     if (!identifier) {
       _WARN(
@@ -511,6 +642,9 @@ namespace Blight {
     running = true;
     _INFO("Starting");
     std::vector<std::shared_ptr<message_t>> completed;
+    // Number of completed messages that were not being waited on in the last
+    // pass, these are always at the start of completed
+    size_t unmatched = 0;
     std::map<unsigned int, ackid_ptr_t> waiting;
     int error = 0;
     while (!connection->stop_requested) {
@@ -550,12 +684,20 @@ namespace Blight {
         _DEBUG("Resolving %u waiting acks", completed.size());
 #endif
         auto iter = completed.begin();
+        size_t index = 0;
         while (iter != completed.end()) {
           auto message = *iter;
           auto ackid = message->header.ackid;
-
+          bool stale = index++ < unmatched;
           if (!waiting.contains(ackid)) {
-            ++iter;
+            if (stale) {
+              // Acks are queued before their message is sent, so nothing
+              // will wait on this reply, like the ack for an untracked
+              // repaint
+              iter = completed.erase(iter);
+            } else {
+              ++iter;
+            }
             continue;
           }
           ackid_ptr_t& ack = waiting[ackid];
@@ -571,6 +713,7 @@ namespace Blight {
           _DEBUG("Ack handled: %u", ackid);
 #endif
         }
+        unmatched = completed.size();
       }
       auto message = connection->read();
       if (message == nullptr || message->header.type == MessageType::Invalid) {
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <map>
 #include <thread>
@@ -124,9 +125,23 @@ namespace Blight {
     std::optional<std::chrono::duration<double>> ping(int timeout = 0);
     /*!
      * \brief Wait for a marker to complete repainting on the display server
+     *
+     * If a repaint with this marker was sent on this connection, this will
+     * first wait for the display server to finish drawing it, so other
+     * pending repaints don't need to complete. Once drawn, the display
+     * driver can only wait for every update sent to the screen, so this
+     * may also wait for updates other clients sent after this marker.
      * \param marker Maker to wait on
      */
     void waitForMarker(unsigned int marker);
+    /*!
+     * \brief Check if a repaint with a marker was sent on this connection
+     *
+     * Only the most recently sent markers are remembered.
+     * \param marker Marker to check
+     * \return If the marker is known
+     */
+    bool hasMarker(unsigned int marker);
     /*!
      * \brief Repaint a portion of a surface
      * \param identifier Surface identifier
@@ -204,6 +219,42 @@ namespace Blight {
         marker
       );
     }
+    /*!
+     * \brief Repaint multiple areas of a surface as a single update
+     * \param identifier Surface identifier
+     * \param rects Areas on the surface to repaint
+     * \param waveform Waveform to use
+     * \param contentType Content type hint
+     * \param marker Marker
+     * \return ack_ptr_t if there was no error
+     */
+    maybe_ackid_ptr_t repaint(
+      surface_id_t identifier,
+      const std::vector<rect_t>& rects,
+      WaveformMode waveform = WaveformMode::UI,
+      ContentType contentType = ContentType::Color,
+      UpdateMode mode = UpdateMode::PartialUpdate,
+      unsigned int marker = 0
+    );
+    /*!
+     * \brief Repaint multiple areas of a surface as a single update
+     * \param buf Buffer representing surface
+     * \param rects Areas on the surface to repaint
+     * \param waveform Waveform to use
+     * \param contentType Content type hint
+     * \param marker Marker
+     * \return ack_ptr_t if there was no error
+     */
+    inline maybe_ackid_ptr_t repaint(
+      shared_buf_t buf,
+      const std::vector<rect_t>& rects,
+      WaveformMode waveform = WaveformMode::UI,
+      ContentType contentType = ContentType::Color,
+      UpdateMode mode = UpdateMode::PartialUpdate,
+      unsigned int marker = 0
+    ) {
+      return repaint(buf->surface, rects, waveform, contentType, mode, marker);
+    }
     /*!
      * \brief Move a surface
      * \param buf Buffer representing surface
@@ -219,6 +270,40 @@ namespace Blight {
      * \return ack_ptr_t if there was no error
      */
     maybe_ackid_ptr_t move(surface_id_t identifier, int x, int y);
+    /*!
+     * \brief Enable or disable the ink overlay for a surface
+     *
+     * While enabled the display server draws provisional ink under the pen
+     * straight from the input device, without waiting for the surface to be
+     * repainted. It is replaced as the surface repaints the area it covers.
+     * \param identifier Surface identifier
+     * \param enabled If the overlay should be enabled
+     * \param width Width of the provisional ink in pixels
+     * \param prediction How far ahead of the pen to extend the stroke in
+     * milliseconds, 0 disables prediction
+     * \return ack_ptr_t if there was no error
+     */
+    maybe_ackid_ptr_t inkOverlay(
+      surface_id_t identifier,
+      bool enabled,
+      unsigned int width = 2,
+      unsigned int prediction = 0
+    );
+    /*!
+     * \brief Enable or disable the ink overlay for a surface
+     * \param buf Buffer representing surface
+     * \param enabled If the overlay should be enabled
+     * \param width Width of the provisional ink in pixels
+     * \param prediction How far ahead of the pen to extend the stroke in
+     * milliseconds, 0 disables prediction
+     * \return ack_ptr_t if there was no error
+     */
+    maybe_ackid_ptr_t inkOverlay(
+      shared_buf_t buf,
+      bool enabled,
+      unsigned int width = 2,
+      unsigned int prediction = 0
+    );
     /*!
      * \brief Resize a surface
      * \param buf Buffer representing surface
@@ -295,12 +380,23 @@ namespace Blight {
 
   private:
     int m_fd;
+    BlightProtocol::MessageReader m_reader;
     std::map<unsigned short, std::shared_ptr<input_buffer_t>> m_inputBuffers;
     std::atomic<bool> stop_requested;
     std::vector<std::function<void(int)>> disconnectCallbacks;
     std::vector<std::function<void(surface_id_t)>> surfaceDeletedCallbacks;
     std::thread thread;
     std::mutex mutex;
+    std::mutex markersMutex;
+    std::deque<std::pair<unsigned int, ackid_ptr_t>> markers;
+    maybe_ackid_ptr_t sendMessage(
+      MessageType type,
+      data_t data,
+      size_t size,
+      unsigned int __ackid,
+      bool track
+    );
+    void trackMarker(unsigned int marker, maybe_ackid_ptr_t ack);
     static void run(Connection* connection);
   };
 } // namespace Blight
@@ -1,39 +1,368 @@
 #include "debug.h"
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <linux/futex.h>
+#include <mutex>
+#include <new>
+#include <pthread.h>
+#include <strings.h>
+#include <sys/syscall.h>
+#include <thread>
+
+// Records are formatted by the logging thread, so anything longer than this
+// is truncated
+#define LOG_MESSAGE_SIZE 448
+// Must be a power of 2
+#define LOG_RING_SIZE 64
+// Size of the buffer the writer thread collects output in before writing it
+#define LOG_WRITE_BUFFER_SIZE 16384
 
+std::atomic<int> __blight_debug_level{blight_debug_level_from_environment()};
 std::mutex __log_mutex;
-static int BLIGHT_DEBUG_LOGGING = LOG_WARNING;
+
+namespace {
+  struct LogRecord {
+    int priority;
+    unsigned int line;
+    pid_t tid;
+    const char* file;
+    const char* func;
+    char thread[16];
+    char message[LOG_MESSAGE_SIZE];
+  };
+  // Single producer, single consumer ring. The producer is whichever thread
+  // currently owns it, and the consumer is whoever holds drainMutex.
+  struct LogRing {
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<bool> owned{true};
+    // Never changes once the ring has been published
+    LogRing* next = nullptr;
+    LogRecord records[LOG_RING_SIZE];
+  };
+  struct RingOwner {
+    LogRing* ring = nullptr;
+    pid_t tid = 0;
+    char thread[16] = {0};
+    ~RingOwner() {
+      // Rings are never freed, so that the writer never has to synchronise
+      // with threads exiting. Another thread will pick this one up instead.
+      if (ring != nullptr) {
+        ring->owned.store(false, std::memory_order_release);
+      }
+    }
+  };
+
+  std::atomic<LogRing*> rings{nullptr};
+  // Futex the writer thread sleeps on, set to 1 when there is work for it
+  std::atomic<uint32_t> pending{0};
+  // 0 not started, 1 running, -1 failed to start
+  std::atomic<int> writerState{0};
+  std::atomic<size_t> totalDropped{0};
+  std::mutex drainMutex;
+  thread_local RingOwner owner;
+
+  const char* levelName(int priority) {
+    switch (priority) {
+      case LOG_INFO:
+        return "Info";
+      case LOG_WARNING:
+        return "Warning";
+      case LOG_CRIT:
+        return "Critical";
+      default:
+        return "Debug";
+    }
+  }
+
+  const char* selfPath() {
+    static char* path = realpath("/proc/self/exe", nullptr);
+    return path == nullptr ? "(unknown)" : path;
+  }
+
+  void writeAll(const char* data, size_t size) {
+    while (size > 0) {
+      auto res = ::write(STDERR_FILENO, data, size);
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      data += res;
+      size -= res;
+    }
+  }
+
+  class WriteBuffer {
+  public:
+    ~WriteBuffer() { flush(); }
+    void append(const LogRecord& record) {
+      if (size > LOG_WRITE_BUFFER_SIZE - LOG_MESSAGE_SIZE - 1024) {
+        flush();
+      }
+      auto res = snprintf(
+        data + size,
+        LOG_WRITE_BUFFER_SIZE - size,
+        "[%i:%i:%i %s - %s] %s: %s (%s:%u, %s)\n",
+        getpgrp(),
+        getpid(),
+        record.tid,
+        selfPath(),
+        record.thread,
+        levelName(record.priority),
+        record.message,
+        record.file,
+        record.line,
+        record.func
+      );
+      if (res < 0) {
+        return;
+      }
+      // A very long function name can still overflow what is left, the
+      // output is cut short in that case
+      if ((size_t)res >= LOG_WRITE_BUFFER_SIZE - size) {
+        size = LOG_WRITE_BUFFER_SIZE - 1;
+        data[size - 1] = '\n';
+        flush();
+        return;
+      }
+      size += res;
+    }
+    void dropped(uint32_t count) {
+      LogRecord record{
+        .priority = LOG_WARNING,
+        .line = __LINE__,
+        .tid = gettid(),
+        .file = __FILE__,
+        .func = __PRETTY_FUNCTION__,
+        .thread = "log",
+        .message = {0},
+      };
+      snprintf(
+        record.message,
+        sizeof(record.message),
+        "%u log messages dropped, the ring was full",
+        count
+      );
+      append(record);
+    }
+    void flush() {
+      if (size > 0) {
+        writeAll(data, size);
+        size = 0;
+      }
+    }
+
+  private:
+    char data[LOG_WRITE_BUFFER_SIZE];
+    size_t size = 0;
+  };
+
+  // Must be called with drainMutex held
+  bool drain(WriteBuffer& buffer) {
+    bool any = false;
+    for (
+      auto ring = rings.load(std::memory_order_acquire); ring != nullptr;
+      ring = ring->next
+    ) {
+      auto t = ring->tail.load(std::memory_order_relaxed);
+      auto h = ring->head.load(std::memory_order_acquire);
+      for (; t != h; t++) {
+        buffer.append(ring->records[t & (LOG_RING_SIZE - 1)]);
+        any = true;
+      }
+      ring->tail.store(t, std::memory_order_release);
+      auto dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+      if (dropped) {
+        buffer.dropped(dropped);
+        any = true;
+      }
+    }
+    return any;
+  }
+
+  void wake() {
+    syscall(
+      SYS_futex,
+      reinterpret_cast<uint32_t*>(&pending),
+      FUTEX_WAKE_PRIVATE,
+      1,
+      nullptr,
+      nullptr,
+      0
+    );
+  }
+
+  void writerMain() {
+    prctl(PR_SET_NAME, "blight-log");
+    WriteBuffer buffer;
+    while (true) {
+      pending.store(0, std::memory_order_seq_cst);
+      {
+        std::lock_guard lock(drainMutex);
+        drain(buffer);
+        buffer.flush();
+      }
+      // Anything published after the drain started will have set pending
+      if (pending.load(std::memory_order_seq_cst) == 0) {
+        syscall(
+          SYS_futex,
+          reinterpret_cast<uint32_t*>(&pending),
+          FUTEX_WAIT_PRIVATE,
+          0,
+          nullptr,
+          nullptr,
+          0
+        );
+      }
+    }
+  }
+
+  void forkChild() {
+    // The writer thread doesn't exist in the child, and anything still queued
+    // will be written by the parent
+    for (
+      auto ring = rings.load(std::memory_order_acquire); ring != nullptr;
+      ring = ring->next
+    ) {
+      ring->tail.store(ring->head.load(std::memory_order_relaxed));
+    }
+    new (&drainMutex) std::mutex();
+    writerState.store(0);
+  }
+
+  bool startWriter() {
+    int state = writerState.load(std::memory_order_acquire);
+    if (__builtin_expect(state != 0, 1)) {
+      return state > 0;
+    }
+    if (!writerState.compare_exchange_strong(state, 1)) {
+      return state > 0;
+    }
+    static std::once_flag registered;
+    std::call_once(registered, [] {
+      pthread_atfork(nullptr, nullptr, forkChild);
+      atexit(blight_log_flush);
+    });
+    try {
+      std::thread(writerMain).detach();
+    } catch (...) {
+      writerState.store(-1);
+      return false;
+    }
+    return true;
+  }
+
+  LogRing* acquireRing() {
+    for (
+      auto ring = rings.load(std::memory_order_acquire); ring != nullptr;
+      ring = ring->next
+    ) {
+      bool expected = false;
+      if (ring->owned.compare_exchange_strong(
+            expected, true, std::memory_order_acquire
+          )) {
+        return ring;
+      }
+    }
+    auto ring = new (std::nothrow) LogRing();
+    if (ring == nullptr) {
+      return nullptr;
+    }
+    ring->next = rings.load(std::memory_order_relaxed);
+    while (!rings.compare_exchange_weak(
+      ring->next, ring, std::memory_order_release, std::memory_order_relaxed
+    )) {}
+    return ring;
+  }
+
+  void writeNow(const LogRecord& record) {
+    std::lock_guard lock(drainMutex);
+    WriteBuffer buffer;
+    // Keep everything that was queued before this in order
+    drain(buffer);
+    buffer.append(record);
+  }
+} // namespace
 
 void
-__printf_header(int priority) {
-  std::string level;
-  switch (priority) {
-    case LOG_INFO:
-      level = "Info";
-      break;
-    case LOG_WARNING:
-      level = "Warning";
-      break;
-    case LOG_CRIT:
-      level = "Critical";
-      break;
-    default:
-      level = "Debug";
+__log_printf(
+  int priority,
+  const char* file,
+  unsigned int line,
+  const char* func,
+  const char* format,
+  ...
+) {
+  if (owner.tid == 0) {
+    owner.tid = gettid();
+    prctl(PR_GET_NAME, owner.thread);
+  }
+  LogRing* ring = nullptr;
+  if (priority > LOG_CRIT && startWriter()) {
+    if (owner.ring == nullptr) {
+      owner.ring = acquireRing();
+    }
+    ring = owner.ring;
+  }
+  LogRecord local;
+  LogRecord* record = &local;
+  uint32_t h = 0;
+  if (ring != nullptr) {
+    h = ring->head.load(std::memory_order_relaxed);
+    if (h - ring->tail.load(std::memory_order_acquire) >= LOG_RING_SIZE) {
+      ring->dropped.fetch_add(1, std::memory_order_relaxed);
+      totalDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    record = &ring->records[h & (LOG_RING_SIZE - 1)];
   }
+  record->priority = priority;
+  record->line = line;
+  record->tid = owner.tid;
+  record->file = file;
+  record->func = func;
+  std::memcpy(record->thread, owner.thread, sizeof(record->thread));
+  va_list args;
+  va_start(args, format);
+  auto res = vsnprintf(record->message, LOG_MESSAGE_SIZE, format, args);
+  va_end(args);
+  if (res >= LOG_MESSAGE_SIZE) {
+    std::memcpy(record->message + LOG_MESSAGE_SIZE - 4, "...", 4);
+  }
+  if (ring == nullptr) {
+    writeNow(local);
+    return;
+  }
+  ring->head.store(h + 1, std::memory_order_release);
+  // Only wake the writer when it may be asleep
+  if (pending.exchange(1, std::memory_order_seq_cst) == 0) {
+    wake();
+  }
+}
+
+void
+__printf_header(int priority) {
+  // Anything queued was logged first
+  blight_log_flush();
   char name[16];
   prctl(PR_GET_NAME, name);
-  auto selfpath = realpath("/proc/self/exe", nullptr);
   fprintf(
     stderr,
     "[%i:%i:%i %s - %s] %s: ",
     getpgrp(),
     getpid(),
     gettid(),
-    selfpath == nullptr ? "(unknown)" : selfpath,
+    selfPath(),
     name,
-    level.c_str()
+    levelName(priority)
   );
-  free(selfpath);
 }
 
 void
@@ -41,12 +370,38 @@ __printf_footer(const char* file, unsigned int line, const char* func) {
   fprintf(stderr, " (%s:%u, %s)\n", file, line, func);
 }
 
+int
+blight_debug_level_from_environment() {
+  auto value = getenv("DEBUG");
+  if (value == nullptr) {
+    return LOG_WARNING;
+  }
+  for (auto disabled : {"0", "n", "no", "false"}) {
+    if (strcasecmp(value, disabled) == 0) {
+      return LOG_WARNING;
+    }
+  }
+  return LOG_DEBUG;
+}
+
 int
 get_blight_debug_level() {
-  return BLIGHT_DEBUG_LOGGING;
+  return __blight_debug_level.load(std::memory_order_relaxed);
 }
 
 void
 set_blight_debug_level(int level) {
-  BLIGHT_DEBUG_LOGGING = level;
+  __blight_debug_level.store(level, std::memory_order_relaxed);
+}
+
+void
+blight_log_flush() {
+  std::lock_guard lock(drainMutex);
+  WriteBuffer buffer;
+  drain(buffer);
+}
+
+size_t
+blight_log_dropped() {
+  return totalDropped.load(std::memory_order_relaxed);
 }
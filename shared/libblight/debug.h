@@ -7,6 +7,8 @@
 
 #include "libblight_global.h"
 
+#include <atomic>
+#include <cstddef>
 #include <cstdio>
 #include <linux/prctl.h>
 #include <mutex>
@@ -14,14 +16,42 @@
 #include <systemd/sd-journal.h>
 #include <unistd.h>
 
+LIBBLIGHT_EXPORT extern std::atomic<int> __blight_debug_level;
+// Used by _PRINTF as expanded by older versions of this header, which
+// applications built against them still call
 LIBBLIGHT_EXPORT extern std::mutex __log_mutex;
 void
 __printf_header(int priority);
 void
 __printf_footer(char const* file, unsigned int line, char const* func);
+/*!
+ * \brief Queue a log message to be written to stderr
+ *
+ * The message is formatted into a ring owned by the calling thread, and the
+ * header, location and write to stderr are done by a background thread.
+ * Messages are dropped and counted instead of blocking when the ring is full.
+ * Critical messages are written straight away.
+ * \param priority Log priority
+ * \param file File the message was logged from
+ * \param line Line the message was logged from
+ * \param func Function the message was logged from
+ * \param format printf style format string
+ */
+LIBBLIGHT_EXPORT void
+__log_printf(
+  int priority,
+  const char* file,
+  unsigned int line,
+  const char* func,
+  const char* format,
+  ...
+) __attribute__((format(printf, 5, 6)));
 
 /*!
  * \brief Get current debug level
+ *
+ * The level is resolved once from the environment when the library is
+ * loaded, so this is a single relaxed load.
  * \return Current debug level
  */
 LIBBLIGHT_EXPORT int
@@ -32,16 +62,36 @@ get_blight_debug_level();
  */
 LIBBLIGHT_EXPORT void
 set_blight_debug_level(int level);
+/*!
+ * \brief Get the debug level requested by the environment
+ *
+ * LOG_DEBUG if DEBUG is set to anything other than 0, n, no, or false,
+ * otherwise LOG_WARNING.
+ * \return Debug level
+ */
+LIBBLIGHT_EXPORT int
+blight_debug_level_from_environment();
+/*!
+ * \brief Write out all queued log messages
+ */
+LIBBLIGHT_EXPORT void
+blight_log_flush();
+/*!
+ * \brief Total number of log messages dropped because a ring was full
+ */
+LIBBLIGHT_EXPORT size_t
+blight_log_dropped();
 
 /*!
  * \brief Log a message to stderr
  */
 #define _PRINTF(priority, ...)                                                 \
-  if (priority <= get_blight_debug_level()) {                                  \
-    std::lock_guard<std::mutex> lock(__log_mutex);                             \
-    __printf_header(priority);                                                 \
-    fprintf(stderr, __VA_ARGS__);                                              \
-    __printf_footer(__FILE__, __LINE__, __PRETTY_FUNCTION__);                  \
+  if (__builtin_expect(                                                        \
+        (priority) <= __blight_debug_level.load(std::memory_order_relaxed), 0  \
+      )) {                                                                     \
+    __log_printf(                                                              \
+      priority, __FILE__, __LINE__, __PRETTY_FUNCTION__, __VA_ARGS__           \
+    );                                                                         \
   }
 
 /*!
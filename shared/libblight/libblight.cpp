@@ -22,31 +22,57 @@ namespace Blight {
       return {};
     }
     _DEBUG("[Blight::%s()]", name.c_str());
-    auto reply =
-      dbus->get_property(BLIGHT_SERVICE, "/", BLIGHT_INTERFACE, name, "ay");
+    auto reply = dbus->call_method(
+      BLIGHT_SERVICE, "/", BLIGHT_INTERFACE, "openClipboard", "s", name.c_str()
+    );
     if (reply->isError()) {
       _WARN(
-        "[Blight::%s()::get_property(...)] Error: %s",
+        "[Blight::%s()::call_method(...)] Error: %s",
         name.c_str(),
         reply->error_message().c_str()
       );
       return {};
     }
-    const void* clipboard = nullptr;
-    ::size_t size = 0;
-    auto res =
-      sd_bus_message_read_array(reply->message, 'y', &clipboard, &size);
+    int fd = -1;
+    uint64_t size = 0;
+    const char* mimeType = nullptr;
+    uint64_t generation = 0;
+    auto res = sd_bus_message_read(
+      reply->message, "htst", &fd, &size, &mimeType, &generation
+    );
     if (res < 0) {
       _WARN(
-        "[Blight::%s()::sd_bus_message_read_array(...)] Error: %s",
+        "[Blight::%s()::sd_bus_message_read(...)] Error: %s",
         name.c_str(),
-        reply->error_message().c_str()
+        std::strerror(-res)
       );
+      errno = -res;
       return {};
     }
-    auto data = new unsigned char[size];
-    memcpy(data, clipboard, size);
-    return clipboard_t(name, data, static_cast<size_t>(size));
+    clipboard_t clipboard(name);
+    clipboard.mimeType = mimeType;
+    clipboard.generation = generation;
+    if (!size) {
+      return clipboard;
+    }
+    // The memfd is sealed by the display server, so the data can be mapped
+    // instead of copied. The mapping outlives the fd, which is closed with
+    // the reply.
+    auto data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      _WARN(
+        "[Blight::%s()::mmap(...)] Error: %s",
+        name.c_str(),
+        std::strerror(errno)
+      );
+      return {};
+    }
+    clipboard.data = shared_data_t(
+      static_cast<unsigned char*>(data),
+      [size](unsigned char* data) { munmap(data, size); }
+    );
+    clipboard.size = size;
+    return clipboard;
   }
 
   bool connect(bool use_system) {
@@ -115,15 +141,29 @@ namespace Blight {
     return dfd;
   }
 
-  std::shared_ptr<input_buffer_t> open_input(unsigned short device) {
+  std::shared_ptr<input_buffer_t>
+  open_input(unsigned short device, unsigned int capacity) {
     if (!exists()) {
       errno = EAGAIN;
       return nullptr;
     }
-    _DEBUG("[Blight::open_input(%d)]", device);
-    auto reply = dbus->call_method(
-      BLIGHT_SERVICE, "/", BLIGHT_INTERFACE, "openInput", "q", device
-    );
+    _DEBUG("[Blight::open_input(%d, %u)]", device, capacity);
+    dbus_reply_t reply;
+    if (capacity) {
+      reply = dbus->call_method(
+        BLIGHT_SERVICE,
+        "/",
+        BLIGHT_INTERFACE,
+        "openInputWithCapacity",
+        "qu",
+        device,
+        capacity
+      );
+    } else {
+      reply = dbus->call_method(
+        BLIGHT_SERVICE, "/", BLIGHT_INTERFACE, "openInput", "q", device
+      );
+    }
     if (reply->isError()) {
       _WARN(
         "[Blight::open_input(%d)::call_method(...)] Error: %s",
@@ -395,106 +435,81 @@ namespace Blight {
       errno = EINVAL;
       return false;
     }
-    sd_bus_message* message;
-    auto res = sd_bus_message_new_method_call(
-      dbus->bus(),
-      &message,
-      BLIGHT_SERVICE,
-      "/",
-      "org.freedesktop.DBus.Properties",
-      "Set"
-    );
-    if (res < 0) {
-      _WARN(
-        "[Blight::setClipboard(\"%s\")::sd_bus_message_new_method_call("
-        ")] Error: %s",
-        clipboard.name.c_str(),
-        std::strerror(-res)
-      );
-      if (message != nullptr) {
-        sd_bus_message_unref(message);
-      }
-      // Attempt to reset to the current value
-      updateClipboard(clipboard);
+    if (!exists()) {
+      errno = EAGAIN;
       return false;
     }
-    res = sd_bus_message_append(
-      message,
-      "ss",
-      BLIGHT_INTERFACE,
-      // sd_bus_message_append seems to destroy the string,
-      // so a copy is needed
-      std::string(clipboard.name).c_str()
+    int fd = memfd_create(
+      ("blight-" + clipboard.name).c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING
     );
-    if (res < 0) {
+    if (fd == -1) {
       _WARN(
-        "[Blight::setClipboard(\"%s\")::sd_bus_message_append()] "
-        "Error: %s",
+        "[Blight::setClipboard(\"%s\")::memfd_create()] Error: %s",
         clipboard.name.c_str(),
-        std::strerror(-res)
+        std::strerror(errno)
       );
-      sd_bus_message_unref(message);
-      // Attempt to reset to the current value
-      updateClipboard(clipboard);
       return false;
     }
-    res = sd_bus_message_open_container(message, 'v', "ay");
-    if (res < 0) {
-      _WARN(
-        "[Blight::setClipboard(\"%s\")::sd_bus_message_open_container()"
-        "] Error: %s",
-        clipboard.name.c_str(),
-        std::strerror(-res)
-      );
-      sd_bus_message_unref(message);
-      // Attempt to reset to the current value
-      updateClipboard(clipboard);
-      return false;
+    auto data = reinterpret_cast<const char*>(clipboard.data.get());
+    size_t written = 0;
+    while (written < clipboard.size) {
+      auto res = ::write(fd, data + written, clipboard.size - written);
+      if (res == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        _WARN(
+          "[Blight::setClipboard(\"%s\")::write()] Error: %s",
+          clipboard.name.c_str(),
+          std::strerror(errno)
+        );
+        ::close(fd);
+        // Attempt to reset to the current value
+        updateClipboard(clipboard);
+        return false;
+      }
+      written += res;
     }
-    res = sd_bus_message_append_array(
-      message, 'y', clipboard.data.get(), clipboard.size
-    );
-    if (res < 0) {
+    // Sealing lets the display server share the fd with other clients
+    // without taking a copy
+    if (
+      fcntl(
+        fd,
+        F_ADD_SEALS,
+        F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL
+      ) == -1
+    ) {
       _WARN(
-        "[Blight::setClipboard(\"%s\")::sd_bus_message_append_array()] "
-        "Error: %s",
+        "[Blight::setClipboard(\"%s\")::fcntl(F_ADD_SEALS)] Error: %s",
         clipboard.name.c_str(),
-        std::strerror(-res)
+        std::strerror(errno)
       );
-      sd_bus_message_unref(message);
-      // Attempt to reset to the current value
-      updateClipboard(clipboard);
-      return false;
     }
-    res = sd_bus_message_close_container(message);
-    if (res < 0) {
+    auto reply = dbus->call_method(
+      BLIGHT_SERVICE,
+      "/",
+      BLIGHT_INTERFACE,
+      "setClipboardFd",
+      "shs",
+      clipboard.name.c_str(),
+      fd,
+      clipboard.mimeType.c_str()
+    );
+    ::close(fd);
+    if (reply->isError()) {
       _WARN(
-        "[Blight::setClipboard(\"%s\")::sd_bus_message_close_container("
-        ")] Error: %s",
+        "[Blight::setClipboard(\"%s\")::call_method(...)] Error: %s",
         clipboard.name.c_str(),
-        std::strerror(-res)
+        reply->error_message().c_str()
       );
-      sd_bus_message_unref(message);
       // Attempt to reset to the current value
       updateClipboard(clipboard);
       return false;
     }
-    sd_bus_error error = SD_BUS_ERROR_NULL;
-    res = sd_bus_call(dbus->bus(), message, 0, &error, NULL);
-    if (res < 0) {
-      _WARN(
-        "[Blight::setClipboard(\"%s\")::sd_bus_call()] Error: %s",
-        clipboard.name.c_str(),
-        (error.message != NULL ? error.message : std::strerror(-res))
-      );
-      sd_bus_message_unref(message);
-      sd_bus_error_free(&error);
-      // Attempt to reset to the current value
-      updateClipboard(clipboard);
-      return false;
+    auto generation = reply->read_value<uint64_t>("t");
+    if (generation.has_value()) {
+      clipboard.generation = generation.value();
     }
-    sd_bus_message_unref(message);
-    sd_bus_error_free(&error);
     return true;
   }
 
@@ -519,6 +534,8 @@ namespace Blight {
     }
     clipboard.size = newClipboard->size;
     clipboard.data = newClipboard->data;
+    clipboard.mimeType = newClipboard->mimeType;
+    clipboard.generation = newClipboard->generation;
     return true;
   }
 
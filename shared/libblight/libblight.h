@@ -50,11 +50,15 @@ namespace Blight {
   /*!
    * \brief Open an input event device buffer
    * \param device Input event device number
+   * \param capacity Number of events the buffer should hold, rounded up to a
+   * power of 2. 0 will use the default. Only used the first time the buffer is
+   * opened.
    * \return Input event device buffer
    * \sa Blight::Connection::read_event()
    */
   LIBBLIGHT_EXPORT std::shared_ptr<input_buffer_t> open_input(
-    unsigned short device
+    unsigned short device,
+    unsigned int capacity = 0
   );
   /*!
    * \brief Get the clipboard
@@ -17,6 +17,7 @@ SOURCES += \
     libblight.cpp \
     socket.cpp \
     system.cpp \
+    trace.cpp \
     types.cpp
 
 HEADERS += \
@@ -30,6 +31,7 @@ HEADERS += \
     meta.h \
     socket.h \
     system.h \
+    trace.h \
     types.h
 
 PRECOMPILED_HEADER = \
@@ -16,6 +16,10 @@ namespace Blight {
     return BlightProtocol::send_blocking(fd, data, size);
   }
 
+  bool send_blocking(int fd, const header_t& header, const data_t data) {
+    return BlightProtocol::send_blocking(fd, header, data);
+  }
+
   bool wait_for_send(int fd, int timeout) {
     return BlightProtocol::wait_for_send(fd, timeout);
   }
@@ -37,6 +37,16 @@ namespace Blight {
    * \return If the data was sent without error.
    */
   LIBBLIGHT_EXPORT bool send_blocking(int fd, const data_t data, ssize_t size);
+  /*!
+   * \brief Send a message header and its data to a socket with a single
+   * sendmsg call.
+   * \param fd The socket
+   * \param header The message header.
+   * \param data The message data, \c header.size bytes long.
+   * \return If the message was sent without error.
+   */
+  LIBBLIGHT_EXPORT bool
+  send_blocking(int fd, const header_t& header, const data_t data);
   /*!
    * \brief Wait until a socket is ready to send data.
    * \param fd The socket
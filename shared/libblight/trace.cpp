@@ -0,0 +1,302 @@
+#include "trace.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include "debug.h"
+
+using namespace Blight::Trace;
+
+namespace {
+  constexpr uint32_t trace_magic = 0x54524345;
+  constexpr uint32_t trace_version = 1;
+  constexpr const char* trace_prefix = "blight-trace-";
+
+  static_assert(
+    std::atomic<uint64_t>::is_always_lock_free,
+    "Trace buffers are shared between processes and must not use locks"
+  );
+
+  // Each slot acts as a sequence lock, sequence is zero while it is being
+  // written and the sample index plus one once it is complete
+  struct slot_t {
+    std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> input;
+    std::atomic<uint64_t> stamp;
+    std::atomic<uint64_t> stage;
+  };
+
+  struct buffer_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t reserved;
+    std::atomic<uint64_t> head;
+    slot_t slots[Blight::Trace::capacity];
+  };
+
+  std::atomic<int> state{-1};
+  std::atomic<uint64_t> lastInput{0};
+  std::atomic<uint64_t> marked[StageCount];
+  std::atomic<buffer_t*> current{nullptr};
+  std::atomic<pid_t> currentPid{0};
+  std::mutex openMutex;
+
+  std::string path(pid_t pid) {
+    return "/dev/shm/" + std::string(trace_prefix) + std::to_string(pid);
+  }
+
+  buffer_t* map(pid_t pid, bool create) {
+    auto filePath = path(pid);
+    int fd = ::open(
+      filePath.c_str(),
+      (create ? O_RDWR | O_CREAT : O_RDONLY) | O_CLOEXEC,
+      0644
+    );
+    if (fd < 0) {
+      if (create) {
+        _WARN("Failed to open %s: %s", filePath.c_str(), std::strerror(errno));
+      }
+      return nullptr;
+    }
+    if (create && ftruncate(fd, sizeof(buffer_t)) < 0) {
+      _WARN(
+        "Failed to resize %s: %s", filePath.c_str(), std::strerror(errno)
+      );
+      ::close(fd);
+      return nullptr;
+    }
+    void* data = mmap(
+      nullptr,
+      sizeof(buffer_t),
+      create ? PROT_READ | PROT_WRITE : PROT_READ,
+      MAP_SHARED,
+      fd,
+      0
+    );
+    ::close(fd);
+    if (data == MAP_FAILED) {
+      _WARN("Failed to map %s: %s", filePath.c_str(), std::strerror(errno));
+      return nullptr;
+    }
+    auto buffer = static_cast<buffer_t*>(data);
+    if (create) {
+      // The file may be left over from a previous process with the same pid
+      memset(data, 0, sizeof(buffer_t));
+      buffer->magic = trace_magic;
+      buffer->version = trace_version;
+      buffer->capacity = capacity;
+    } else if (
+      buffer->magic != trace_magic || buffer->version != trace_version ||
+      buffer->capacity != capacity
+    ) {
+      munmap(data, sizeof(buffer_t));
+      return nullptr;
+    }
+    return buffer;
+  }
+
+  // Remove the buffers of exited processes, apart from the most recent ones
+  void prune(pid_t self) {
+    std::vector<std::pair<time_t, pid_t>> stale;
+    for (auto pid : processes()) {
+      if (pid == self || kill(pid, 0) == 0 || errno != ESRCH) {
+        continue;
+      }
+      struct stat info;
+      if (stat(path(pid).c_str(), &info) == 0) {
+        stale.emplace_back(info.st_mtime, pid);
+      }
+    }
+    if (stale.size() <= stale_limit) {
+      return;
+    }
+    std::sort(stale.begin(), stale.end(), std::greater<>());
+    for (auto it = stale.begin() + stale_limit; it != stale.end(); ++it) {
+      remove(it->second);
+    }
+  }
+
+  buffer_t* buffer() {
+    auto pid = getpid();
+    auto trace = current.load(std::memory_order_acquire);
+    if (currentPid.load(std::memory_order_relaxed) == pid) {
+      return trace;
+    }
+    std::lock_guard lock(openMutex);
+    if (currentPid.load(std::memory_order_relaxed) == pid) {
+      return current.load(std::memory_order_relaxed);
+    }
+    // Either this is the first sample, or this is a child process that
+    // inherited the mapping of its parent
+    prune(pid);
+    trace = map(pid, true);
+    current.store(trace, std::memory_order_release);
+    currentPid.store(pid, std::memory_order_release);
+    return trace;
+  }
+
+  void record(Stage stage, uint64_t input) {
+    auto trace = buffer();
+    if (trace == nullptr) {
+      return;
+    }
+    auto index = trace->head.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = trace->slots[index % capacity];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.input.store(input, std::memory_order_relaxed);
+    slot.stamp.store(now(), std::memory_order_relaxed);
+    slot.stage.store(stage, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+  }
+}
+
+namespace Blight {
+  namespace Trace {
+    bool enabled() {
+      int value = state.load(std::memory_order_relaxed);
+      if (value < 0) {
+        value = getenv("OXIDE_BLIGHT_TRACE") != nullptr ? 1 : 0;
+        state.store(value, std::memory_order_relaxed);
+      }
+      return value == 1;
+    }
+
+    void set_enabled(bool enabled) {
+      state.store(enabled ? 1 : 0, std::memory_order_relaxed);
+    }
+
+    uint64_t now() {
+      // input_event::time uses CLOCK_REALTIME unless the device has been
+      // told otherwise
+      timespec time;
+      clock_gettime(CLOCK_REALTIME, &time);
+      return (uint64_t)time.tv_sec * 1000000000ull + time.tv_nsec;
+    }
+
+    uint64_t timestamp(const timeval& time) {
+      return (uint64_t)time.tv_sec * 1000000000ull +
+             (uint64_t)time.tv_usec * 1000ull;
+    }
+
+    void input(Stage stage, const timeval& time) {
+      if (!enabled()) {
+        return;
+      }
+      auto stamp = timestamp(time);
+      lastInput.store(stamp, std::memory_order_relaxed);
+      record(stage, stamp);
+    }
+
+    void mark(Stage stage) {
+      mark(stage, lastInput.load(std::memory_order_relaxed));
+    }
+
+    void mark(Stage stage, uint64_t input) {
+      if (!enabled() || stage >= StageCount) {
+        return;
+      }
+      if (!input) {
+        return;
+      }
+      if (marked[stage].exchange(input, std::memory_order_relaxed) == input) {
+        return;
+      }
+      record(stage, input);
+    }
+
+    uint64_t last_input() {
+      return lastInput.load(std::memory_order_relaxed);
+    }
+
+    const char* stage_name(Stage stage) {
+      switch (stage) {
+        case EvdevRead:
+          return "evdev-read";
+        case RingInsert:
+          return "ring-insert";
+        case ClientRead:
+          return "client-read";
+        case RepaintSend:
+          return "repaint-send";
+        case Enqueue:
+          return "enqueue";
+        case RedrawStart:
+          return "redraw-start";
+        case UpdateComplete:
+          return "update-complete";
+        default:
+          return "unknown";
+      }
+    }
+
+    std::vector<pid_t> processes() {
+      std::vector<pid_t> pids;
+      DIR* dir = opendir("/dev/shm");
+      if (dir == nullptr) {
+        return pids;
+      }
+      const size_t length = strlen(trace_prefix);
+      while (auto entry = readdir(dir)) {
+        if (strncmp(entry->d_name, trace_prefix, length) != 0) {
+          continue;
+        }
+        char* end;
+        auto pid = strtol(entry->d_name + length, &end, 10);
+        if (*end == '\0' && pid > 0) {
+          pids.push_back((pid_t)pid);
+        }
+      }
+      closedir(dir);
+      return pids;
+    }
+
+    std::vector<sample_t> read(pid_t pid) {
+      std::vector<sample_t> samples;
+      auto trace = map(pid, false);
+      if (trace == nullptr) {
+        return samples;
+      }
+      auto head = trace->head.load(std::memory_order_acquire);
+      auto start = head > capacity ? head - capacity : 0;
+      samples.reserve(head - start);
+      for (auto index = start; index < head; index++) {
+        auto& slot = trace->slots[index % capacity];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        sample_t sample{
+          .stage = (Stage)slot.stage.load(std::memory_order_relaxed),
+          .input = slot.input.load(std::memory_order_relaxed),
+          .stamp = slot.stamp.load(std::memory_order_relaxed),
+        };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Skip slots that are being written, or were overwritten while
+        // reading
+        if (
+          sequence != index + 1 ||
+          slot.sequence.load(std::memory_order_relaxed) != sequence
+        ) {
+          continue;
+        }
+        samples.push_back(sample);
+      }
+      munmap(trace, sizeof(buffer_t));
+      return samples;
+    }
+
+    bool remove(pid_t pid) {
+      return unlink(path(pid).c_str()) == 0;
+    }
+  } // namespace Trace
+} // namespace Blight
@@ -0,0 +1,147 @@
+/*!
+ * \addtogroup Blight
+ * @{
+ * \file
+ */
+#pragma once
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "libblight_global.h"
+
+namespace Blight {
+  /*!
+   * \brief Input to screen latency tracing
+   *
+   * When the OXIDE_BLIGHT_TRACE environment variable is set, each process
+   * records samples into a fixed size buffer in /dev/shm/blight-trace-<pid>.
+   * Every sample stores the timestamp of the input frame that caused it and
+   * the time the stage was reached, so the latency of a stage is the
+   * difference between the two. Recording does not lock or allocate.
+   * Buffers left behind by processes that have exited are kept so that they
+   * can still be read. Only the most recent stale_limit of them are kept,
+   * older ones are removed whenever a process creates its buffer.
+   *
+   * All times are in nanoseconds on the same clock as input_event::time.
+   */
+  namespace Trace {
+    /*!
+     * \brief Point on the path from input to the screen
+     */
+    enum Stage : uint32_t {
+      /*! Frame read from the evdev device by the display server */
+      EvdevRead = 0,
+      /*! Frame written to a connection's input buffer */
+      RingInsert,
+      /*! Frame read from the input buffer by the client */
+      ClientRead,
+      /*! First repaint sent by the client after a frame */
+      RepaintSend,
+      /*! First repaint queued by the display server after a frame */
+      Enqueue,
+      /*! First redraw started by the display server after a frame */
+      RedrawStart,
+      /*! First screen update completed after a frame */
+      UpdateComplete,
+      /*! Number of stages */
+      StageCount
+    };
+    /*!
+     * \brief A single recorded sample
+     */
+    typedef struct {
+      /*! \brief Stage that was reached */
+      Stage stage;
+      /*! \brief Timestamp of the input frame */
+      uint64_t input;
+      /*! \brief Time the stage was reached */
+      uint64_t stamp;
+    } sample_t;
+    /*!
+     * \brief Number of samples kept for each process
+     */
+    constexpr uint32_t capacity = 4096;
+    /*!
+     * \brief Number of buffers kept for processes that have exited
+     */
+    constexpr size_t stale_limit = 8;
+    /*!
+     * \brief Check if tracing is enabled for this process
+     * \return If tracing is enabled
+     */
+    LIBBLIGHT_EXPORT bool enabled();
+    /*!
+     * \brief Enable or disable tracing for this process
+     * \param enabled If tracing should be enabled
+     */
+    LIBBLIGHT_EXPORT void set_enabled(bool enabled);
+    /*!
+     * \brief Get the current time
+     * \return The current time
+     */
+    LIBBLIGHT_EXPORT uint64_t now();
+    /*!
+     * \brief Convert an input_event timestamp
+     * \param time Timestamp to convert
+     * \return The timestamp in nanoseconds
+     */
+    LIBBLIGHT_EXPORT uint64_t timestamp(const timeval& time);
+    /*!
+     * \brief Record that an input frame reached a stage
+     *
+     * The frame becomes the one that later stages are measured against.
+     * \param stage Stage that was reached
+     * \param time Timestamp of the input frame
+     */
+    LIBBLIGHT_EXPORT void input(Stage stage, const timeval& time);
+    /*!
+     * \brief Record that the last input frame reached a stage
+     *
+     * Only the first time a stage is reached for each frame is recorded, so
+     * that work unrelated to input doesn't show up as latency.
+     * \param stage Stage that was reached
+     */
+    LIBBLIGHT_EXPORT void mark(Stage stage);
+    /*!
+     * \brief Record that an earlier input frame reached a stage
+     *
+     * Used when a stage completes asynchronously, and later frames may
+     * have been read by the time it does.
+     * \param stage Stage that was reached
+     * \param input Timestamp of the input frame, as returned by last_input()
+     */
+    LIBBLIGHT_EXPORT void mark(Stage stage, uint64_t input);
+    /*!
+     * \brief Get the timestamp of the last input frame
+     * \return The timestamp in nanoseconds, or 0 if there hasn't been one
+     */
+    LIBBLIGHT_EXPORT uint64_t last_input();
+    /*!
+     * \brief Get the name of a stage
+     * \param stage Stage to get the name of
+     * \return The name of the stage
+     */
+    LIBBLIGHT_EXPORT const char* stage_name(Stage stage);
+    /*!
+     * \brief Get the processes that have a trace buffer
+     * \return The process ids
+     */
+    LIBBLIGHT_EXPORT std::vector<pid_t> processes();
+    /*!
+     * \brief Read the samples recorded by a process
+     * \param pid Process to read the samples of
+     * \return The samples, oldest first
+     */
+    LIBBLIGHT_EXPORT std::vector<sample_t> read(pid_t pid);
+    /*!
+     * \brief Remove the trace buffer of a process
+     * \param pid Process to remove the trace buffer of
+     * \return If the buffer was removed
+     */
+    LIBBLIGHT_EXPORT bool remove(pid_t pid);
+  } // namespace Trace
+} // namespace Blight
+/*! @} */
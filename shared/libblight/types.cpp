@@ -1,5 +1,6 @@
 #include "types.h"
 
+#include <libblight_protocol/pool.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
@@ -85,6 +86,27 @@ Blight::input_buffer_t::read(bool blocking) {
   return blocking ? ringBuffer->wait_for_values() : ringBuffer->take();
 }
 
+std::size_t
+Blight::input_buffer_t::read(
+  struct input_event* events,
+  std::size_t max,
+  bool blocking
+) {
+  if (ringBuffer == nullptr) {
+    return 0;
+  }
+  return blocking ? ringBuffer->wait_for_many(events, max)
+                  : ringBuffer->take_many(events, max);
+}
+
+uint32_t
+Blight::input_buffer_t::dropped() const {
+  if (ringBuffer == nullptr) {
+    return 0;
+  }
+  return ringBuffer->dropped();
+}
+
 std::optional<Blight::shared_buf_t>
 Blight::buf_t::clone() {
   auto res = Blight::createBuffer(x, y, width, height, stride, format, scale);
@@ -193,11 +215,46 @@ Blight::message_t::from_socket(int fd) {
   return message;
 }
 
+Blight::message_ptr_t
+Blight::message_t::from_reader(
+  BlightProtocol::MessageReader& reader,
+  int timeout
+) {
+  BlightProtocol::blight_header_t header;
+  data_t data;
+  int res = reader.next(&header, &data, timeout);
+  if (res < 0) {
+    return nullptr;
+  }
+  auto message = Blight::message_t::new_ptr();
+  if (message == nullptr) {
+    BlightProtocol::Pool::deallocate(data);
+    errno = ENOMEM;
+    return nullptr;
+  }
+  memcpy(&message->header, &header, sizeof(BlightProtocol::blight_header_t));
+  if (data == nullptr) {
+    return message;
+  }
+  try {
+    message->data = shared_data_t(
+      data,
+      BlightProtocol::Pool::Deleter(),
+      BlightProtocol::Pool::Allocator<unsigned char>()
+    );
+  } catch (std::bad_alloc&) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  return message;
+}
+
 Blight::message_ptr_t
 Blight::message_t::new_ptr() {
   try {
-    return message_ptr_t(
-      new message_t{.header = header_t::new_invalid(), .data = shared_data_t()}
+    return std::allocate_shared<message_t>(
+      BlightProtocol::Pool::Allocator<message_t>(),
+      message_t{.header = header_t::new_invalid(), .data = shared_data_t()}
     );
   } catch (std::bad_alloc&) {
     return message_ptr_t(nullptr);
@@ -212,6 +269,35 @@ Blight::repaint_t::from_message(const message_t* message) {
   return repaint;
 }
 
+std::optional<Blight::repaint_region_t>
+Blight::repaint_region_t::from_message(const message_t* message) {
+  const data_t data = message->data.get();
+  const size_t size = message->header.size;
+  if (data == nullptr || size < sizeof(blight_packet_repaint_region_t)) {
+    return {};
+  }
+  repaint_region_t repaint;
+  memcpy(
+    static_cast<blight_packet_repaint_region_t*>(&repaint),
+    data,
+    sizeof(blight_packet_repaint_region_t)
+  );
+  const size_t rectsSize = size - sizeof(blight_packet_repaint_region_t);
+  if (
+    rectsSize % sizeof(rect_t) != 0 ||
+    rectsSize / sizeof(rect_t) != repaint.count
+  ) {
+    return {};
+  }
+  repaint.rects.resize(repaint.count);
+  memcpy(
+    repaint.rects.data(),
+    data + sizeof(blight_packet_repaint_region_t),
+    rectsSize
+  );
+  return repaint;
+}
+
 Blight::move_t
 Blight::move_t::from_message(const message_t* message) {
   move_t move;
@@ -219,6 +305,13 @@ Blight::move_t::from_message(const message_t* message) {
   return move;
 }
 
+Blight::ink_overlay_t
+Blight::ink_overlay_t::from_message(const message_t* message) {
+  ink_overlay_t overlay;
+  memcpy(&overlay, message->data.get(), sizeof(ink_overlay_t));
+  return overlay;
+}
+
 Blight::surface_info_t
 Blight::surface_info_t::from_data(data_t data) {
   surface_info_t header;
@@ -6,8 +6,10 @@
 #pragma once
 #include <libblight_protocol.h>
 #include <libblight_protocol/ringbuffer.h>
+#include <libblight_protocol/socket.h>
 #include <linux/input.h>
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -44,6 +46,10 @@ namespace Blight {
    * \brief Surface identifier
    */
   typedef BlightProtocol::blight_surface_id_t surface_id_t;
+  /*!
+   * \brief Rectangle on a surface
+   */
+  typedef BlightProtocol::blight_rect_t rect_t;
   /*!
    * \brief Shared memory ring buffer for evdev input events
    */
@@ -70,6 +76,23 @@ namespace Blight {
      * \return The input event
      */
     std::optional<struct input_event> read(bool blocking = false);
+    /*!
+     * \brief Read multiple input events from the ring buffer
+     * \param events Where to store the events
+     * \param max Maximum number of events to read
+     * \param blocking If this call should block until an event is available
+     * \return Number of events read
+     */
+    std::size_t read(
+      struct input_event* events,
+      std::size_t max,
+      bool blocking = false
+    );
+    /*!
+     * \brief Number of events that were dropped because the buffer was full
+     * \return Number of dropped events
+     */
+    uint32_t dropped() const;
     ~input_buffer_t();
   } input_buffer_t;
   /*!
@@ -101,6 +124,18 @@ namespace Blight {
      * \brief Name of clipboard
      */
     std::string name;
+    /*!
+     * \brief MIME type of the data
+     */
+    std::string mimeType = "application/octet-stream";
+    /*!
+     * \brief Generation of the data
+     *
+     * Every change to any clipboard gets a higher generation than the last,
+     * and the change signals only carry the new generation. Compare against
+     * this to tell if the data needs to be fetched again.
+     */
+    uint64_t generation = 0;
     /*!
      * \brief Create a new clipboard instance
      * \param name Name of clipboard
@@ -319,6 +354,16 @@ namespace Blight {
      * \return Message
      */
     static message_ptr_t from_socket(int fd);
+    /*!
+     * \brief Read the next message from a buffered socket reader
+     * \param reader Reader for the socket
+     * \param timeout How long to wait for data if no message is buffered
+     * \return Message, or nullptr with errno set if there was none
+     */
+    static message_ptr_t from_reader(
+      BlightProtocol::MessageReader& reader,
+      int timeout = 0
+    );
     /*!
      * \brief Create a new invalid and empty message
      * \return Invalid and empty message
@@ -336,6 +381,25 @@ namespace Blight {
      */
     static repaint_t from_message(const message_t* message);
   } repaint_t;
+  /*!
+   * \brief Repaint region message data
+   */
+  typedef struct repaint_region_t
+    : public BlightProtocol::blight_packet_repaint_region_t {
+    /*!
+     * \brief Areas of the surface to repaint
+     */
+    std::vector<rect_t> rects;
+    /*!
+     * \brief Get the repaint region message data from a message
+     * \param message Message
+     * \return Repaint region message data, or nothing if the message is
+     * malformed
+     */
+    static std::optional<repaint_region_t> from_message(
+      const message_t* message
+    );
+  } repaint_region_t;
   /*!
    * \brief Move message data
    */
@@ -347,6 +411,18 @@ namespace Blight {
      */
     static move_t from_message(const message_t* message);
   } move_t;
+  /*!
+   * \brief Ink overlay message data
+   */
+  typedef struct ink_overlay_t
+    : public BlightProtocol::blight_packet_ink_overlay_t {
+    /*!
+     * \brief Get the ink overlay message data from a message
+     * \param message Message
+     * \return Ink overlay message data
+     */
+    static ink_overlay_t from_message(const message_t* message);
+  } ink_overlay_t;
   /*!
    * \brief Surface information message data
    */
@@ -3,13 +3,19 @@
 #include "libc.h"
 #include "state.h"
 
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <errno.h>
 #include <fcntl.h>
+#include <mutex>
+#include <semaphore.h>
 #include <stdlib.h>
 #include <string>
 #include <sys/mman.h>
+#include <sys/prctl.h>
+#include <thread>
 #include <vector>
 
 #include <libblight.h>
@@ -28,6 +34,7 @@ namespace FB {
   int msgq = -1;
   float visibleYRatio = 1.0f;
   float visibleXRatio = 1.0f;
+  std::atomic<unsigned int> lastMarker = 0;
   bool init() {
     _DEBUG("Handle framebuffer: %d", Client::isFbEnabled());
     auto pid = getpid();
@@ -123,7 +130,9 @@ namespace FB {
       update->waveform_mode,
       update->update_mode
     );
-    auto maybe = repaint(
+    // Like the driver, this returns as soon as the update is queued. Apps
+    // that need to know when it is done use MXCFB_WAIT_FOR_UPDATE_COMPLETE
+    repaint(
       region.left,
       region.top,
       region.width,
@@ -133,9 +142,6 @@ namespace FB {
       (Blight::UpdateMode)update->update_mode,
       update->update_marker
     );
-    if (maybe.has_value()) {
-      maybe.value()->wait();
-    }
     _DEBUG("ioctl /dev/fb0 MXCFB_SEND_UPDATE done: %f", cw.elapsed());
     // TODO - notify on rM2 for screensharing
     return 0;
@@ -143,6 +149,11 @@ namespace FB {
   int wait(mxcfb_update_marker_data* update) {
     _DEBUG("%s", "ioctl /dev/fb0 MXCFB_WAIT_FOR_UPDATE_COMPLETE");
     Blight::ClockWatch cw;
+    if (!connection->hasMarker(update->update_marker)) {
+      // Never sent, or too old to still be pending
+      _DEBUG("Marker %u is not pending", update->update_marker);
+      return 0;
+    }
     connection->waitForMarker(update->update_marker);
     _DEBUG(
       "ioctl /dev/fb0 MXCFB_WAIT_FOR_UPDATE_COMPLETE done: %f", cw.elapsed()
@@ -674,6 +685,10 @@ namespace FB {
     bool wait
   ) {
     ensure_surface();
+    if (wait && !marker) {
+      // Repaints are only acked when they have a marker
+      marker = nextMarker();
+    }
     static Blight::WaveformMode forcedWaveform =
       static_cast<Blight::WaveformMode>(Client::forcedWaveform());
     auto maybe = connection->repaint(
@@ -687,11 +702,61 @@ namespace FB {
       updateMode,
       marker
     );
-    if (wait && maybe.has_value()) {
+    if (!maybe.has_value()) {
+      return maybe;
+    }
+    if (marker) {
+      lastMarker = marker;
+    }
+    if (wait) {
       maybe.value()->wait();
     }
     return maybe;
   }
+  void postAfterMarker(unsigned int marker, const std::string& semName) {
+    static std::mutex mutex;
+    static std::condition_variable condition;
+    static std::deque<std::pair<unsigned int, std::string>> queue;
+    static std::once_flag started;
+    std::call_once(started, [] {
+      // A single worker serves every wait in order, so a client that waits
+      // after each update doesn't start a thread per wait
+      std::thread([] {
+        prctl(PR_SET_NAME, "rm2fbWait", 0, 0, 0);
+        while (true) {
+          std::unique_lock lock(mutex);
+          condition.wait(lock, [] { return !queue.empty(); });
+          auto [marker, name] = std::move(queue.front());
+          queue.pop_front();
+          lock.unlock();
+          if (marker) {
+            connection->waitForMarker(marker);
+          }
+          sem_t* sem = sem_open(name.c_str(), O_CREAT, 0644, 0);
+          if (sem != SEM_FAILED) {
+            sem_post(sem);
+            sem_close(sem);
+          }
+        }
+      }).detach();
+    });
+    {
+      std::lock_guard lock(mutex);
+      queue.emplace_back(marker, semName);
+    }
+    condition.notify_one();
+  }
+  unsigned int nextMarker() {
+    // Applications pick their own markers starting from low numbers, so use
+    // the top of the range for updates that need one but weren't given one
+    static std::atomic<unsigned int> marker = 0x80000000;
+    auto next = ++marker;
+    if (!next) {
+      marker = 0x80000000;
+      next = ++marker;
+    }
+    return next;
+  }
   Blight::WaveformMode mxcfb_to_blight_waveform(int waveform) {
     switch (waveform) {
       case 0: // INIT
@@ -1,9 +1,11 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <libblight/connection.h>
 #include <libblight/types.h>
 #include <linux/fb.h>
 #include <mxcfb.h>
+#include <string>
 
 namespace FB {
   extern Blight::shared_buf_t buffer;
@@ -14,6 +16,7 @@ namespace FB {
   extern int msgq;
   extern float visibleYRatio;
   extern float visibleXRatio;
+  extern std::atomic<unsigned int> lastMarker;
   bool init();
   bool is_fb(int fd);
   void ensure_surface();
@@ -43,6 +46,8 @@ namespace FB {
     bool wait = false
   );
   Blight::WaveformMode mxcfb_to_blight_waveform(int waveform);
+  void postAfterMarker(unsigned int marker, const std::string& semName);
+  unsigned int nextMarker();
 }
 namespace swtfb {
   enum MSG_TYPE { INIT_t = 1, UPDATE_t, XO_t, WAIT_t };
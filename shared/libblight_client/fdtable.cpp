@@ -0,0 +1,129 @@
+#include "fdtable.h"
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cerrno>
+
+// Linux's default fs.nr_open, used when the hard limit is unlimited
+static constexpr size_t MAX_FDS = 1048576;
+
+namespace Input {
+  FdTable::FdTable()
+    : m_size{0}
+    , m_eventFds{nullptr}
+    , m_inputFds{nullptr}
+    , m_count{0}
+    , m_highest{-1} {
+    static_assert(
+      std::atomic<int>::is_always_lock_free,
+      "Lookups happen inside poll and must not use locks"
+    );
+    // Use the hard limit, as the soft limit can be raised at any time
+    size_t size = MAX_FDS;
+    rlimit limit;
+    if (
+      getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_max != RLIM_INFINITY
+    ) {
+      size = std::min(size, (size_t)limit.rlim_max);
+    }
+    // Anonymous memory reads as zero and is only backed once written, so
+    // only the pages holding input fds are ever allocated
+    void* data = mmap(
+      nullptr,
+      size * sizeof(std::atomic<int>) * 2,
+      PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+      -1,
+      0
+    );
+    if (data == MAP_FAILED) {
+      return;
+    }
+    m_eventFds = static_cast<std::atomic<int>*>(data);
+    m_inputFds = m_eventFds + size;
+    m_size = size;
+  }
+
+  FdTable::~FdTable() {
+    if (m_eventFds != nullptr) {
+      munmap(m_eventFds, m_size * sizeof(std::atomic<int>) * 2);
+    }
+  }
+
+  bool FdTable::insert(int fd, int eventFd) {
+    if (
+      fd < 0 || eventFd < 0 || (size_t)fd >= m_size ||
+      (size_t)eventFd >= m_size
+    ) {
+      return false;
+    }
+    if (m_eventFds[fd].exchange(eventFd + 1, std::memory_order_release) == 0) {
+      m_count.fetch_add(1, std::memory_order_release);
+    }
+    int expected = 0;
+    m_inputFds[eventFd].compare_exchange_strong(
+      expected, fd + 1, std::memory_order_release
+    );
+    if (fd > m_highest.load(std::memory_order_relaxed)) {
+      m_highest.store(fd, std::memory_order_release);
+    }
+    return true;
+  }
+
+  void FdTable::remove(int fd, int replacement) {
+    if (fd < 0 || (size_t)fd >= m_size) {
+      return;
+    }
+    int eventFd = m_eventFds[fd].exchange(0, std::memory_order_release) - 1;
+    if (eventFd < 0) {
+      return;
+    }
+    m_count.fetch_sub(1, std::memory_order_release);
+    int expected = fd + 1;
+    m_inputFds[eventFd].compare_exchange_strong(
+      expected, replacement + 1, std::memory_order_release
+    );
+  }
+
+  bool FdTable::translate(
+    struct pollfd* fds,
+    nfds_t nfds,
+    PollBackup& backup
+  ) const {
+    if (empty()) {
+      return false;
+    }
+    const int last = highest();
+    int* original = nullptr;
+    for (nfds_t i = 0; i < nfds; i++) {
+      int fd = fds[i].fd;
+      if (fd < 0 || fd > last) {
+        continue;
+      }
+      int replacement = eventFd(fd);
+      if (replacement < 0) {
+        continue;
+      }
+      if (original == nullptr) {
+        // Only arrays that actually contain an input fd are backed up
+        original = backup.reserve(nfds);
+        if (original == nullptr) {
+          return false;
+        }
+        for (nfds_t j = 0; j < nfds; j++) {
+          original[j] = fds[j].fd;
+        }
+      }
+      fds[i].fd = replacement;
+    }
+    return original != nullptr;
+  }
+
+  void FdTable::restore(struct pollfd* fds, nfds_t nfds, PollBackup& backup) {
+    for (nfds_t i = 0; i < nfds; i++) {
+      fds[i].fd = backup.fds[i];
+    }
+  }
+}
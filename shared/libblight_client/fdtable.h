@@ -0,0 +1,121 @@
+#pragma once
+#include <poll.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+
+namespace Input {
+  /*!
+   * \brief Original fds of a translated pollfd array
+   *
+   * Kept on the stack unless the array is large.
+   */
+  class PollBackup {
+  public:
+    static constexpr nfds_t STACK_SIZE = 64;
+    PollBackup() = default;
+    ~PollBackup() {
+      if (fds != stack) {
+        free(fds);
+      }
+    }
+    PollBackup(const PollBackup&) = delete;
+    PollBackup& operator=(const PollBackup&) = delete;
+    int* reserve(nfds_t nfds) {
+      if (nfds > STACK_SIZE) {
+        fds = static_cast<int*>(malloc(sizeof(int) * nfds));
+      }
+      return fds;
+    }
+    int* fds = stack;
+
+  private:
+    int stack[STACK_SIZE];
+  };
+  /*!
+   * \brief Flat map from input fds to the eventfds that are polled in their
+   * place
+   *
+   * Entries are indexed by fd, so a lookup is a single acquire load and can
+   * be done on every poll and select without taking Input::mutex. Changes
+   * must be serialised by the caller.
+   */
+  class FdTable {
+  public:
+    FdTable();
+    ~FdTable();
+    FdTable(const FdTable&) = delete;
+    FdTable& operator=(const FdTable&) = delete;
+    /*!
+     * \brief Number of fds that can be stored
+     */
+    size_t size() const { return m_size; }
+    /*!
+     * \brief If there are no input fds open
+     */
+    bool empty() const { return m_count.load(std::memory_order_acquire) == 0; }
+    /*!
+     * \brief Highest input fd that has been stored, or -1
+     */
+    int highest() const { return m_highest.load(std::memory_order_acquire); }
+    /*!
+     * \brief Get the eventfd to poll in place of an input fd
+     * \param fd Input fd
+     * \return The eventfd, or -1 if fd is not an input fd
+     */
+    int eventFd(int fd) const {
+      if (fd < 0 || (size_t)fd >= m_size) {
+        return -1;
+      }
+      return m_eventFds[fd].load(std::memory_order_acquire) - 1;
+    }
+    /*!
+     * \brief Get an input fd that an eventfd stands in for
+     * \param eventFd Eventfd
+     * \return The input fd, or -1 if eventFd is not used by an input fd
+     */
+    int inputFd(int eventFd) const {
+      if (eventFd < 0 || (size_t)eventFd >= m_size) {
+        return -1;
+      }
+      return m_inputFds[eventFd].load(std::memory_order_acquire) - 1;
+    }
+    /*!
+     * \brief Add an input fd
+     * \param fd Input fd
+     * \param eventFd Eventfd to poll in place of fd
+     * \return If the fd fits in the table
+     */
+    bool insert(int fd, int eventFd);
+    /*!
+     * \brief Remove an input fd
+     * \param fd Input fd
+     * \param replacement Another input fd that uses the same eventfd, or -1
+     */
+    void remove(int fd, int replacement = -1);
+    /*!
+     * \brief Replace input fds in a pollfd array with their eventfds
+     * \param fds Array to translate
+     * \param nfds Number of entries in fds
+     * \param backup Where to keep the original fds
+     * \return If anything was translated and needs to be restored
+     */
+    bool translate(struct pollfd* fds, nfds_t nfds, PollBackup& backup) const;
+    /*!
+     * \brief Undo translate()
+     * \param fds Array that was translated
+     * \param nfds Number of entries in fds
+     * \param backup The original fds
+     */
+    static void restore(struct pollfd* fds, nfds_t nfds, PollBackup& backup);
+
+  private:
+    size_t m_size;
+    // Values are the fd plus one, so that untouched pages read as unused
+    std::atomic<int>* m_eventFds;
+    std::atomic<int>* m_inputFds;
+    std::atomic<int> m_count;
+    std::atomic<int> m_highest;
+  };
+}
@@ -12,10 +12,12 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <libblight/debug.h>
+#include <libblight/trace.h>
 #include <linux/input-event-codes.h>
 #include <linux/prctl.h>
 #include <map>
 #include <mutex>
+#include <span>
 #include <stdexcept>
 #include <sys/eventfd.h>
 #include <sys/ioctl.h>
@@ -45,6 +47,9 @@ static constexpr int RM1_MAX_ORIENTATION = 127;
 static constexpr int RM1_TOUCH_MAJOR = 255;
 static constexpr int RM1_TOUCH_MINOR = 255;
 
+// Maximum number of events taken from the server's buffer at once
+static constexpr size_t READ_BATCH_SIZE = 64;
+
 static constexpr float PI = 3.14159265358979323846f;
 
 #define BITS_PER_LONG (sizeof(long) * 8)
@@ -58,6 +63,8 @@ namespace Input {
   std::map<unsigned short, DeviceInfo*> devices{};
   std::map<int, std::map<int, struct epoll_event>> epollMap{};
   std::mutex mutex{};
+  // Mirrors deviceDescriptors for the calls that can't afford to lock
+  FdTable fdTable;
   Transform penTransform;
   Transform touchTransform;
 
@@ -113,9 +120,14 @@ namespace Input {
     }
     return maybe;
   }
-  void DeviceInfo::write(const input_event& event) {
-    ringBuffer->insert(event);
-    uint64_t val = 1;
+  void DeviceInfo::write(const input_event& event) { write(&event, 1); }
+  void DeviceInfo::write(const input_event* events, size_t count) {
+    auto inserted = ringBuffer->insert_range(events, count);
+    if (!inserted) {
+      return;
+    }
+    // The eventfd is a semaphore, so one write covers every event
+    uint64_t val = inserted;
     Libc::write(eventFd, &val, sizeof(val));
   }
 
@@ -130,20 +142,6 @@ namespace Input {
     return devices.at(info.device)->eventFd;
   }
 
-  int getInputFdByEventFd(int eventFd) {
-    for (auto [device, info] : devices) {
-      if (info->eventFd != eventFd) {
-        continue;
-      }
-      for (auto& [inputFd, descriptor] : deviceDescriptors) {
-        if (descriptor.device == device) {
-          return inputFd;
-        }
-      }
-    }
-    return -1;
-  }
-
   inline bool checkBitSet(int fd, int type, int i) {
     unsigned long bit[NBITS(KEY_MAX)] = {0};
     Libc::ioctl(fd, EVIOCGBIT(type, KEY_MAX), bit);
@@ -310,6 +308,17 @@ namespace Input {
         return "Invalid";
     }
   }
+  // The pen and touch screen can produce a full default sized buffer worth of
+  // events in a couple of milliseconds, so give them room for a busy client
+  unsigned int bufferCapacity(InputType type) {
+    switch (type) {
+      case Wacom:
+      case Touch:
+        return 512;
+      default:
+        return 0;
+    }
+  }
 
   bool init() {
     _DEBUG("Initializing input");
@@ -418,8 +427,12 @@ namespace Input {
       _DEBUG(
         "event%d -> event%d: %s", actualDevice, device, typeName(type).c_str()
       );
-      auto& info =
-        *new DeviceInfo(device, fd, type, Blight::open_input(actualDevice));
+      auto& info = *new DeviceInfo(
+        device,
+        fd,
+        type,
+        Blight::open_input(actualDevice, bufferCapacity(type))
+      );
       if (info.inputBuffer == nullptr) {
         _WARN("Failed to open input buffer for event%d", actualDevice);
       }
@@ -599,6 +612,185 @@ namespace Input {
     }
   }
 
+  size_t transformFrame(DeviceInfo& info, input_event* events, size_t count) {
+    auto& state = info.state;
+    std::span<input_event> frame(events, count);
+    switch (info.type) {
+      case Wacom: {
+        input_event* xEvent = nullptr;
+        input_event* yEvent = nullptr;
+        for (auto& previousEvent : frame) {
+          switch (previousEvent.type) {
+            case EV_ABS:
+              switch (previousEvent.code) {
+                case ABS_PRESSURE:
+                  state.pressure = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.pressure,
+                    info.maximums.pressure
+                  );
+                  break;
+                case ABS_DISTANCE:
+                  state.distance = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.distance,
+                    info.maximums.distance
+                  );
+                  break;
+                case ABS_TILT_X:
+                  state.tiltX = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.tiltX,
+                    info.maximums.tiltX
+                  );
+                  break;
+                case ABS_TILT_Y:
+                  state.tiltY = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.tiltY,
+                    info.maximums.tiltY
+                  );
+                  break;
+                case ABS_X:
+                  state.x = previousEvent.value;
+                  xEvent = &previousEvent;
+                  break;
+                case ABS_Y:
+                  state.y = previousEvent.value;
+                  yEvent = &previousEvent;
+                  break;
+                default:
+                  break;
+              }
+            default:
+              break;
+          }
+        }
+        if (xEvent == nullptr && yEvent == nullptr) {
+          break;
+        }
+        applyTransform(info, xEvent, yEvent);
+        _DEBUG(
+          "pen (%d,  %d) -> (%d, %d)",
+          state.x,
+          state.y,
+          xEvent == nullptr ? state.x : xEvent->value,
+          yEvent == nullptr ? state.y : yEvent->value
+        );
+        break;
+      }
+      case Touch: {
+        input_event* xEvent = nullptr;
+        input_event* yEvent = nullptr;
+        for (auto& previousEvent : frame) {
+          switch (previousEvent.type) {
+#ifdef __aarch64__
+            case EV_KEY:
+              switch (previousEvent.code) {
+                case BTN_TOUCH:
+                  state.pressure = previousEvent.value
+                                     ? info.maximums.pressure
+                                     : info.minimums.pressure;
+                  previousEvent.value =
+                    previousEvent.value ? RM1_TOUCH_PRESSURE : 0;
+                  previousEvent.type = EV_ABS;
+                  previousEvent.code = ABS_MT_PRESSURE;
+                  break;
+                default:
+                  break;
+              }
+              break;
+#endif
+            case EV_ABS:
+              switch (previousEvent.code) {
+                case ABS_MT_PRESSURE:
+                  state.pressure = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.pressure,
+                    info.maximums.pressure
+                  );
+                  break;
+                case ABS_MT_DISTANCE:
+                  state.distance = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.distance,
+                    info.maximums.distance
+                  );
+                  break;
+                case ABS_MT_ORIENTATION:
+                  state.orientation = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.orientation,
+                    info.maximums.orientation
+                  );
+                  break;
+                case ABS_MT_TOUCH_MAJOR:
+                  state.major = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.major,
+                    info.maximums.major
+                  );
+                  break;
+                case ABS_MT_TOUCH_MINOR:
+                  state.minor = previousEvent.value;
+                  previousEvent.value = scaleValue(
+                    previousEvent.value,
+                    info.minimums.minor,
+                    info.maximums.minor
+                  );
+                  break;
+                case ABS_MT_POSITION_X:
+                  state.x = previousEvent.value;
+                  xEvent = &previousEvent;
+                  break;
+                case ABS_MT_POSITION_Y:
+                  state.y = previousEvent.value;
+                  yEvent = &previousEvent;
+                  break;
+                default:
+                  break;
+              }
+              break;
+            default:
+              break;
+          }
+        }
+        if (xEvent == nullptr && yEvent == nullptr) {
+          break;
+        }
+        applyTransform(info, xEvent, yEvent);
+        _DEBUG(
+          "touch (%d, %d) -> (%d, %d)",
+          state.x,
+          state.y,
+          xEvent == nullptr ? state.x : xEvent->value,
+          yEvent == nullptr ? state.y : yEvent->value
+        );
+        break;
+      }
+      default:
+        break;
+    }
+    // Drop coordinates that couldn't be mapped, compacting the frame in
+    // place so that it can still be written in one go
+    auto end = std::remove_if(frame.begin(), frame.end(), [](auto& event) {
+      return event.type == EV_ABS &&
+             (event.code == ABS_X || event.code == ABS_Y ||
+              event.code == ABS_MT_POSITION_X ||
+              event.code == ABS_MT_POSITION_Y) &&
+             event.value == -1;
+    });
+    return end - frame.begin();
+  }
+
   void readEvents(unsigned short device) {
     char name[16];
     snprintf(name, sizeof(name), "Input[%u]", device);
@@ -610,12 +802,14 @@ namespace Input {
     CPU_SET(0, &cpuset);
     pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
     bool allow_power_button = Client::isPowerButtonEnabled();
-    std::vector<input_event> pending;
+    bool fakeRM1Input = Client::isFakeRM1Input();
     auto& info = *devices.at(device);
     auto& inputBuffer = info.inputBuffer;
-    auto& ringBuffer = info.ringBuffer;
-    auto& eventFd = info.eventFd;
-    auto& state = info.state;
+    input_event buffer[READ_BATCH_SIZE];
+    // Events that have been read, complete frames come before frameStart
+    std::vector<input_event> pending;
+    pending.reserve(READ_BATCH_SIZE * 2);
+    size_t frameStart = 0;
     _DEBUG(
       "%s reading input buffer for event%d on fd %d",
       name,
@@ -628,213 +822,59 @@ namespace Input {
         inputBuffer->read();
         info.write({.type = EV_SYN, .code = SYN_DROPPED, .value = 1});
         pending.clear();
+        frameStart = 0;
       }
-      auto maybe = inputBuffer->read(true);
-      if (!maybe.has_value()) {
+      auto count = inputBuffer->read(buffer, READ_BATCH_SIZE, true);
+      if (!count) {
         _DEBUG(
           "%s interrupted: %s", name, info.stopRequested ? "stop" : "continue"
         );
         continue;
       }
-      input_event event = maybe.value();
-      if (
-        !allow_power_button && event.type == EV_KEY && event.code == KEY_POWER
-      ) {
-        event.value = 0;
-      }
-      if (!Client::isFakeRM1Input()) {
-        info.write(event);
-        continue;
-      }
-      pending.push_back(event);
-      if (!(event.type == EV_SYN && event.code == SYN_REPORT)) {
-        continue;
-      }
-      switch (info.type) {
-        case Wacom: {
-          input_event* xEvent = nullptr;
-          input_event* yEvent = nullptr;
-          for (auto& previousEvent : pending) {
-            switch (previousEvent.type) {
-              case EV_ABS:
-                switch (previousEvent.code) {
-                  case ABS_PRESSURE:
-                    state.pressure = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.pressure,
-                      info.maximums.pressure
-                    );
-                    break;
-                  case ABS_DISTANCE:
-                    state.distance = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.distance,
-                      info.maximums.distance
-                    );
-                    break;
-                  case ABS_TILT_X:
-                    state.tiltX = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.tiltX,
-                      info.maximums.tiltX
-                    );
-                    break;
-                  case ABS_TILT_Y:
-                    state.tiltY = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.tiltY,
-                      info.maximums.tiltY
-                    );
-                    break;
-                  case ABS_X:
-                    state.x = previousEvent.value;
-                    xEvent = &previousEvent;
-                    break;
-                  case ABS_Y:
-                    state.y = previousEvent.value;
-                    yEvent = &previousEvent;
-                    break;
-                  default:
-                    break;
-                }
-              default:
-                break;
-            }
-          }
-          if (xEvent == nullptr && yEvent == nullptr) {
-            break;
-          }
-          applyTransform(info, xEvent, yEvent);
-          _DEBUG(
-            "pen (%d,  %d) -> (%d, %d)",
-            state.x,
-            state.y,
-            xEvent == nullptr ? state.x : xEvent->value,
-            yEvent == nullptr ? state.y : yEvent->value
-          );
-          break;
-        }
-        case Touch: {
-          input_event* xEvent = nullptr;
-          input_event* yEvent = nullptr;
-          for (auto& previousEvent : pending) {
-            switch (previousEvent.type) {
-#ifdef __aarch64__
-              case EV_KEY:
-                switch (previousEvent.code) {
-                  case BTN_TOUCH:
-                    state.pressure = previousEvent.value
-                                       ? info.maximums.pressure
-                                       : info.minimums.pressure;
-                    previousEvent.value =
-                      previousEvent.value ? RM1_TOUCH_PRESSURE : 0;
-                    previousEvent.type = EV_ABS;
-                    previousEvent.code = ABS_MT_PRESSURE;
-                    break;
-                  default:
-                    break;
-                }
-                break;
-#endif
-              case EV_ABS:
-                switch (previousEvent.code) {
-                  case ABS_MT_PRESSURE:
-                    state.pressure = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.pressure,
-                      info.maximums.pressure
-                    );
-                    break;
-                  case ABS_MT_DISTANCE:
-                    state.distance = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.distance,
-                      info.maximums.distance
-                    );
-                    break;
-                  case ABS_MT_ORIENTATION:
-                    state.orientation = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.orientation,
-                      info.maximums.orientation
-                    );
-                    break;
-                  case ABS_MT_TOUCH_MAJOR:
-                    state.major = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.major,
-                      info.maximums.major
-                    );
-                    break;
-                  case ABS_MT_TOUCH_MINOR:
-                    state.minor = previousEvent.value;
-                    previousEvent.value = scaleValue(
-                      previousEvent.value,
-                      info.minimums.minor,
-                      info.maximums.minor
-                    );
-                    break;
-                  case ABS_MT_POSITION_X:
-                    state.x = previousEvent.value;
-                    xEvent = &previousEvent;
-                    break;
-                  case ABS_MT_POSITION_Y:
-                    state.y = previousEvent.value;
-                    yEvent = &previousEvent;
-                    break;
-                  default:
-                    break;
-                }
-                break;
-              default:
-                break;
-            }
-          }
-          if (xEvent == nullptr && yEvent == nullptr) {
-            break;
-          }
-          applyTransform(info, xEvent, yEvent);
-          _DEBUG(
-            "touch (%d, %d) -> (%d, %d)",
-            state.x,
-            state.y,
-            xEvent == nullptr ? state.x : xEvent->value,
-            yEvent == nullptr ? state.y : yEvent->value
-          );
-          break;
-        }
-        default:
-          break;
-      }
-      for (auto& pendingEvent : pending) {
+      for (size_t i = 0; i < count; i++) {
+        auto& event = buffer[i];
         if (
-          pendingEvent.type == EV_ABS &&
-          (pendingEvent.code == ABS_X || pendingEvent.code == ABS_Y ||
-           pendingEvent.code == ABS_MT_POSITION_X ||
-           pendingEvent.code == ABS_MT_POSITION_Y) &&
-          pendingEvent.value == -1
+          !allow_power_button && event.type == EV_KEY &&
+          event.code == KEY_POWER
         ) {
+          event.value = 0;
+        }
+        pending.push_back(event);
+        bool report = event.type == EV_SYN && event.code == SYN_REPORT;
+        // A device that never sends SYN_REPORT would otherwise grow the
+        // partial frame forever, so long frames are handed over in pieces
+        if (!report && pending.size() - frameStart < READ_BATCH_SIZE) {
           continue;
         }
-        info.write(pendingEvent);
+        if (report) {
+          Blight::Trace::input(Blight::Trace::ClientRead, event.time);
+        }
+        if (fakeRM1Input) {
+          auto size = transformFrame(
+            info, pending.data() + frameStart, pending.size() - frameStart
+          );
+          pending.resize(frameStart + size);
+        }
+        frameStart = pending.size();
+      }
+      if (!fakeRM1Input) {
+        // Nothing to transform, so there is no reason to hold back a
+        // partial frame
+        frameStart = pending.size();
+      }
+      if (!frameStart) {
+        continue;
       }
-      pending.clear();
+      // Every complete frame in the batch is handed over with a single
+      // insert and wake
+      info.write(pending.data(), frameStart);
+      pending.erase(pending.begin(), pending.begin() + frameStart);
+      frameStart = 0;
     }
     _INFO("%s thread exiting", name);
   }
 
-  bool isInputFd(int fd) {
-    std::scoped_lock lock(mutex);
-    return deviceDescriptors.contains(fd);
-  }
+  bool isInputFd(int fd) { return fdTable.eventFd(fd) >= 0; }
 
   int open(const std::string& path, int flags) {
     std::string basePath(basename(path.c_str()));
@@ -860,8 +900,9 @@ namespace Input {
     }
     if (!devices.contains(device)) {
       InputType type = classify(fd);
-      auto& info =
-        *new DeviceInfo(device, fd, type, Blight::open_input(device));
+      auto& info = *new DeviceInfo(
+        device, fd, type, Blight::open_input(device, bufferCapacity(type))
+      );
       if (info.inputBuffer == nullptr) {
         _WARN(
           "Failed to open server buffer for device %d: %s",
@@ -888,7 +929,11 @@ namespace Input {
     }
     auto& info = *devices.at(device);
     if (info.ringBuffer == nullptr) {
-      info.ringBuffer = std::make_shared<Blight::EvdevRingBuffer>(true);
+      info.ringBuffer = std::make_shared<Blight::EvdevRingBuffer>(
+        true,
+        info.inputBuffer != nullptr ? info.inputBuffer->ringBuffer->capacity()
+                                    : BlightProtocol::EVDEV_RING_BUFFER_SIZE
+      );
     }
     if (info.eventFd == -1) {
       int eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC | EFD_SEMAPHORE);
@@ -904,6 +949,12 @@ namespace Input {
     }
     {
       std::scoped_lock lock{mutex};
+      if (!fdTable.insert(fd, info.eventFd)) {
+        _WARN("Input fd %d is too large to track", fd);
+        Libc::close(fd);
+        errno = EMFILE;
+        return -1;
+      }
       deviceDescriptors[fd] = {device, flags};
     }
     return fd;
@@ -927,14 +978,16 @@ namespace Input {
         }
       }
       deviceDescriptors.erase(fd);
-      if (
-        std::none_of(
-          deviceDescriptors.begin(),
-          deviceDescriptors.end(),
-          [device](const auto& entry) { return entry.second.device == device; }
-        )
-      ) {
+      auto other = std::find_if(
+        deviceDescriptors.begin(),
+        deviceDescriptors.end(),
+        [device](const auto& entry) { return entry.second.device == device; }
+      );
+      if (other == deviceDescriptors.end()) {
+        fdTable.remove(fd);
         stop = true;
+      } else {
+        fdTable.remove(fd, other->first);
       }
     }
     if (stop && devices.contains(device)) {
@@ -1294,25 +1347,12 @@ namespace Input {
     }
   }
 
-  struct pollfd* translatePollfds(struct pollfd* fds, nfds_t nfds) {
-    std::scoped_lock lock(mutex);
-    auto size = sizeof(pollfd) * nfds;
-    auto* backup = (pollfd*)malloc(size);
-    memcpy(backup, fds, size);
-    for (nfds_t i = 0; i < nfds; i++) {
-      int fd = getEventFd(fds[i].fd);
-      if (fd > 0) {
-        fds[i].fd = fd;
-      }
-    }
-    return backup;
+  bool translatePollfds(struct pollfd* fds, nfds_t nfds, PollBackup& backup) {
+    return fdTable.translate(fds, nfds, backup);
   }
 
-  void restorePollfds(struct pollfd* fds, nfds_t nfds, struct pollfd* backup) {
-    for (nfds_t i = 0; i < nfds; i++) {
-      fds[i].fd = backup[i].fd;
-    }
-    free(backup);
+  void restorePollfds(struct pollfd* fds, nfds_t nfds, PollBackup& backup) {
+    FdTable::restore(fds, nfds, backup);
   }
 
   int translateSelectFds(
@@ -1321,33 +1361,23 @@ namespace Input {
     fd_set* writefds,
     fd_set* exceptfds
   ) {
-    std::scoped_lock lock(mutex);
     int orig_nfds = nfds;
-    for (int fd = 0; fd < orig_nfds; fd++) {
-      if (readfds && FD_ISSET(fd, readfds) && deviceDescriptors.contains(fd)) {
-        FD_CLR(fd, readfds);
-        int eventFd = getEventFd(fd);
-        FD_SET(eventFd, readfds);
-        if (eventFd >= nfds) {
-          nfds = eventFd + 1;
-        }
+    if (fdTable.empty()) {
+      return orig_nfds;
+    }
+    // Input fds can't be above the highest one ever opened
+    int end = std::min(orig_nfds, fdTable.highest() + 1);
+    for (int fd = 0; fd < end; fd++) {
+      int eventFd = fdTable.eventFd(fd);
+      if (eventFd < 0) {
+        continue;
       }
-      if (
-        writefds && FD_ISSET(fd, writefds) && deviceDescriptors.contains(fd)
-      ) {
-        FD_CLR(fd, writefds);
-        int eventFd = getEventFd(fd);
-        FD_SET(eventFd, writefds);
-        if (eventFd >= nfds) {
-          nfds = eventFd + 1;
+      for (auto* set : {readfds, writefds, exceptfds}) {
+        if (set == nullptr || !FD_ISSET(fd, set)) {
+          continue;
         }
-      }
-      if (
-        exceptfds && FD_ISSET(fd, exceptfds) && deviceDescriptors.contains(fd)
-      ) {
-        FD_CLR(fd, exceptfds);
-        int eventFd = getEventFd(fd);
-        FD_SET(eventFd, exceptfds);
+        FD_CLR(fd, set);
+        FD_SET(eventFd, set);
         if (eventFd >= nfds) {
           nfds = eventFd + 1;
         }
@@ -1363,27 +1393,18 @@ namespace Input {
     fd_set* exceptfds,
     int backup
   ) {
-    std::scoped_lock lock(mutex);
+    if (fdTable.empty() && nfds == backup) {
+      return;
+    }
     for (int fd = 0; fd < nfds; fd++) {
-      if (readfds && FD_ISSET(fd, readfds)) {
-        int _fd = getInputFdByEventFd(fd);
-        if (_fd > 0) {
-          FD_CLR(fd, readfds);
-          FD_SET(_fd, readfds);
-        }
-      }
-      if (writefds && FD_ISSET(fd, writefds)) {
-        int _fd = getInputFdByEventFd(fd);
-        if (_fd > 0) {
-          FD_CLR(fd, writefds);
-          FD_SET(_fd, writefds);
-        }
+      int _fd = fdTable.inputFd(fd);
+      if (_fd < 0) {
+        continue;
       }
-      if (exceptfds && FD_ISSET(fd, exceptfds)) {
-        int _fd = getInputFdByEventFd(fd);
-        if (_fd > 0) {
-          FD_CLR(fd, exceptfds);
-          FD_SET(_fd, exceptfds);
+      for (auto* set : {readfds, writefds, exceptfds}) {
+        if (set != nullptr && FD_ISSET(fd, set)) {
+          FD_CLR(fd, set);
+          FD_SET(_fd, set);
         }
       }
     }
@@ -1437,6 +1458,10 @@ namespace Input {
   }
 
   int restoreEpollfds(int epfd, struct epoll_event* events, int res) {
+    // Closing the last input fd removes its eventfd from every epoll set
+    if (fdTable.empty()) {
+      return res;
+    }
     std::scoped_lock lock(mutex);
     if (!epollMap.contains(epfd)) {
       return res;
@@ -2,6 +2,8 @@
 #include <libblight.h>
 #include <libblight_protocol/ringbuffer.h>
 
+#include "fdtable.h"
+
 #include <atomic>
 #include <cstddef>
 #include <cstdlib>
@@ -60,6 +62,7 @@ namespace Input {
     void stop();
     std::optional<input_event> read(bool blocking = false);
     void write(const input_event& event);
+    void write(const input_event* events, size_t count);
   };
   struct DeviceMap {
     unsigned short device;
@@ -72,8 +75,8 @@ namespace Input {
   int ioctlv(int fd, unsigned long request, char* ptr);
   ssize_t read(int fd, void* buf, size_t size);
   int fcntl(int fd, int cmd, void* ptr);
-  struct pollfd* translatePollfds(struct pollfd* fds, nfds_t nfds);
-  void restorePollfds(struct pollfd* fds, nfds_t nfds, struct pollfd* backup);
+  bool translatePollfds(struct pollfd* fds, nfds_t nfds, PollBackup& backup);
+  void restorePollfds(struct pollfd* fds, nfds_t nfds, PollBackup& backup);
   int translateSelectFds(
     int& nfds,
     fd_set* readfds,
@@ -11,6 +11,7 @@ QT =
 HEADERS += \
     drm.h \
     fb.h \
+    fdtable.h \
     input.h \
     libc.h \
     qt.h \
@@ -21,6 +22,7 @@ HEADERS += \
 SOURCES += \
     drm.cpp \
     fb.cpp \
+    fdtable.cpp \
     input.cpp \
     libc.cpp \
     main.cpp \
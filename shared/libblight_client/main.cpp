@@ -200,6 +200,7 @@ msgsnd(int msqid, const void* msgp, size_t msgsz, int msgflg) {
   }
   auto buf = static_cast<const swtfb::swtfb_update*>(msgp);
   int waveform, top, left, width, height;
+  unsigned int marker = 0;
   switch (buf->mtype) {
     case swtfb::MSG_TYPE::INIT_t:
       return 0;
@@ -211,6 +212,7 @@ msgsnd(int msqid, const void* msgp, size_t msgsz, int msgflg) {
       top = region.top;
       width = region.width;
       height = region.height;
+      marker = update.update_marker;
       break;
     }
     case swtfb::MSG_TYPE::XO_t: {
@@ -223,12 +225,14 @@ msgsnd(int msqid, const void* msgp, size_t msgsz, int msgflg) {
       break;
     }
     case swtfb::MSG_TYPE::WAIT_t: {
-      Blight::waitForNoRepaints();
-      sem_t* sem = sem_open(buf->mdata.wait_update.sem_name, O_CREAT, 0644, 0);
-      if (sem != NULL) {
-        sem_post(sem);
-        sem_close(sem);
-      }
+      // rm2fb clients block on the semaphore and not on msgsnd, so wait for
+      // the last update in the background instead of stalling the caller
+      auto& wait_update = buf->mdata.wait_update;
+      std::string name(
+        wait_update.sem_name,
+        strnlen(wait_update.sem_name, sizeof(wait_update.sem_name))
+      );
+      FB::postAfterMarker(FB::lastMarker, name);
       return 0;
     }
     default:
@@ -236,6 +240,7 @@ msgsnd(int msqid, const void* msgp, size_t msgsz, int msgflg) {
   }
   FB::ensure_surface();
   _DEBUG("%s", "rm2fb ipc repaint");
+  // Every update gets a marker so that WAIT_t can wait on the last one
   FB::repaint(
     left,
     top,
@@ -244,7 +249,7 @@ msgsnd(int msqid, const void* msgp, size_t msgsz, int msgflg) {
     FB::mxcfb_to_blight_waveform(waveform),
     Blight::ContentType::Color,
     (Blight::UpdateMode)buf->mdata.update.flags,
-    0
+    marker ? marker : FB::nextMarker()
   );
   return 0;
 }
@@ -532,15 +537,14 @@ flock(int fd, int op) {
 
 __attribute__((visibility("default"))) int
 poll(struct pollfd* fds, nfds_t nfds, int timeout) {
-  struct pollfd* backup = nullptr;
-  if (Client::INITIALIZED && Client::isInputEnabled()) {
-    backup = Input::translatePollfds(fds, nfds);
-  }
+  Input::PollBackup backup;
+  bool translated = Client::INITIALIZED && Client::isInputEnabled() &&
+                    Input::translatePollfds(fds, nfds, backup);
   int res = Libc::poll(fds, nfds, timeout);
   if (res == 0 && nfds > 0 && timeout < 0) {
     _WARN("poll exited early with no revents");
   }
-  if (backup != nullptr) {
+  if (translated) {
     Input::restorePollfds(fds, nfds, backup);
   }
   return res;
@@ -554,15 +558,14 @@ ppoll(
   const struct timespec* tmo,
   const sigset_t* sigmask
 ) {
-  struct pollfd* backup = nullptr;
-  if (Client::INITIALIZED && Client::isInputEnabled()) {
-    backup = Input::translatePollfds(fds, nfds);
-  }
+  Input::PollBackup backup;
+  bool translated = Client::INITIALIZED && Client::isInputEnabled() &&
+                    Input::translatePollfds(fds, nfds, backup);
   int res = Libc::ppoll(fds, nfds, tmo, sigmask);
   if (res == 0 && nfds > 0 && tmo == nullptr) {
     _WARN("ppoll exited early with no revents");
   }
-  if (backup != nullptr) {
+  if (translated) {
     Input::restorePollfds(fds, nfds, backup);
   }
   return res;
@@ -576,15 +579,14 @@ __ppoll64(
   const struct timespec* tmo,
   const sigset_t* sigmask
 ) {
-  struct pollfd* backup = nullptr;
-  if (Client::INITIALIZED && Client::isInputEnabled()) {
-    backup = Input::translatePollfds(fds, nfds);
-  }
+  Input::PollBackup backup;
+  bool translated = Client::INITIALIZED && Client::isInputEnabled() &&
+                    Input::translatePollfds(fds, nfds, backup);
   int res = Libc::__ppoll64(fds, nfds, tmo, sigmask);
   if (res == 0 && nfds > 0 && tmo == nullptr) {
     _WARN("__ppoll64 exited early with no revents");
   }
-  if (backup != nullptr) {
+  if (translated) {
     Input::restorePollfds(fds, nfds, backup);
   }
   return res;
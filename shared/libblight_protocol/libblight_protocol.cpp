@@ -15,6 +15,7 @@
 #include <shared_mutex>
 #include <sstream>
 #include <thread>
+#include <vector>
 
 #include "_concurrentqueue.h"
 #include "_debug.h"
@@ -100,11 +101,13 @@ is_valid_header(const blight_header_t& header) {
   switch (header.type) {
     case BlightMessageType::Move:
     case BlightMessageType::Repaint:
+    case BlightMessageType::RepaintRegion:
     case BlightMessageType::Info:
     case BlightMessageType::Delete:
     case BlightMessageType::Raise:
     case BlightMessageType::Lower:
     case BlightMessageType::Wait:
+    case BlightMessageType::InkOverlay:
       return header.size > 0;
     default:
       return true;
@@ -115,6 +118,7 @@ bool
 should_ack(BlightMessageType type) {
   switch (type) {
     case BlightMessageType::Repaint:
+    case BlightMessageType::RepaintRegion:
     case BlightMessageType::Move:
     case BlightMessageType::Raise:
     case BlightMessageType::Lower:
@@ -223,23 +227,47 @@ blight_service_open(blight_bus* bus) {
 }
 blight_input_buffer_t*
 blight_service_input_open(blight_bus* bus, unsigned short device) {
+  return blight_service_input_open_with_capacity(bus, device, 0);
+}
+blight_input_buffer_t*
+blight_service_input_open_with_capacity(
+  blight_bus* bus,
+  unsigned short device,
+  unsigned int capacity
+) {
   if (!blight_service_available(bus)) {
     errno = EAGAIN;
     return nullptr;
   }
   sd_bus_error error{SD_BUS_ERROR_NULL};
   sd_bus_message* message = nullptr;
-  int res = sd_bus_call_method(
-    bus,
-    BLIGHT_SERVICE,
-    "/",
-    BLIGHT_INTERFACE,
-    "openInput",
-    &error,
-    &message,
-    "q",
-    device
-  );
+  int res;
+  if (capacity) {
+    res = sd_bus_call_method(
+      bus,
+      BLIGHT_SERVICE,
+      "/",
+      BLIGHT_INTERFACE,
+      "openInputWithCapacity",
+      &error,
+      &message,
+      "qu",
+      device,
+      capacity
+    );
+  } else {
+    res = sd_bus_call_method(
+      bus,
+      BLIGHT_SERVICE,
+      "/",
+      BLIGHT_INTERFACE,
+      "openInput",
+      &error,
+      &message,
+      "q",
+      device
+    );
+  }
   if (res < 0) {
     _WARN(
       "[blight_service_input_open::sd_bus_call_method(...)] Error: "
@@ -328,8 +356,8 @@ blight_message_from_data(blight_data_t data) {
 }
 int
 blight_message_from_socket(int fd, blight_message_t** message) {
-  auto maybe = recv(fd, sizeof(blight_header_t));
-  if (!maybe.has_value()) {
+  blight_header_t header;
+  if (!wait_for_read(fd, 250)) {
     if (errno != EAGAIN && errno != EINTR) {
       _WARN(
         "Failed to read connection message header: %s socket=%d",
@@ -339,15 +367,15 @@ blight_message_from_socket(int fd, blight_message_t** message) {
     }
     return -errno;
   }
-  auto m = new blight_message_t{
-    .header =
-      blight_header_t{
-                      .type = BlightMessageType::Invalid, .ackid = 0, .size = 0
-      },
-    .data = nullptr
-  };
-  memcpy(&m->header, maybe.value(), sizeof(blight_header_t));
-  delete[] maybe.value();
+  if (!recv_blocking(fd, (blight_data_t)&header, sizeof(blight_header_t))) {
+    _WARN(
+      "Failed to read connection message header: %s socket=%d",
+      std::strerror(errno),
+      fd
+    );
+    return -errno;
+  }
+  auto m = new blight_message_t{.header = header, .data = nullptr};
   if (!is_valid_header(m->header)) {
     _WARN(
       "Recieved invalid message from socket "
@@ -368,7 +396,7 @@ blight_message_from_socket(int fd, blight_message_t** message) {
     *message = m;
     return 0;
   }
-  maybe = recv_blocking(fd, m->header.size);
+  auto maybe = recv_blocking(fd, m->header.size);
   if (!maybe.has_value()) {
     _WARN(
       "Failed to read connection message data: %s "
@@ -472,19 +500,9 @@ blight_send_message(
     return -errno;
   }
   blight_header_t header{.type = type, .ackid = ackid, .size = size};
-  if (!send_blocking(fd, (blight_data_t)&header, sizeof(blight_header_t))) {
+  if (!send_blocking(fd, header, data)) {
     _WARN(
-      "[blight_send_message] Failed to write connection message "
-      "header: "
-      "%s",
-      std::strerror(errno)
-    );
-    return -errno;
-  }
-  if (size && !send_blocking(fd, data, size)) {
-    _WARN(
-      "[blight_send_message] Failed to write connection message "
-      "data: %s",
+      "[blight_send_message] Failed to write connection message: %s",
       std::strerror(errno)
     );
     return -errno;
@@ -655,6 +673,40 @@ blight_cast_to_repaint_packet(blight_message_t* message) {
   errno = 0;
   return (blight_packet_repaint_t*)message->data;
 }
+blight_packet_repaint_region_t*
+blight_cast_to_repaint_region_packet(blight_message_t* message) {
+  if (message == nullptr || message->header.type != RepaintRegion) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  if (message->data == nullptr) {
+    errno = ENODATA;
+    return nullptr;
+  }
+  if (message->header.size < sizeof(blight_packet_repaint_region_t)) {
+    errno = EMSGSIZE;
+    return nullptr;
+  }
+  auto packet = (blight_packet_repaint_region_t*)message->data;
+  size_t size = message->header.size - sizeof(blight_packet_repaint_region_t);
+  if (
+    size % sizeof(blight_rect_t) != 0 ||
+    size / sizeof(blight_rect_t) != packet->count
+  ) {
+    errno = EMSGSIZE;
+    return nullptr;
+  }
+  errno = 0;
+  return packet;
+}
+blight_rect_t*
+blight_packet_repaint_region_rects(blight_packet_repaint_region_t* packet) {
+  if (packet == nullptr) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  return (blight_rect_t*)(packet + 1);
+}
 blight_packet_move_t*
 blight_cast_to_move_packet(blight_message_t* message) {
   if (message == nullptr || message->header.type != Move) {
@@ -672,6 +724,23 @@ blight_cast_to_move_packet(blight_message_t* message) {
   errno = 0;
   return (blight_packet_move_t*)message->data;
 }
+blight_packet_ink_overlay_t*
+blight_cast_to_ink_overlay_packet(blight_message_t* message) {
+  if (message == nullptr || message->header.type != InkOverlay) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  if (message->data == nullptr) {
+    errno = ENODATA;
+    return nullptr;
+  }
+  if (message->header.size != sizeof(blight_packet_ink_overlay_t)) {
+    errno = EMSGSIZE;
+    return nullptr;
+  }
+  errno = 0;
+  return (blight_packet_ink_overlay_t*)message->data;
+}
 blight_packet_surface_info_t*
 blight_cast_to_surface_info_packet(blight_message_t* message) {
   if (message == nullptr || message->header.type != Info) {
@@ -706,6 +775,31 @@ blight_event_from_buffer(
   *event = new input_event(maybe.value());
   return 0;
 }
+int
+blight_events_from_buffer(
+  blight_input_buffer_t* buf,
+  struct input_event* events,
+  unsigned int max,
+  bool blocking
+) {
+  if (buf == nullptr || buf->ringBuffer == nullptr || events == nullptr) {
+    return -EINVAL;
+  }
+  auto ringBuffer = static_cast<EvdevRingBuffer*>(buf->ringBuffer);
+  size_t count = blocking ? ringBuffer->wait_for_many(events, max)
+                          : ringBuffer->take_many(events, max);
+  if (!count) {
+    return -EAGAIN;
+  }
+  return count;
+}
+unsigned int
+blight_input_buffer_dropped(blight_input_buffer_t* buf) {
+  if (buf == nullptr || buf->ringBuffer == nullptr) {
+    return 0;
+  }
+  return static_cast<EvdevRingBuffer*>(buf->ringBuffer)->dropped();
+}
 void
 blight_event_free(struct input_event* event) {
   delete event;
@@ -814,6 +908,30 @@ blight_move_surface(
   }
   return res;
 }
+int
+blight_surface_ink_overlay(
+  int fd,
+  blight_surface_id_t identifier,
+  int enabled,
+  unsigned int width,
+  unsigned int prediction
+) {
+  blight_packet_ink_overlay_t packet{
+    .identifier = identifier,
+    .enabled = enabled,
+    .width = width,
+    .prediction = prediction,
+  };
+  return blight_send_message(
+    fd,
+    BlightMessageType::InkOverlay,
+    0,
+    sizeof(blight_packet_ink_overlay_t),
+    (blight_data_t)&packet,
+    -1,
+    nullptr
+  );
+}
 }
 
 void
@@ -1132,6 +1250,53 @@ blight_surface_repaint(
   }
   return repaint.marker;
 }
+unsigned int
+blight_surface_repaint_region(
+  int fd,
+  blight_surface_id_t identifier,
+  const blight_rect_t* rects,
+  unsigned int count,
+  BlightWaveformMode waveform,
+  BlightContentType contenttype,
+  BlightUpdateMode mode
+) {
+  if (rects == nullptr || count == 0) {
+    errno = EINVAL;
+    return 0;
+  }
+  unsigned int marker = ++_marker;
+  if (marker == 0) {
+    marker = _marker = 1;
+  }
+  blight_packet_repaint_region_t repaint{
+    .waveform = waveform,
+    .contenttype = contenttype,
+    .mode = mode,
+    .marker = marker,
+    .identifier = identifier,
+    .count = count
+  };
+  size_t size = sizeof(repaint) + count * sizeof(blight_rect_t);
+  std::vector<unsigned char> data(size);
+  memcpy(data.data(), &repaint, sizeof(repaint));
+  memcpy(data.data() + sizeof(repaint), rects, count * sizeof(blight_rect_t));
+  int res = blight_send_message(
+    fd,
+    BlightMessageType::RepaintRegion,
+    0,
+    size,
+    (blight_data_t)data.data(),
+    -1,
+    nullptr
+  );
+  if (res < 0) {
+    _WARN(
+      "[blight_surface_repaint_region(...)] Error: %s", std::strerror(errno)
+    );
+    return 0;
+  }
+  return repaint.marker;
+}
 int
 blight_raise(int fd, blight_surface_id_t identifier) {
   return blight_send_message(
@@ -155,6 +155,8 @@ namespace BlightProtocol {
     Lower,
     Wait,
     Focus,
+    RepaintRegion,
+    InkOverlay,
 #ifdef __cplusplus
     MAX,
 #endif
@@ -256,6 +258,59 @@ namespace BlightProtocol {
      */
     blight_surface_id_t identifier;
   } blight_packet_repaint_t;
+  /*!
+   * \brief Rectangle on a surface
+   */
+  typedef struct blight_rect_t {
+    /*!
+     * \brief x X offset
+     */
+    int x;
+    /*!
+     * \brief y Y offset
+     */
+    int y;
+    /*!
+     * \brief width Width
+     */
+    unsigned int width;
+    /*!
+     * \brief height Height
+     */
+    unsigned int height;
+  } blight_rect_t;
+  /*!
+   * \brief Repaint region message data
+   *
+   * The message data is this header followed by count blight_rect_t
+   * \sa blight_packet_repaint_region_rects
+   */
+  typedef struct blight_packet_repaint_region_t {
+    /*!
+     * \brief waveform Waveform to use
+     */
+    BlightWaveformMode waveform;
+    /*!
+     * \brief contenttype Content type hint
+     */
+    BlightContentType contenttype;
+    /*!
+     * \brief mode Update mode to use
+     */
+    BlightUpdateMode mode;
+    /*!
+     * \brief marker Marker to use
+     */
+    unsigned int marker;
+    /*!
+     * \brief identifier Surface identifier
+     */
+    blight_surface_id_t identifier;
+    /*!
+     * \brief count Number of rectangles that follow
+     */
+    uint32_t count;
+  } blight_packet_repaint_region_t;
   /*!
    * \brief Move message data
    */
@@ -273,6 +328,28 @@ namespace BlightProtocol {
      */
     int y;
   } blight_packet_move_t;
+  /*!
+   * \brief Ink overlay message data
+   */
+  typedef struct blight_packet_ink_overlay_t {
+    /*!
+     * \brief identifier Surface identifier
+     */
+    blight_surface_id_t identifier;
+    /*!
+     * \brief enabled Non-zero to enable the overlay for the surface
+     */
+    int enabled;
+    /*!
+     * \brief width Width of the provisional ink in pixels
+     */
+    unsigned int width;
+    /*!
+     * \brief prediction How far ahead of the latest pen sample to extend the
+     * stroke, in milliseconds. 0 disables prediction.
+     */
+    unsigned int prediction;
+  } blight_packet_ink_overlay_t;
   /*!
    * \brief Surface information message data
    */
@@ -316,7 +393,11 @@ namespace BlightProtocol {
 #define blight_buf_t BlightProtocol::blight_buf_t
 #define blight_input_buffer_t BlightProtocol::blight_input_buffer_t
 #define blight_packet_repaint_t BlightProtocol::blight_packet_repaint_t
+#define blight_rect_t BlightProtocol::blight_rect_t
+#define blight_packet_repaint_region_t                                         \
+  BlightProtocol::blight_packet_repaint_region_t
 #define blight_packet_move_t BlightProtocol::blight_packet_move_t
+#define blight_packet_ink_overlay_t BlightProtocol::blight_packet_ink_overlay_t
 #define blight_packet_surface_info_t                                           \
   BlightProtocol::blight_packet_surface_info_t
 #define BlightMessageType BlightProtocol::BlightMessageType
@@ -392,6 +473,25 @@ blight_service_open(blight_bus* bus);
  */
 LIBBLIGHT_PROTOCOL_EXPORT blight_input_buffer_t*
 blight_service_input_open(blight_bus* bus, unsigned short device);
+/*!
+ * \brief blight_service_input_open_with_capacity Open a shared memory input
+ * buffer for a specific input device that can hold a specific number of events
+ * \param bus The dbus connection
+ * \param device Input event device number
+ * \param capacity Number of events the buffer should hold. Rounded up to a
+ * power of 2, 0 will use the default.
+ * \return Input buffer
+ * \note The capacity is only used if this is the first time the buffer for the
+ * device has been opened by this connection.
+ * \sa blight_service_input_open
+ * \sa blight_input_buffer_dropped
+ */
+LIBBLIGHT_PROTOCOL_EXPORT blight_input_buffer_t*
+blight_service_input_open_with_capacity(
+  blight_bus* bus,
+  unsigned short device,
+  unsigned int capacity
+);
 /*!
  * \brief blight_header_from_data Parse a buffer and return the
  * blight_header_t from it
@@ -505,6 +605,26 @@ blight_add_surface(blight_bus* bus, blight_buf_t* buf);
  */
 LIBBLIGHT_PROTOCOL_EXPORT blight_packet_repaint_t*
 blight_cast_to_repaint_packet(blight_message_t* message);
+/*!
+ * \brief blight_cast_to_repaint_region_packet Cast a blight_message_t to a
+ * blight_packet_repaint_region_t
+ * \param message Message to cast
+ * \return blight_packet_repaint_region_t on success
+ * \sa blight_packet_repaint_region_rects
+ * \sa blight_message_from_socket
+ * \sa blight_message_from_data
+ */
+LIBBLIGHT_PROTOCOL_EXPORT blight_packet_repaint_region_t*
+blight_cast_to_repaint_region_packet(blight_message_t* message);
+/*!
+ * \brief blight_packet_repaint_region_rects Get the rectangles from a
+ * blight_packet_repaint_region_t
+ * \param packet Packet to get the rectangles from
+ * \return Array of packet->count rectangles
+ * \sa blight_cast_to_repaint_region_packet
+ */
+LIBBLIGHT_PROTOCOL_EXPORT blight_rect_t*
+blight_packet_repaint_region_rects(blight_packet_repaint_region_t* packet);
 /*!
  * \brief blight_cast_to_move_packet Cast a blight_message_t to a
  * blight_packet_move_t
@@ -515,6 +635,16 @@ blight_cast_to_repaint_packet(blight_message_t* message);
  */
 LIBBLIGHT_PROTOCOL_EXPORT blight_packet_move_t*
 blight_cast_to_move_packet(blight_message_t* message);
+/*!
+ * \brief blight_cast_to_ink_overlay_packet Cast a blight_message_t to a
+ * blight_packet_ink_overlay_t
+ * \param message Message to cast
+ * \return blight_packet_ink_overlay_t instance on success
+ * \sa blight_message_from_socket
+ * \sa blight_message_from_data
+ */
+LIBBLIGHT_PROTOCOL_EXPORT blight_packet_ink_overlay_t*
+blight_cast_to_ink_overlay_packet(blight_message_t* message);
 /*!
  * \brief blight_cast_to_surface_info_packet Cast a blight_message_t to a
  * blight_packet_surface_info_t
@@ -540,6 +670,32 @@ blight_event_from_buffer(
   struct input_event** event,
   bool blocking
 );
+/*!
+ * \brief blight_events_from_buffer Read multiple input events from a shared
+ *        memory input buffer
+ * \param buf Input buffer to read from
+ * \param events Array to read the events into
+ * \param max Maximum number of events to read
+ * \param blocking If this call should block until an event is available
+ * \return Number of events read on success, -errno on failure
+ * \sa blight_service_input_open
+ */
+LIBBLIGHT_PROTOCOL_EXPORT int
+blight_events_from_buffer(
+  blight_input_buffer_t* buf,
+  struct input_event* events,
+  unsigned int max,
+  bool blocking
+);
+/*!
+ * \brief blight_input_buffer_dropped Get the number of events that have been
+ *        dropped because the input buffer was full
+ * \param buf Input buffer
+ * \return Number of dropped events
+ * \sa blight_service_input_open_with_capacity
+ */
+LIBBLIGHT_PROTOCOL_EXPORT unsigned int
+blight_input_buffer_dropped(blight_input_buffer_t* buf);
 /*!
  * \brief Free an input_event allocated by blight_event_from_buffer
  * \param event Event to free
@@ -709,6 +865,30 @@ blight_surface_repaint(
   BlightContentType contenttype,
   BlightUpdateMode mode
 );
+/*!
+ * \brief blight_surface_repaint_region Repaint multiple areas of a surface as
+ * a single update
+ * \param fd File descriptor for the connection socket
+ * \param identifier Surface identifier to repaint
+ * \param rects Areas on the surface to repaint
+ * \param count Number of areas in rects
+ * \param waveform Waveform to use when repainting
+ * \param contenttype Content type to use when repainting
+ * \param mode Update mode to use when repainting
+ * \return 0 on error otherwise the marker used for the repaint call
+ * \note Display servers older than this message type will ignore it, use
+ * blight_surface_repaint if that is a concern
+ */
+LIBBLIGHT_PROTOCOL_EXPORT unsigned int
+blight_surface_repaint_region(
+  int fd,
+  blight_surface_id_t identifier,
+  const blight_rect_t* rects,
+  unsigned int count,
+  BlightWaveformMode waveform,
+  BlightContentType contenttype,
+  BlightUpdateMode mode
+);
 /*!
  * \brief blight_raise Make a surface visible, and put it on top of the
  * stack
@@ -738,6 +918,31 @@ blight_lower(int fd, blight_surface_id_t identifier);
  */
 LIBBLIGHT_PROTOCOL_EXPORT int
 blight_focus(int fd);
+/*!
+ * \brief blight_surface_ink_overlay Enable or disable drawing provisional
+ * ink for a surface directly from pen input
+ *
+ * While enabled the display server draws pen strokes over the surface as
+ * soon as they are read from the device, without waiting for the client to
+ * repaint. The provisional ink is discarded as the client repaints the area
+ * it covers, and whatever is left is removed shortly after the pen is lifted.
+ * \param fd File descriptor for the connection socket
+ * \param identifier Surface identifier
+ * \param enabled Non-zero to enable the overlay
+ * \param width Width of the provisional ink in pixels
+ * \param prediction How far ahead of the latest pen sample to extend the
+ * stroke, in milliseconds. 0 disables prediction.
+ * \return 0 on success, negative number on failure
+ * \note Display servers older than this message type will ignore it
+ */
+LIBBLIGHT_PROTOCOL_EXPORT int
+blight_surface_ink_overlay(
+  int fd,
+  blight_surface_id_t identifier,
+  int enabled,
+  unsigned int width,
+  unsigned int prediction
+);
 #ifdef __cplusplus
 }
 #undef blight_data_t
@@ -747,7 +952,10 @@ blight_focus(int fd);
 #undef blight_buf_t
 #undef blight_input_buffer_t
 #undef blight_packet_repaint_t
+#undef blight_rect_t
+#undef blight_packet_repaint_region_t
 #undef blight_packet_move_t
+#undef blight_packet_ink_overlay_t
 #undef blight_packet_surface_info_t
 #undef BlightMessageType
 #undef BlightImageFormat
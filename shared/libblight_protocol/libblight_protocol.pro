@@ -11,6 +11,8 @@ CONFIG += no_install_prl
 SOURCES += \
     _debug.cpp \
     libblight_protocol.cpp \
+    pixel.cpp \
+    pool.cpp \
     ringbuffer.cpp \
     socket.cpp \
     vendor/fbg/src/fbgraphics.c \
@@ -21,6 +23,8 @@ HEADERS += \
     _debug.h \
     libblight_protocol.h \
     libblight_protocol_global.h \
+    pixel.h \
+    pool.h \
     ringbuffer.h \
     socket.h \
     vendor/fbg/src/fbgraphics.h \
@@ -0,0 +1,355 @@
+#include "pixel.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PIXEL_NEON
+#endif
+
+namespace {
+  inline uint32_t red(uint32_t pixel) { return (pixel >> 16) & 0xff; }
+  inline uint32_t green(uint32_t pixel) { return (pixel >> 8) & 0xff; }
+  inline uint32_t blue(uint32_t pixel) { return pixel & 0xff; }
+  inline uint32_t alpha(uint32_t pixel) { return pixel >> 24; }
+
+  // x * a / 255 rounded, matching vraddhn_u16(t, vrshrq_n_u16(t, 8))
+  inline uint32_t multiply(uint32_t x, uint32_t a) {
+    uint32_t t = x * a;
+    return (t + ((t + 128) >> 8) + 128) >> 8;
+  }
+
+  inline uint32_t over(uint32_t s, uint32_t d, uint32_t ia) {
+    return std::min<uint32_t>(s + multiply(d, ia), 255);
+  }
+
+  // Same weights as qGray()
+  inline uint32_t gray(uint32_t r, uint32_t g, uint32_t b) {
+    return (r * 11 + g * 16 + b * 5) >> 5;
+  }
+
+  inline uint16_t pack16(uint32_t r, uint32_t g, uint32_t b) {
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+  }
+
+  void scalar_to_rgb16(const uint32_t* src, uint16_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      dst[i] = pack16(red(src[i]), green(src[i]), blue(src[i]));
+    }
+  }
+
+  void scalar_to_rgb888(const uint32_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++, dst += 3) {
+      dst[0] = red(src[i]);
+      dst[1] = green(src[i]);
+      dst[2] = blue(src[i]);
+    }
+  }
+
+  void scalar_to_grayscale8(const uint32_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      dst[i] = gray(red(src[i]), green(src[i]), blue(src[i]));
+    }
+  }
+
+  void scalar_over(const uint32_t* src, uint32_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      uint32_t s = src[i];
+      uint32_t d = dst[i];
+      uint32_t ia = 255 - alpha(s);
+      dst[i] = (over(alpha(s), alpha(d), ia) << 24) |
+               (over(red(s), red(d), ia) << 16) |
+               (over(green(s), green(d), ia) << 8) | over(blue(s), blue(d), ia);
+    }
+  }
+
+  void scalar_over_rgb16(const uint32_t* src, uint16_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      uint32_t s = src[i];
+      uint32_t d = dst[i];
+      uint32_t ia = 255 - alpha(s);
+      uint32_t r = (d >> 11) & 0x1f;
+      uint32_t g = (d >> 5) & 0x3f;
+      uint32_t b = d & 0x1f;
+      r = (r << 3) | (r >> 2);
+      g = (g << 2) | (g >> 4);
+      b = (b << 3) | (b >> 2);
+      dst[i] = pack16(
+        over(red(s), r, ia), over(green(s), g, ia), over(blue(s), b, ia)
+      );
+    }
+  }
+
+  void scalar_over_rgb888(const uint32_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++, dst += 3) {
+      uint32_t s = src[i];
+      uint32_t ia = 255 - alpha(s);
+      dst[0] = over(red(s), dst[0], ia);
+      dst[1] = over(green(s), dst[1], ia);
+      dst[2] = over(blue(s), dst[2], ia);
+    }
+  }
+
+  void scalar_over_grayscale8(const uint32_t* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      uint32_t s = src[i];
+      dst[i] = over(gray(red(s), green(s), blue(s)), dst[i], 255 - alpha(s));
+    }
+  }
+
+#ifdef PIXEL_NEON
+  // vld4_u8 on little endian 0xAARRGGBB words gives b, g, r, a
+  inline uint8x8_t neon_over(uint8x8_t s, uint8x8_t d, uint8x8_t ia) {
+    uint16x8_t t = vmull_u8(d, ia);
+    return vqadd_u8(s, vraddhn_u16(t, vrshrq_n_u16(t, 8)));
+  }
+
+  inline uint8x8_t neon_gray(uint8x8x4_t px) {
+    uint16x8_t sum = vmull_u8(px.val[2], vdup_n_u8(11));
+    sum = vmlal_u8(sum, px.val[1], vdup_n_u8(16));
+    sum = vmlal_u8(sum, px.val[0], vdup_n_u8(5));
+    return vshrn_n_u16(sum, 5);
+  }
+
+  inline uint16x8_t neon_pack16(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t out = vsriq_n_u16(vshll_n_u8(r, 8), vshll_n_u8(g, 8), 5);
+    return vsriq_n_u16(out, vshll_n_u8(b, 8), 11);
+  }
+
+  void neon_to_rgb16(const uint32_t* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint8x8x4_t px = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      vst1q_u16(dst + i, neon_pack16(px.val[2], px.val[1], px.val[0]));
+    }
+    scalar_to_rgb16(src + i, dst + i, count - i);
+  }
+
+  void neon_to_rgb888(const uint32_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint8x8x4_t px = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      uint8x8x3_t out = {{px.val[2], px.val[1], px.val[0]}};
+      vst3_u8(dst + i * 3, out);
+    }
+    scalar_to_rgb888(src + i, dst + i * 3, count - i);
+  }
+
+  void neon_to_grayscale8(const uint32_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint8x8x4_t px = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      vst1_u8(dst + i, neon_gray(px));
+    }
+    scalar_to_grayscale8(src + i, dst + i, count - i);
+  }
+
+  void neon_over_argb32pm(const uint32_t* src, uint32_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      uint8x8x4_t d = vld4_u8(reinterpret_cast<uint8_t*>(dst + i));
+      uint8x8_t ia = vmvn_u8(s.val[3]);
+      for (int c = 0; c < 4; c++) {
+        d.val[c] = neon_over(s.val[c], d.val[c], ia);
+      }
+      vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+    }
+    scalar_over(src + i, dst + i, count - i);
+  }
+
+  void neon_over_rgb16(const uint32_t* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      uint16x8_t d = vld1q_u16(dst + i);
+      uint8x8_t r = vshrn_n_u16(d, 8);
+      uint8x8_t g = vshrn_n_u16(d, 3);
+      uint8x8_t b = vmovn_u16(vshlq_n_u16(d, 3));
+      r = vsri_n_u8(r, r, 5);
+      g = vsri_n_u8(g, g, 6);
+      b = vsri_n_u8(b, b, 5);
+      uint8x8_t ia = vmvn_u8(s.val[3]);
+      vst1q_u16(
+        dst + i,
+        neon_pack16(
+          neon_over(s.val[2], r, ia),
+          neon_over(s.val[1], g, ia),
+          neon_over(s.val[0], b, ia)
+        )
+      );
+    }
+    scalar_over_rgb16(src + i, dst + i, count - i);
+  }
+
+  void neon_over_rgb888(const uint32_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      uint8x8x3_t d = vld3_u8(dst + i * 3);
+      uint8x8_t ia = vmvn_u8(s.val[3]);
+      d.val[0] = neon_over(s.val[2], d.val[0], ia);
+      d.val[1] = neon_over(s.val[1], d.val[1], ia);
+      d.val[2] = neon_over(s.val[0], d.val[2], ia);
+      vst3_u8(dst + i * 3, d);
+    }
+    scalar_over_rgb888(src + i, dst + i * 3, count - i);
+  }
+
+  void neon_over_grayscale8(const uint32_t* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      uint8x8_t ia = vmvn_u8(s.val[3]);
+      vst1_u8(dst + i, neon_over(neon_gray(s), vld1_u8(dst + i), ia));
+    }
+    scalar_over_grayscale8(src + i, dst + i, count - i);
+  }
+#endif
+}
+
+namespace BlightProtocol::Pixel {
+  bool simd() {
+#ifdef PIXEL_NEON
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void argb32pm_to_rgb16(const uint32_t* src, uint16_t* dst, size_t count) {
+#ifdef PIXEL_NEON
+    neon_to_rgb16(src, dst, count);
+#else
+    scalar_to_rgb16(src, dst, count);
+#endif
+  }
+
+  void argb32pm_to_rgb888(const uint32_t* src, uint8_t* dst, size_t count) {
+#ifdef PIXEL_NEON
+    neon_to_rgb888(src, dst, count);
+#else
+    scalar_to_rgb888(src, dst, count);
+#endif
+  }
+
+  void
+  argb32pm_to_grayscale8(const uint32_t* src, uint8_t* dst, size_t count) {
+#ifdef PIXEL_NEON
+    neon_to_grayscale8(src, dst, count);
+#else
+    scalar_to_grayscale8(src, dst, count);
+#endif
+  }
+
+  void argb32pm_over(const uint32_t* src, uint32_t* dst, size_t count) {
+#ifdef PIXEL_NEON
+    neon_over_argb32pm(src, dst, count);
+#else
+    scalar_over(src, dst, count);
+#endif
+  }
+
+  void argb32pm_over_rgb16(const uint32_t* src, uint16_t* dst, size_t count) {
+#ifdef PIXEL_NEON
+    neon_over_rgb16(src, dst, count);
+#else
+    scalar_over_rgb16(src, dst, count);
+#endif
+  }
+
+  void argb32pm_over_rgb888(const uint32_t* src, uint8_t* dst, size_t count) {
+#ifdef PIXEL_NEON
+    neon_over_rgb888(src, dst, count);
+#else
+    scalar_over_rgb888(src, dst, count);
+#endif
+  }
+
+  void
+  argb32pm_over_grayscale8(const uint32_t* src, uint8_t* dst, size_t count) {
+#ifdef PIXEL_NEON
+    neon_over_grayscale8(src, dst, count);
+#else
+    scalar_over_grayscale8(src, dst, count);
+#endif
+  }
+
+  bool supported(BlightImageFormat srcFormat, BlightImageFormat dstFormat) {
+    if (
+      srcFormat != BlightImageFormat::Format_ARGB32_Premultiplied &&
+      srcFormat != BlightImageFormat::Format_RGB32
+    ) {
+      return false;
+    }
+    switch (dstFormat) {
+      case BlightImageFormat::Format_RGB32:
+      case BlightImageFormat::Format_ARGB32_Premultiplied:
+      case BlightImageFormat::Format_RGB16:
+      case BlightImageFormat::Format_RGB888:
+      case BlightImageFormat::Format_Grayscale8:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  bool blit(
+    const uint8_t* src,
+    size_t srcStride,
+    BlightImageFormat srcFormat,
+    uint8_t* dst,
+    size_t dstStride,
+    BlightImageFormat dstFormat,
+    unsigned int width,
+    unsigned int height,
+    bool blend
+  ) {
+    if (!supported(srcFormat, dstFormat)) {
+      return false;
+    }
+    // Format_RGB32 is always opaque, so blending is the same as copying
+    if (srcFormat == BlightImageFormat::Format_RGB32) {
+      blend = false;
+    }
+    for (unsigned int y = 0; y < height; y++) {
+      auto* in = reinterpret_cast<const uint32_t*>(src + y * srcStride);
+      auto* out = dst + y * dstStride;
+      switch (dstFormat) {
+        case BlightImageFormat::Format_RGB32:
+        case BlightImageFormat::Format_ARGB32_Premultiplied:
+          if (blend) {
+            argb32pm_over(in, reinterpret_cast<uint32_t*>(out), width);
+          } else {
+            memcpy(out, in, width * sizeof(uint32_t));
+          }
+          break;
+        case BlightImageFormat::Format_RGB16:
+          if (blend) {
+            argb32pm_over_rgb16(in, reinterpret_cast<uint16_t*>(out), width);
+          } else {
+            argb32pm_to_rgb16(in, reinterpret_cast<uint16_t*>(out), width);
+          }
+          break;
+        case BlightImageFormat::Format_RGB888:
+          if (blend) {
+            argb32pm_over_rgb888(in, out, width);
+          } else {
+            argb32pm_to_rgb888(in, out, width);
+          }
+          break;
+        case BlightImageFormat::Format_Grayscale8:
+          if (blend) {
+            argb32pm_over_grayscale8(in, out, width);
+          } else {
+            argb32pm_to_grayscale8(in, out, width);
+          }
+          break;
+        default:
+          return false;
+      }
+    }
+    return true;
+  }
+}
@@ -0,0 +1,119 @@
+/*!
+ * \addtogroup BlightProtocol
+ * @{
+ * \file
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "libblight_protocol.h"
+
+namespace BlightProtocol {
+  /*!
+   * \brief Pixel kernels used to compose surfaces
+   *
+   * All of the kernels work on a single row of \p count pixels. Sources are
+   * Format_ARGB32_Premultiplied, stored as native endian 0xAARRGGBB words.
+   * When built with NEON support the kernels are vectorized, otherwise a
+   * portable scalar version is used. Both produce identical output.
+   */
+  namespace Pixel {
+    /*!
+     * \brief If the vectorized kernels are in use
+     * \return true if NEON is being used
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT bool simd();
+    /*!
+     * \brief Convert to Format_RGB16, dropping the alpha channel
+     * \param src Source pixels
+     * \param dst Destination pixels
+     * \param count Number of pixels
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void
+    argb32pm_to_rgb16(const uint32_t* src, uint16_t* dst, size_t count);
+    /*!
+     * \brief Convert to Format_RGB888, dropping the alpha channel
+     * \param src Source pixels
+     * \param dst Destination pixels, 3 bytes per pixel
+     * \param count Number of pixels
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void
+    argb32pm_to_rgb888(const uint32_t* src, uint8_t* dst, size_t count);
+    /*!
+     * \brief Convert to Format_Grayscale8, dropping the alpha channel
+     * \param src Source pixels
+     * \param dst Destination pixels
+     * \param count Number of pixels
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void
+    argb32pm_to_grayscale8(const uint32_t* src, uint8_t* dst, size_t count);
+    /*!
+     * \brief Source-over blend onto Format_ARGB32_Premultiplied or
+     *        Format_RGB32 pixels
+     * \param src Source pixels
+     * \param dst Destination pixels
+     * \param count Number of pixels
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void
+    argb32pm_over(const uint32_t* src, uint32_t* dst, size_t count);
+    /*!
+     * \brief Source-over blend onto Format_RGB16 pixels
+     * \param src Source pixels
+     * \param dst Destination pixels
+     * \param count Number of pixels
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void
+    argb32pm_over_rgb16(const uint32_t* src, uint16_t* dst, size_t count);
+    /*!
+     * \brief Source-over blend onto Format_RGB888 pixels
+     * \param src Source pixels
+     * \param dst Destination pixels, 3 bytes per pixel
+     * \param count Number of pixels
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void
+    argb32pm_over_rgb888(const uint32_t* src, uint8_t* dst, size_t count);
+    /*!
+     * \brief Source-over blend onto Format_Grayscale8 pixels
+     * \param src Source pixels
+     * \param dst Destination pixels
+     * \param count Number of pixels
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void
+    argb32pm_over_grayscale8(const uint32_t* src, uint8_t* dst, size_t count);
+    /*!
+     * \brief Check if blit() supports a pair of formats
+     * \param srcFormat Source image format
+     * \param dstFormat Destination image format
+     * \return If the formats are supported
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT bool
+    supported(BlightImageFormat srcFormat, BlightImageFormat dstFormat);
+    /*!
+     * \brief Copy or blend a rectangle of pixels between two images
+     * \param src First pixel of the source rectangle
+     * \param srcStride Bytes per line of the source image
+     * \param srcFormat Format of the source image
+     * \param dst First pixel of the destination rectangle
+     * \param dstStride Bytes per line of the destination image
+     * \param dstFormat Format of the destination image
+     * \param width Width of the rectangle in pixels
+     * \param height Height of the rectangle in pixels
+     * \param blend Source-over blend instead of copying
+     * \return false if the formats are not supported
+     * \sa supported
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT bool blit(
+      const uint8_t* src,
+      size_t srcStride,
+      BlightImageFormat srcFormat,
+      uint8_t* dst,
+      size_t dstStride,
+      BlightImageFormat dstFormat,
+      unsigned int width,
+      unsigned int height,
+      bool blend
+    );
+  }
+}
+/*! @} */
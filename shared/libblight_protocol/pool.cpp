@@ -0,0 +1,67 @@
+#include "pool.h"
+
+#include <mutex>
+
+using namespace BlightProtocol::Pool;
+
+namespace {
+  union block_t {
+    block_t* next;
+    alignas(std::max_align_t) unsigned char data[block_size];
+  };
+
+  // Blocks are handed out in order the first time, and then recycled through
+  // the free list. This avoids having to touch the whole slab on startup.
+  block_t slab[block_count];
+  block_t* freeList = nullptr;
+  size_t used = 0;
+  size_t freeCount = block_count;
+  std::mutex mutex;
+}
+
+namespace BlightProtocol {
+  namespace Pool {
+    void* allocate(size_t size) {
+      if (size <= block_size) {
+        std::lock_guard lock(mutex);
+        block_t* block = nullptr;
+        if (freeList != nullptr) {
+          block = freeList;
+          freeList = block->next;
+        } else if (used < block_count) {
+          block = &slab[used++];
+        }
+        if (block != nullptr) {
+          freeCount--;
+          return block;
+        }
+      }
+      return ::operator new(size);
+    }
+
+    void deallocate(void* ptr) {
+      if (ptr == nullptr) {
+        return;
+      }
+      if (!owns(ptr)) {
+        ::operator delete(ptr);
+        return;
+      }
+      auto block = static_cast<block_t*>(ptr);
+      std::lock_guard lock(mutex);
+      block->next = freeList;
+      freeList = block;
+      freeCount++;
+    }
+
+    bool owns(const void* ptr) {
+      auto address = static_cast<const block_t*>(ptr);
+      return address >= slab && address < slab + block_count;
+    }
+
+    size_t available() {
+      std::lock_guard lock(mutex);
+      return freeCount;
+    }
+  }
+}
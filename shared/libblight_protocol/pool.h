@@ -0,0 +1,88 @@
+/*!
+ * \addtogroup BlightProtocol
+ * @{
+ * \file
+ */
+#pragma once
+#include <cstddef>
+#include <new>
+
+#include "libblight_protocol_global.h"
+
+namespace BlightProtocol {
+  /*!
+   * \brief Slab pool for small, short lived message allocations
+   *
+   * Messages, acks and their payloads are mostly a few dozen bytes and are
+   * freed shortly after they are created. The pool hands out fixed size
+   * blocks from a static slab, and falls back to the heap when the request is
+   * too large or the slab is exhausted.
+   */
+  namespace Pool {
+    /*!
+     * \brief Size of a single block in the slab
+     */
+    constexpr size_t block_size = 64;
+    /*!
+     * \brief Number of blocks in the slab
+     */
+    constexpr size_t block_count = 256;
+    /*!
+     * \brief Allocate memory from the pool
+     * \param size Number of bytes to allocate
+     * \return The allocated memory
+     * \throws std::bad_alloc If the memory could not be allocated
+     * \note The memory must be freed with deallocate()
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void* allocate(size_t size);
+    /*!
+     * \brief Free memory returned by allocate()
+     * \param ptr Memory to free, may be nullptr
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT void deallocate(void* ptr);
+    /*!
+     * \brief Check if memory belongs to the slab
+     * \param ptr Memory to check
+     * \return If the memory is a slab block
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT bool owns(const void* ptr);
+    /*!
+     * \brief Number of slab blocks that are currently free
+     * \return The number of free blocks
+     */
+    LIBBLIGHT_PROTOCOL_EXPORT size_t available();
+    /*!
+     * \brief Deleter that returns memory to the pool
+     */
+    struct Deleter {
+      void operator()(void* ptr) const { deallocate(ptr); }
+    };
+    /*!
+     * \brief Allocator that uses the pool, for use with std::allocate_shared
+     */
+    template<typename T>
+    struct Allocator {
+      typedef T value_type;
+      Allocator() noexcept = default;
+      template<typename U>
+      Allocator(const Allocator<U>&) noexcept {}
+      static_assert(
+        alignof(T) <= alignof(std::max_align_t),
+        "Pool blocks are only aligned to std::max_align_t"
+      );
+      T* allocate(size_t n) {
+        return static_cast<T*>(Pool::allocate(n * sizeof(T)));
+      }
+      void deallocate(T* ptr, size_t) noexcept { Pool::deallocate(ptr); }
+      template<typename U>
+      bool operator==(const Allocator<U>&) const noexcept {
+        return true;
+      }
+      template<typename U>
+      bool operator!=(const Allocator<U>&) const noexcept {
+        return false;
+      }
+    };
+  }
+}
+/*! @} */
@@ -51,16 +51,16 @@ namespace BlightProtocol {
     );
   }
 
-  bool RingBufferBase::full(uint32_t size) {
+  bool RingBufferBase::full() {
     uint32_t h = head.load(std::memory_order_relaxed);
     uint32_t t = tail.load(std::memory_order_acquire);
-    return h - t >= size;
+    return h - t >= slots;
   }
 
-  bool RingBufferBase::wait_for_space(uint32_t size, int timeout) {
+  bool RingBufferBase::wait_for_space(int timeout) {
     uint32_t h = head.load(std::memory_order_relaxed);
     uint32_t t = tail.load(std::memory_order_acquire);
-    while (h - t >= size) {
+    while (h - t >= slots) {
       if (tail_interrupted.exchange(false)) {
         return false;
       }
@@ -74,13 +74,15 @@ namespace BlightProtocol {
     return true;
   }
 
-  uint32_t RingBufferBase::reserveHead(uint32_t size) {
+  std::optional<uint32_t> RingBufferBase::reserveHead(uint32_t count) {
     uint32_t h = head.load(std::memory_order_relaxed);
     uint32_t t = tail.load(std::memory_order_acquire);
-    while (h - t >= size) {
+    while (slots - (h - t) < count) {
       if (allow_overflow) {
+        // Only the consumer may move the tail, so drop the new values instead
+        // of overwriting ones that may be in the middle of being read
         overflow.store(1, std::memory_order_release);
-        break;
+        return {};
       }
       // Do not handle interrupts, the producer is responsible for draining if
       // allow_overflow==false
@@ -90,8 +92,8 @@ namespace BlightProtocol {
     return h;
   }
 
-  void RingBufferBase::commitHead(uint32_t headIndex) {
-    head.store(headIndex + 1, std::memory_order_release);
+  void RingBufferBase::commitHead(uint32_t headIndex, uint32_t count) {
+    head.store(headIndex + count, std::memory_order_release);
     futex_wake(head);
   }
 
@@ -129,9 +131,9 @@ namespace BlightProtocol {
     return t;
   }
 
-  void RingBufferBase::releaseTail(uint32_t tailIndex) {
+  void RingBufferBase::releaseTail(uint32_t tailIndex, uint32_t count) {
     overflow.exchange(0, std::memory_order_acq_rel);
-    tail.store(tailIndex + 1, std::memory_order_release);
+    tail.store(tailIndex + count, std::memory_order_release);
     futex_wake(tail);
   }
 
@@ -151,6 +153,12 @@ namespace BlightProtocol {
     return static_cast<size_t>(h - t);
   }
 
+  size_t RingBufferBase::capacity() const noexcept { return slots; }
+
+  uint32_t RingBufferBase::dropped() const noexcept {
+    return drops.load(std::memory_order_relaxed);
+  }
+
   int RingBufferBase::createSharedMemoryInstance(
     size_t size,
     const char* name,
@@ -200,5 +208,5 @@ namespace BlightProtocol {
   }
 
   template class LIBBLIGHT_PROTOCOL_EXPORT
-    RingBuffer<input_event, EVDEV_RING_BUFFER_SIZE>;
+    RingBuffer<input_event, EVDEV_RING_BUFFER_MAX_SIZE>;
 }
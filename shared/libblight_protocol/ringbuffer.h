@@ -1,5 +1,5 @@
 #pragma once
-#include <array>
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <cstdio>
@@ -35,17 +35,23 @@ namespace BlightProtocol {
     alignas(64) AtomicWord head;
     alignas(64) AtomicWord tail;
     alignas(64) AtomicWord overflow;
+    AtomicWord drops;
     std::atomic<bool> head_interrupted;
     std::atomic<bool> tail_interrupted;
     bool allow_overflow;
+    // Number of usable slots, always a power of 2. Set once by the creator
+    // and never modified, so it can be read without synchronization.
+    uint32_t slots;
 
-    RingBufferBase(bool allow_overflow) noexcept
+    RingBufferBase(bool allow_overflow, uint32_t slots) noexcept
       : head{0}
       , tail{0}
       , overflow{0}
+      , drops{0}
       , head_interrupted{false}
       , tail_interrupted{false}
-      , allow_overflow{allow_overflow} {}
+      , allow_overflow{allow_overflow}
+      , slots{slots} {}
 
     static bool
     futex_wait(AtomicWord& word, uint32_t expected, int timeout = 0) noexcept;
@@ -59,39 +65,102 @@ namespace BlightProtocol {
     static void* mapSharedMemoryInstance(int fd, size_t size);
     static void unmapSharedMemoryInstance(void* mem, size_t size);
 
-    bool full(uint32_t size);
-    bool wait_for_space(uint32_t size, int timeout = 0);
-    uint32_t reserveHead(uint32_t size);
-    void commitHead(uint32_t headIndex);
+    std::optional<uint32_t> reserveHead(uint32_t count);
+    void commitHead(uint32_t headIndex, uint32_t count = 1);
     std::optional<uint32_t> tryConsume();
     std::optional<uint32_t> waitForTail(int timeout = 0);
     std::optional<uint32_t> peekTail();
-    void releaseTail(uint32_t tailIndex);
+    void releaseTail(uint32_t tailIndex, uint32_t count = 1);
 
   public:
     bool empty();
+    bool full();
     bool overflowed();
     size_t size();
+    /*!
+     * \brief Number of values the buffer can hold
+     */
+    size_t capacity() const noexcept;
+    /*!
+     * \brief Total number of values that have been dropped because the buffer
+     * was full
+     */
+    uint32_t dropped() const noexcept;
+    bool wait_for_space(int timeout = 0);
     void interrupt() noexcept;
   };
 
+  /*!
+   * \brief Single producer, single consumer ring buffer that can be placed in
+   * shared memory
+   *
+   * \p Size is the size of the storage, the number of slots that are actually
+   * used can be lowered per instance. Pages of storage that are never used are
+   * never touched, so a shared memory buffer only costs what its capacity
+   * needs.
+   */
   template<typename T, size_t Size>
   class RingBuffer : public RingBufferBase {
     static_assert(
       (Size & (Size - 1)) == 0,
       "RingBuffer size must be a power of 2 for lock-free operation"
     );
-    static constexpr size_t MASK = Size - 1;
+    static_assert(
+      std::is_trivially_copyable_v<T>,
+      "RingBuffer values must be trivially copyable"
+    );
 
   public:
-    RingBuffer(bool allow_overflow = false) noexcept
-      : RingBufferBase{allow_overflow}
-      , values{} {}
-
-    void insert(const T& event) {
-      uint32_t h = reserveHead(Size);
-      values[h & MASK] = event;
-      commitHead(h);
+    /*!
+     * \brief Round a requested capacity to one the buffer can use
+     * \param capacity Requested capacity, 0 for the maximum
+     * \return The next power of 2, clamped to \p Size
+     */
+    static constexpr uint32_t normalize(size_t capacity) noexcept {
+      if (!capacity || capacity >= Size) {
+        return Size;
+      }
+      uint32_t slots = 1;
+      while (slots < capacity) {
+        slots <<= 1;
+      }
+      return slots;
+    }
+
+    // Storage is intentionally left uninitialized so that shared memory pages
+    // are only touched once they are used.
+    RingBuffer(bool allow_overflow = false, size_t capacity = Size) noexcept
+      : RingBufferBase{allow_overflow, normalize(capacity)} {}
+
+    void insert(const T& event) { insert_range(&event, 1); }
+
+    /*!
+     * \brief Insert multiple values, publishing them all at once
+     *
+     * Values are published in chunks of up to capacity() values with a single
+     * store and wake, and the consumer will see all of a chunk or none of it.
+     * If overflow is allowed and a chunk does not fit, it and the remaining
+     * values are dropped and counted in dropped().
+     * \param events Values to insert
+     * \param count Number of values
+     * \return Number of values inserted
+     */
+    size_t insert_range(const T* events, size_t count) {
+      size_t inserted = 0;
+      while (inserted < count) {
+        uint32_t chunk = std::min<size_t>(count - inserted, slots);
+        auto h = reserveHead(chunk);
+        if (!h.has_value()) {
+          drops.fetch_add(count - inserted, std::memory_order_relaxed);
+          break;
+        }
+        for (uint32_t i = 0; i < chunk; i++) {
+          values[(h.value() + i) & mask()] = events[inserted + i];
+        }
+        commitHead(h.value(), chunk);
+        inserted += chunk;
+      }
+      return inserted;
     }
 
     std::optional<T> take() {
@@ -99,35 +168,59 @@ namespace BlightProtocol {
       if (!t.has_value()) {
         return {};
       }
-      T event = values[t.value() & MASK];
+      T event = values[t.value() & mask()];
       releaseTail(t.value());
       return {event};
     }
 
+    /*!
+     * \brief Take up to \p max values, releasing them all at once
+     * \param events Where to store the values
+     * \param max Maximum number of values to take
+     * \return Number of values taken
+     */
+    size_t take_many(T* events, size_t max) {
+      std::optional<uint32_t> t = tryConsume();
+      if (!t.has_value()) {
+        return 0;
+      }
+      return consume(t.value(), events, max);
+    }
+
     std::optional<T> wait_for_values(int timeout = 0) {
       auto t = waitForTail(timeout);
       if (!t.has_value()) {
         return {};
       }
-      T event = values[t.value() & MASK];
+      T event = values[t.value() & mask()];
       releaseTail(t.value());
       return {event};
     }
 
-    bool wait_for_space(int timeout = 0) {
-      return RingBufferBase::wait_for_space(Size, timeout);
+    /*!
+     * \brief Wait for values and take up to \p max of them
+     * \param events Where to store the values
+     * \param max Maximum number of values to take
+     * \param timeout How long to wait in milliseconds, 0 to wait forever
+     * \return Number of values taken
+     */
+    size_t wait_for_many(T* events, size_t max, int timeout = 0) {
+      auto t = waitForTail(timeout);
+      if (!t.has_value()) {
+        return 0;
+      }
+      return consume(t.value(), events, max);
     }
 
-    bool full() { return RingBufferBase::full(Size); }
-
     std::optional<T> next() {
       auto t = peekTail();
-      return t.has_value() ? std::optional<T>(values[t.value() & MASK])
+      return t.has_value() ? std::optional<T>(values[t.value() & mask()])
                            : std::nullopt;
     }
 
     static std::pair<int, RingBuffer<T, Size>*> createSharedMemory(
-      bool allow_overflow = false
+      bool allow_overflow = false,
+      size_t capacity = Size
     ) {
       char name[64];
       std::snprintf(name, sizeof(name), "RingBuffer<%zu,%zu>", sizeof(T), Size);
@@ -137,7 +230,7 @@ namespace BlightProtocol {
       if (fd < 0) {
         return {-1, nullptr};
       }
-      return {fd, new (mem) RingBuffer<T, Size>(allow_overflow)};
+      return {fd, new (mem) RingBuffer<T, Size>(allow_overflow, capacity)};
     }
 
     static RingBuffer<T, Size>* fromSharedMemory(int fd) {
@@ -147,11 +240,34 @@ namespace BlightProtocol {
     }
 
   private:
-    std::array<T, Size> values;
+    T values[Size];
+
+    // Masking with Size as well keeps a corrupt slot count in shared memory
+    // from indexing outside of the storage
+    uint32_t mask() const noexcept { return (slots - 1) & (Size - 1); }
+
+    size_t consume(uint32_t t, T* events, size_t max) {
+      uint32_t available = head.load(std::memory_order_acquire) - t;
+      uint32_t count = std::min<size_t>(available, max);
+      for (uint32_t i = 0; i < count; i++) {
+        events[i] = values[(t + i) & mask()];
+      }
+      if (count) {
+        releaseTail(t, count);
+      }
+      return count;
+    }
   };
 
+  /*!
+   * \brief Default capacity of an input event buffer
+   */
   constexpr size_t EVDEV_RING_BUFFER_SIZE = 64;
-  using EvdevRingBuffer = RingBuffer<input_event, EVDEV_RING_BUFFER_SIZE>;
+  /*!
+   * \brief Largest capacity an input event buffer can be opened with
+   */
+  constexpr size_t EVDEV_RING_BUFFER_MAX_SIZE = 1024;
+  using EvdevRingBuffer = RingBuffer<input_event, EVDEV_RING_BUFFER_MAX_SIZE>;
   extern template class LIBBLIGHT_PROTOCOL_EXPORT
-    RingBuffer<input_event, EVDEV_RING_BUFFER_SIZE>;
+    RingBuffer<input_event, EVDEV_RING_BUFFER_MAX_SIZE>;
 }
@@ -1,10 +1,15 @@
 #include "socket.h"
 
+#include <algorithm>
 #include <cerrno>
+#include <cstring>
 #include <sys/poll.h>
 #include <sys/socket.h>
 
 #include "_debug.h"
+#include "pool.h"
+
+bool is_valid_header(const BlightProtocol::blight_header_t& header);
 
 void
 short_pause() {
@@ -112,10 +117,18 @@ namespace BlightProtocol {
       errno = ENOMEM;
       return {};
     }
+    if (!recv_blocking(fd, data, size)) {
+      delete[] data;
+      return {};
+    }
+    return data;
+  }
+
+  bool recv_blocking(int fd, blight_data_t data, ssize_t size) {
     ssize_t res = -1;
     ssize_t total = 0;
     while (total < size) {
-      res = ::recv(fd, data, size, MSG_WAITALL);
+      res = ::recv(fd, data + total, size - total, MSG_WAITALL);
       // connection was closed
       if (res == 0) {
         break;
@@ -127,20 +140,18 @@ namespace BlightProtocol {
       }
       // We had an unexpected error
       if (errno != EAGAIN && errno != EINTR) {
-        delete[] data;
-        return {};
+        return false;
       }
       // Temporary error, try again
       short_pause();
     }
     // The data we recieved isn't the same size as what we expected
     if (total != size) {
-      _WARN("recv_blocking %d != %d", size, res);
-      delete[] data;
+      _WARN("recv_blocking %d != %d", size, total);
       errno = EBADMSG;
-      return {};
+      return false;
     }
-    return data;
+    return true;
   }
 
   bool send_blocking(int fd, const blight_data_t data, ssize_t size) {
@@ -168,6 +179,186 @@ namespace BlightProtocol {
     }
     return true;
   }
+
+  bool send_blocking(int fd, iovec* iov, int count) {
+    msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    while (msg.msg_iovlen > 0) {
+      // Skip anything that has already been sent
+      if (!msg.msg_iov->iov_len) {
+        msg.msg_iov++;
+        msg.msg_iovlen--;
+        continue;
+      }
+      ssize_t res = ::sendmsg(fd, &msg, MSG_EOR | MSG_NOSIGNAL);
+      if (res < 0) {
+        // We had an unexpected error
+        if (errno != EAGAIN && errno != EINTR) {
+          return false;
+        }
+        // Temporary error, try again
+        short_pause();
+        continue;
+      }
+      // Advance past what was sent
+      while (res > 0 && msg.msg_iovlen > 0) {
+        size_t sent = std::min<size_t>(res, msg.msg_iov->iov_len);
+        msg.msg_iov->iov_base = (unsigned char*)msg.msg_iov->iov_base + sent;
+        msg.msg_iov->iov_len -= sent;
+        res -= sent;
+        if (!msg.msg_iov->iov_len) {
+          msg.msg_iov++;
+          msg.msg_iovlen--;
+        }
+      }
+    }
+    return true;
+  }
+
+  bool send_blocking(
+    int fd,
+    const blight_header_t& header,
+    const blight_data_t data
+  ) {
+    if (header.size && data == nullptr) {
+      _WARN("send_blocking data missing when size is not zero");
+      errno = EINVAL;
+      return false;
+    }
+    iovec iov[2];
+    iov[0].iov_base = (void*)&header;
+    iov[0].iov_len = sizeof(blight_header_t);
+    iov[1].iov_base = data;
+    iov[1].iov_len = header.size;
+    return send_blocking(fd, iov, 2);
+  }
+
+  MessageReader::MessageReader(int fd, size_t capacity)
+    : m_fd{fd}
+    , m_buffer{new unsigned char[capacity]}
+    , m_capacity{capacity}
+    , m_head{0}
+    , m_tail{0} {}
+
+  MessageReader::~MessageReader() { delete[] m_buffer; }
+
+  int MessageReader::fd() const { return m_fd; }
+
+  size_t MessageReader::buffered() const { return m_tail - m_head; }
+
+  int MessageReader::next(
+    blight_header_t* header,
+    blight_data_t* data,
+    int timeout
+  ) {
+    *data = nullptr;
+    while (true) {
+      size_t available = m_tail - m_head;
+      if (available >= sizeof(blight_header_t)) {
+        memcpy(header, &m_buffer[m_head], sizeof(blight_header_t));
+        if (!is_valid_header(*header)) {
+          _WARN(
+            "Recieved invalid message from socket "
+            "socket=%d, "
+            "ackid=%u, "
+            "type=%d, "
+            "size=%ld",
+            m_fd,
+            header->ackid,
+            header->type,
+            (long int)header->size
+          );
+          // There is no way to find the start of the next message
+          m_head = m_tail = 0;
+          errno = EBADMSG;
+          return -errno;
+        }
+        size_t size = header->size;
+        size_t buffered = available - sizeof(blight_header_t);
+        if (size && (buffered >= size || size > m_capacity / 2)) {
+          try {
+            *data = static_cast<blight_data_t>(Pool::allocate(size));
+          } catch (std::bad_alloc&) {
+            _WARN(
+              "[BlightProtocol::MessageReader::next(%d)] Not enough memory to "
+              "recieve",
+              m_fd
+            );
+            errno = ENOMEM;
+            return -errno;
+          }
+        }
+        if (buffered >= size) {
+          if (size) {
+            memcpy(*data, &m_buffer[m_head + sizeof(blight_header_t)], size);
+          }
+          m_head += sizeof(blight_header_t) + size;
+          if (m_head == m_tail) {
+            m_head = m_tail = 0;
+          }
+          return 0;
+        }
+        // Large payloads skip the buffer and are read directly
+        if (*data != nullptr) {
+          memcpy(*data, &m_buffer[m_head + sizeof(blight_header_t)], buffered);
+          m_head = m_tail = 0;
+          if (!recv_blocking(m_fd, *data + buffered, size - buffered)) {
+            _WARN(
+              "Failed to read connection message data: %s "
+              "socket=%d, "
+              "ackid=%u, "
+              "type=%d, "
+              "size=%ld",
+              std::strerror(errno),
+              m_fd,
+              header->ackid,
+              header->type,
+              (long int)header->size
+            );
+            int error = errno;
+            Pool::deallocate(*data);
+            *data = nullptr;
+            errno = error;
+            return -errno;
+          }
+          return 0;
+        }
+      }
+      // The rest of a partial message is already on its way
+      if (available) {
+        timeout = -1;
+      }
+      // Make room for the rest of the message
+      if (m_head && (m_tail == m_capacity || available < m_capacity / 2)) {
+        memmove(m_buffer, &m_buffer[m_head], available);
+        m_head = 0;
+        m_tail = available;
+      }
+      if (timeout && !wait_for_read(m_fd, timeout)) {
+        return -errno;
+      }
+      ssize_t res =
+        ::recv(m_fd, &m_buffer[m_tail], m_capacity - m_tail, MSG_DONTWAIT);
+      // connection was closed
+      if (res == 0) {
+        errno = ECONNRESET;
+        return -errno;
+      }
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno == EAGAIN && available) {
+          continue;
+        }
+        return -errno;
+      }
+      m_tail += res;
+      timeout = 0;
+    }
+  }
+
   namespace {
     bool wait_for(int fd, int timeout, int event) {
       int remaining = timeout;
@@ -8,6 +8,7 @@
 
 #ifdef __cplusplus
 #include <optional>
+#include <sys/uio.h>
 
 namespace BlightProtocol {
   /*!
@@ -36,6 +37,15 @@ namespace BlightProtocol {
    */
   LIBBLIGHT_PROTOCOL_EXPORT std::optional<blight_data_t>
   recv_blocking(int fd, ssize_t size);
+  /*!
+   * \brief receive data from a socket into an existing buffer
+   * \param fd The socket.
+   * \param data Buffer to receive into, at least \p size bytes long.
+   * \param size Size of the data to receive
+   * \return If the data was received without error.
+   */
+  LIBBLIGHT_PROTOCOL_EXPORT bool
+  recv_blocking(int fd, blight_data_t data, ssize_t size);
   /*!
    * \brief Send data to a socket.
    * \param fd The socket
@@ -45,6 +55,26 @@ namespace BlightProtocol {
    */
   LIBBLIGHT_PROTOCOL_EXPORT bool
   send_blocking(int fd, const blight_data_t data, ssize_t size);
+  /*!
+   * \brief Send multiple buffers to a socket with a single sendmsg call.
+   * \param fd The socket
+   * \param iov The buffers to send. Modified to track partial writes.
+   * \param count Number of buffers.
+   * \return If all of the data was sent without error.
+   */
+  LIBBLIGHT_PROTOCOL_EXPORT bool send_blocking(int fd, iovec* iov, int count);
+  /*!
+   * \brief Send a message header and its data to a socket.
+   * \param fd The socket
+   * \param header The message header.
+   * \param data The message data, \c header.size bytes long.
+   * \return If the message was sent without error.
+   */
+  LIBBLIGHT_PROTOCOL_EXPORT bool send_blocking(
+    int fd,
+    const blight_header_t& header,
+    const blight_data_t data
+  );
   /*!
    * \brief Wait until a socket is ready to send data.
    * \param fd The socket
@@ -59,6 +89,55 @@ namespace BlightProtocol {
    * \return If the socket is ready for us to receive data.
    */
   LIBBLIGHT_PROTOCOL_EXPORT bool wait_for_read(int fd, int timeout = -1);
+  /*!
+   * \brief Buffered message reader for a socket.
+   *
+   * Reads as much as is available from the socket into a receive buffer with
+   * a single recv call, and then parses as many messages out of it as
+   * possible before reading from the socket again. Message data is allocated
+   * from the Pool.
+   */
+  class LIBBLIGHT_PROTOCOL_EXPORT MessageReader {
+  public:
+    /*!
+     * \brief Create a reader for a socket
+     * \param fd The socket. The reader does not take ownership of it.
+     * \param capacity Size of the receive buffer.
+     */
+    MessageReader(int fd, size_t capacity = 4096);
+    ~MessageReader();
+    MessageReader(const MessageReader&) = delete;
+    MessageReader& operator=(const MessageReader&) = delete;
+    /*!
+     * \brief The socket being read from
+     * \return The socket
+     */
+    int fd() const;
+    /*!
+     * \brief Number of bytes in the receive buffer that have not been parsed
+     * \return The number of bytes
+     */
+    size_t buffered() const;
+    /*!
+     * \brief Read the next message
+     * \param header The message header.
+     * \param data The message data, or nullptr if the message has no data.
+     * \param timeout How long to wait for data when no message is
+     * buffered. 0 will not wait, -1 will wait forever.
+     * \return 0 if a message was read, otherwise -errno. -EAGAIN is returned
+     * if there are no messages available.
+     * \note The caller is responsible for deallocating the returned data with
+     * \c Pool::deallocate
+     */
+    int next(blight_header_t* header, blight_data_t* data, int timeout = 0);
+
+  private:
+    int m_fd;
+    unsigned char* m_buffer;
+    size_t m_capacity;
+    size_t m_head;
+    size_t m_tail;
+  };
 } // namespace BlightProtocol
 #define blight_data_t BlightProtocol::blight_data_t
 extern "C" {
@@ -1,8 +1,13 @@
 #include "applications.h"
 
+#include <sys/stat.h>
+
+#include <QDataStream>
+#include <QDir>
 #include <QFileInfo>
 #include <QImage>
 #include <QJsonObject>
+#include <QSaveFile>
 #include <QVariantMap>
 
 #include "json.h"
@@ -28,6 +33,10 @@ const QList<QString> Flags{
 };
 const QList<QString> DeprecatedFlags{"chroot", "nosplash"};
 
+// "OXRC", bump the version whenever the entry layout changes
+#define REGISTRATION_CACHE_MAGIC 0x4f585243
+#define REGISTRATION_CACHE_VERSION 2
+
 namespace Oxide::Applications {
   QList<ValidationError> _validateRegistration(
     const QString& name,
@@ -609,6 +618,145 @@ namespace Oxide::Applications {
   validateRegistration(const QString& name, const QJsonObject& app) {
     return _validateRegistration(name, app, false);
   }
+  // Only the parsed file is cached. Validation depends on other files, like
+  // the binary and icon, so it is run again every time.
+  struct CachedRegistration {
+    QString path;
+    qint64 mtime;
+    qint64 size;
+    QVariantMap app;
+  };
+  static bool
+  statRegistration(const QString& path, qint64& mtime, qint64& size) {
+    struct stat st;
+    if (::stat(path.toLocal8Bit().constData(), &st) == -1) {
+      return false;
+    }
+    mtime = (qint64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    size = st.st_size;
+    return true;
+  }
+  static Registration
+  toRegistration(const QString& path, const QJsonObject& app) {
+    Registration registration;
+    registration.name = QFileInfo(path).completeBaseName();
+    registration.path = path;
+    if (app.isEmpty()) {
+      registration.errors.append(
+        ValidationError{
+          .level = ErrorLevel::Critical,
+          .msg = "File is not valid JSON or is empty"
+        }
+      );
+      return registration;
+    }
+    registration.errors = validateRegistration(registration.name, app);
+    registration.properties = registrationToMap(app, registration.name);
+    return registration;
+  }
+  static QMap<QString, CachedRegistration>
+  readRegistrationCache(const QString& cachePath) {
+    QMap<QString, CachedRegistration> entries;
+    QFile file(cachePath);
+    if (!file.open(QFile::ReadOnly) || file.size() == 0) {
+      return entries;
+    }
+    auto size = file.size();
+    auto* data = file.map(0, size);
+    if (data == nullptr) {
+      return entries;
+    }
+    // Everything read out of the stream is copied, so the mapping can be
+    // dropped as soon as the entries have been read
+    auto bytes = QByteArray::fromRawData((const char*)data, size);
+    QDataStream stream(bytes);
+    stream.setVersion(QDataStream::Qt_5_15);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (
+      magic != REGISTRATION_CACHE_MAGIC ||
+      version != REGISTRATION_CACHE_VERSION
+    ) {
+      file.unmap(data);
+      return entries;
+    }
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+      CachedRegistration entry;
+      stream >> entry.path >> entry.mtime >> entry.size >> entry.app;
+      entries.insert(entry.path, entry);
+    }
+    file.unmap(data);
+    if (stream.status() != QDataStream::Ok) {
+      O_WARNING("Discarding corrupt registration cache" << cachePath);
+      entries.clear();
+    }
+    return entries;
+  }
+  static void writeRegistrationCache(
+    const QString& cachePath,
+    const QList<CachedRegistration>& entries
+  ) {
+    // Written to a temporary file and renamed into place, so that readers
+    // never see a partially written cache
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+      O_WARNING("Unable to write registration cache" << cachePath);
+      return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_15);
+    stream << (quint32)REGISTRATION_CACHE_MAGIC
+           << (quint32)REGISTRATION_CACHE_VERSION << (quint32)entries.size();
+    for (auto& entry : entries) {
+      stream << entry.path << entry.mtime << entry.size << entry.app;
+    }
+    if (stream.status() != QDataStream::Ok || !file.commit()) {
+      O_WARNING("Unable to write registration cache" << cachePath);
+    }
+  }
+  QList<Registration>
+  getRegistrations(const QString& directory, const QString& cachePath) {
+    auto cache = readRegistrationCache(cachePath);
+    QList<CachedRegistration> entries;
+    bool changed = false;
+    QDir dir(directory);
+    dir.setNameFilters(QStringList() << "*.oxide");
+    for (auto entry : dir.entryInfoList()) {
+      auto path = entry.filePath();
+      CachedRegistration cached;
+      cached.path = path;
+      // Stat before parsing, so that a file that changes while it is being
+      // read is parsed again next time
+      if (!statRegistration(path, cached.mtime, cached.size)) {
+        continue;
+      }
+      auto it = cache.constFind(path);
+      if (
+        it != cache.constEnd() && it->mtime == cached.mtime &&
+        it->size == cached.size
+      ) {
+        entries.append(it.value());
+        continue;
+      }
+      O_DEBUG("Parsing registration" << path);
+      cached.app = getRegistration(path).toVariantMap();
+      entries.append(cached);
+      changed = true;
+    }
+    // Files that were removed also need to be dropped from the cache
+    if (changed || entries.size() != cache.size()) {
+      writeRegistrationCache(cachePath, entries);
+    }
+    QList<Registration> registrations;
+    for (auto& entry : entries) {
+      registrations.append(
+        toRegistration(entry.path, QJsonObject::fromVariantMap(entry.app))
+      );
+    }
+    return registrations;
+  }
   bool addToTarnishCache(const char* path) {
     return addToTarnishCache(QString(path));
   }
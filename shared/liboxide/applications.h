@@ -9,6 +9,7 @@
 #include <QFile>
 #include <QList>
 #include <QString>
+#include <QVariantMap>
 #include <string>
 
 #include "liboxide_global.h"
@@ -19,6 +20,12 @@
  */
 #define OXIDE_APPLICATION_REGISTRATIONS_DIRECTORY                              \
   "/home/root/.local/share/applications"
+/*!
+ * \def OXIDE_APPLICATION_REGISTRATIONS_CACHE
+ * \brief Location of the parsed application registration cache
+ */
+#define OXIDE_APPLICATION_REGISTRATIONS_CACHE                                  \
+  OXIDE_APPLICATION_REGISTRATIONS_DIRECTORY "/oxide.cache"
 #define OXIDE_ICONS_DIRECTORY "/home/root/.local/share/icons"
 
 /*!
@@ -53,6 +60,16 @@ namespace Oxide::Applications {
     ErrorLevel level; /*!< Error level */
     QString msg;      /*!< Error message */
   } ValidationError;
+  /*!
+   * \struct Registration
+   * \brief A parsed application registration returned by getRegistrations
+   */
+  typedef struct {
+    QString name;                  /*!< Application name */
+    QString path;                  /*!< Path to the registration file */
+    QVariantMap properties;        /*!< Empty if the file is not valid JSON */
+    QList<ValidationError> errors; /*!< Validation errors */
+  } Registration;
   /*!
    * \brief Convert an application registration to a QVariantMap
    * \param app Application registration to convert
@@ -172,6 +189,21 @@ namespace Oxide::Applications {
    */
   LIBOXIDE_EXPORT QList<ValidationError>
   validateRegistration(const QString& name, const QJsonObject& app);
+  /*!
+   * \brief Get all the application registrations in a directory
+   *
+   * Parsed registrations are kept in a binary cache keyed by the path,
+   * modification time and size of each file, so only files that have changed
+   * since the cache was last written are parsed again. Validation is always
+   * run, as it depends on other files like the binary and icon.
+   * \param directory Directory containing the registration files
+   * \param cachePath Path to the cache file
+   * \return Registrations sorted by file name
+   */
+  LIBOXIDE_EXPORT QList<Registration> getRegistrations(
+    const QString& directory = OXIDE_APPLICATION_REGISTRATIONS_DIRECTORY,
+    const QString& cachePath = OXIDE_APPLICATION_REGISTRATIONS_CACHE
+  );
   /*!
    * \brief Add an application to the tarnish application cache
    * \param path Path to the application registration file
@@ -6,14 +6,21 @@
 #include <linux/prctl.h>
 #include <sys/prctl.h>
 
+#include <atomic>
+
+static std::atomic<bool> DEBUG_ENABLED{
+  blight_debug_level_from_environment() >= LOG_DEBUG
+};
+
 namespace Oxide {
-  bool debugEnabled() {
-    if (getenv("DEBUG") == NULL) {
-      return false;
-    }
-    QString env = qgetenv("DEBUG");
-    return !(QStringList() << "0" << "n" << "no" << "false")
-              .contains(env.toLower());
+  bool debugEnabled() { return DEBUG_ENABLED.load(std::memory_order_relaxed); }
+
+  void setDebugEnabled(bool enabled) {
+    DEBUG_ENABLED.store(enabled, std::memory_order_relaxed);
+  }
+
+  void reloadDebugEnabled() {
+    setDebugEnabled(blight_debug_level_from_environment() >= LOG_DEBUG);
   }
 
   std::string getAppName(bool ignoreQApp) {
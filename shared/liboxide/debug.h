@@ -5,6 +5,7 @@
  */
 #pragma once
 
+#include <libblight/debug.h>
 #include <unistd.h>
 
 #include <QDebug>
@@ -58,7 +59,7 @@
  */
 #ifdef DEBUG
 #define O_DEBUG(msg)                                                           \
-  if (Oxide::debugEnabled()) {                                                 \
+  if (__builtin_expect(Oxide::debugEnabled(), false)) {                        \
     qDebug() << __DEBUG_APPLICATION_INFO__ << "Debug:" << msg                  \
              << __DEBUG_LOCATION__;                                            \
   }
@@ -71,7 +72,7 @@
  * \param msg Warning message to log
  */
 #define O_WARNING(msg)                                                         \
-  if (Oxide::debugEnabled()) {                                                 \
+  if (__builtin_expect(Oxide::debugEnabled(), false)) {                        \
     qWarning() << __DEBUG_APPLICATION_INFO__ << "Warning:" << msg              \
                << __DEBUG_LOCATION__;                                          \
   }
@@ -127,10 +128,26 @@ namespace Oxide {
   getDebugLocation(const char* file, unsigned int line, const char* function);
   /*!
    * \brief Return the state of debugging
+   *
+   * This is resolved from the DEBUG environment variable once at startup, so
+   * checking it is a single load. It is kept separate from the libblight debug
+   * level, which the preload library changes in the processes it is loaded
+   * into.
    * \return Debugging state
    * \snippet examples/oxide.cpp debugEnabled
+   * \sa setDebugEnabled, reloadDebugEnabled
    */
   LIBOXIDE_EXPORT bool debugEnabled();
+  /*!
+   * \brief Turn debugging on or off at runtime
+   * \param enabled Debugging state
+   */
+  LIBOXIDE_EXPORT void setDebugEnabled(bool enabled);
+  /*!
+   * \brief Resolve the state of debugging from the DEBUG environment variable
+   * again
+   */
+  LIBOXIDE_EXPORT void reloadDebugEnabled();
   /*!
    * \brief Get the name of the application
    * \param ignoreQApp Don't use qApp's application name
@@ -73,6 +73,15 @@ if(lo.exists()){
      qCritical("Loopback is missing?");
 }
 //! [SysObject]
+//! [SysObjectWatcher]
+SysObject eth0("/sys/class/net/eth0");
+SysObjectWatcher watcher;
+watcher.watch(eth0, "operstate");
+watcher.watchSubsystem("net");
+QObject::connect(&watcher, &SysObjectWatcher::changed, [&watcher, &eth0]{
+     qDebug() << "eth0 is" << watcher.value(eth0.propertyPath("operstate").c_str());
+});
+//! [SysObjectWatcher]
 //! [setupQtEnvironment]
 #include <liboxide.h>
 #ifdef __arm__
@@ -19,6 +19,7 @@
 #include "signalhandler.h"
 #include "slothandler.h"
 #include "sysobject.h"
+#include "sysobjectwatcher.h"
 #include "threading.h"
 #include "xochitlsettings.h"
 #if defined(LIBOXIDE_LIBRARY)
@@ -34,6 +34,7 @@ SOURCES += \
     slothandler.cpp \
     socketpair.cpp \
     sysobject.cpp \
+    sysobjectwatcher.cpp \
     signalhandler.cpp \
     threading.cpp \
     udev.cpp \
@@ -59,6 +60,7 @@ HEADERS += \
     slothandler.h \
     socketpair.h \
     sysobject.h \
+    sysobjectwatcher.h \
     signalhandler.h \
     threading.h \
     udev.h \
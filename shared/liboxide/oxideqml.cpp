@@ -250,6 +250,26 @@ namespace Oxide {
       return fn(window);
     }
 
+    bool getTabletEventCounters(quint64* delivered, quint64* coalesced) {
+      static auto fn = (void (*)(quint64*, quint64*))qGuiApp->platformFunction(
+        "tabletEventCounters"
+      );
+      if (fn == nullptr) {
+        return false;
+      }
+      fn(delivered, coalesced);
+      return true;
+    }
+
+    QVariantList getTabletEventHistory() {
+      static auto fn =
+        (QVariantList (*)())qGuiApp->platformFunction("tabletEventHistory");
+      if (fn == nullptr) {
+        return QVariantList();
+      }
+      return fn();
+    }
+
     QImage getImageForWindow(QWindow* window) {
       return getImageForSurface(getSurfaceForWindow(window));
     }
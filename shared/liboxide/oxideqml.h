@@ -286,6 +286,26 @@ namespace Oxide {
      * \return The buffer that represents the display server surface
      */
     LIBOXIDE_EXPORT Blight::shared_buf_t getSurfaceForWindow(QWindow* window);
+    /*!
+     * \brief Get how many tablet events the QPA has delivered, and how many
+     * frames it merged into later events because the application was behind
+     * \param delivered Set to the number of tablet events delivered
+     * \param coalesced Set to the number of tablet frames coalesced
+     * \return If the counters are available, false if not using the oxide
+     * QPA
+     */
+    LIBOXIDE_EXPORT bool
+    getTabletEventCounters(quint64* delivered, quint64* coalesced);
+    /*!
+     * \brief Get the samples that were merged into the tablet event currently
+     * being delivered
+     *
+     * Only recorded when OXIDE_QPA_TABLET_HISTORY is set. Call this from a
+     * tablet event handler to draw every sample the pen passed through.
+     * \return List of maps with x, y, pressure, xTilt, yTilt, z, and timestamp
+     * keys, oldest first
+     */
+    LIBOXIDE_EXPORT QVariantList getTabletEventHistory();
     /*!
      * \brief Get the a QImage that can be used to manipulate a display
      * server buffer
@@ -1,14 +1,38 @@
 #include "sysobject.h"
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <QByteArray>
 #include <QDir>
-#include <QFile>
-#include <QTextStream>
-#include <fstream>
-#include <sstream>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 #include "debug.h"
 
+// sysfs attributes are at most a page
+#define SYSFS_ATTRIBUTE_SIZE 4096
+
 namespace Oxide {
+  struct SysObject::FdCache {
+    std::mutex mutex;
+    std::unordered_map<std::string, int> fds;
+    ~FdCache() {
+      for (auto& item : fds) {
+        ::close(item.second);
+      }
+    }
+  };
+
+  SysObject::SysObject(QString path)
+    : m_path(path.toStdString())
+    , m_fds(std::make_shared<FdCache>()) {}
+
   std::string SysObject::propertyPath(const std::string& name) {
     return m_path + "/" + name;
   }
@@ -18,65 +42,75 @@ namespace Oxide {
     return dir.exists();
   }
   bool SysObject::hasProperty(const std::string& name) {
-    QFile file(propertyPath(name).c_str());
-    return file.exists();
+    {
+      std::lock_guard lock(m_fds->mutex);
+      if (m_fds->fds.count(name)) {
+        return true;
+      }
+    }
+    struct stat st;
+    return ::stat(propertyPath(name).c_str(), &st) == 0;
   }
   bool SysObject::hasDirectory(const std::string& name) {
     QDir dir(propertyPath(name).c_str());
     return dir.exists();
   }
   int SysObject::intProperty(const std::string& name) {
-    if (!hasProperty(name)) {
+    char buffer[SYSFS_ATTRIBUTE_SIZE];
+    auto size = readProperty(name, buffer, sizeof(buffer));
+    if (size < 0) {
       return 0;
     }
-    try {
-      return std::stoi(strProperty(name));
-    } catch (const std::invalid_argument& e) {
+    const char* begin = buffer;
+    const char* end = buffer + size;
+    while (begin < end && std::isspace((unsigned char)*begin)) {
+      begin++;
+    }
+    int value = 0;
+    if (std::from_chars(begin, end, value).ec != std::errc()) {
       O_DEBUG("Property value is not an integer: " << name.c_str());
       return 0;
     }
+    return value;
   }
   std::string SysObject::strProperty(const std::string& name) {
-    auto path = propertyPath(name);
-    QFile file(path.c_str());
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-      O_DEBUG("Couldn't find the file:" << path.c_str());
+    char buffer[SYSFS_ATTRIBUTE_SIZE];
+    auto size = readProperty(name, buffer, sizeof(buffer));
+    if (size < 0) {
+      O_DEBUG("Couldn't find the file:" << propertyPath(name).c_str());
       return "0";
     }
-    QTextStream in(&file);
-    std::string text = in.readLine().toStdString();
-    // rtrim
-    text.erase(
-      std::find_if(
-        text.rbegin(), text.rend(), [](int ch) { return !std::isspace(ch); }
-      ).base(),
-      text.end()
-    );
-    return text;
+    // Only the first line, without trailing whitespace
+    auto newline = static_cast<const char*>(std::memchr(buffer, '\n', size));
+    size_t length = newline == nullptr ? size : newline - buffer;
+    while (length > 0 && std::isspace((unsigned char)buffer[length - 1])) {
+      length--;
+    }
+    return std::string(buffer, length);
   }
   bool
   SysObject::setProperty(const std::string& name, const std::string& value) {
     auto path = propertyPath(name);
-    QFile file(path.c_str());
-    if (!file.open(QIODevice::WriteOnly)) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
       O_DEBUG("Couldn't open file for writing:" << path.c_str());
       return false;
     }
     auto data = value + "\n";
-    return file.write(data.c_str()) != static_cast<qint64>(data.size());
+    auto res = ::write(fd, data.c_str(), data.size());
+    ::close(fd);
+    return res == static_cast<ssize_t>(data.size());
   }
   QMap<QString, QString> SysObject::uevent() {
-    auto path = propertyPath("uevent");
-    QFile file(path.c_str());
     QMap<QString, QString> props;
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-      O_DEBUG("Couldn't find the file:" << path.c_str());
+    char buffer[SYSFS_ATTRIBUTE_SIZE];
+    auto size = readProperty("uevent", buffer, sizeof(buffer));
+    if (size < 0) {
+      O_DEBUG("Couldn't find the file:" << propertyPath("uevent").c_str());
       return props;
     }
-    QTextStream in(&file);
-    do {
-      auto line = in.readLine();
-      // doesn't always properly provide EOF
+    for (auto& data : QByteArray::fromRawData(buffer, size).split('\n')) {
+      auto line = QString::fromUtf8(data);
       if (line.trimmed().isEmpty()) {
         break;
       }
@@ -86,7 +120,35 @@ namespace Oxide {
         continue;
       }
       props.insert(parts.first().trimmed(), parts.last().trimmed());
-    } while (!in.atEnd());
+    }
     return props;
   }
+
+  ssize_t
+  SysObject::readProperty(const std::string& name, char* buffer, size_t size) {
+    std::lock_guard lock(m_fds->mutex);
+    auto it = m_fds->fds.find(name);
+    // A cached fd starts failing with ENODEV when the device is removed, so
+    // it is reopened once in case it has come back
+    for (int attempt = 0; attempt < 2; attempt++) {
+      if (it == m_fds->fds.end()) {
+        int fd = ::open(propertyPath(name).c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+          return -1;
+        }
+        it = m_fds->fds.emplace(name, fd).first;
+      }
+      auto res = ::pread(it->second, buffer, size, 0);
+      if (res >= 0) {
+        return res;
+      }
+      if (errno != ENODEV) {
+        return 0;
+      }
+      ::close(it->second);
+      m_fds->fds.erase(it);
+      it = m_fds->fds.end();
+    }
+    return -1;
+  }
 } // namespace Oxide
@@ -8,7 +8,11 @@
 #ifndef LIBOXIDE_SYSOBJECT_H
 #define LIBOXIDE_SYSOBJECT_H
 
+#include <sys/types.h>
+
+#include <QMap>
 #include <QString>
+#include <memory>
 #include <string>
 
 #include "liboxide_global.h"
@@ -17,12 +21,14 @@ namespace Oxide {
   /*!
    * \brief A class to make interacting with sysfs easier
    *
+   * Properties are kept open once they have been read, and are read again
+   * from the start with pread. Copies of a SysObject share the open files.
+   *
    * \snippet examples/oxide.cpp SysObject
    */
   class LIBOXIDE_EXPORT SysObject {
   public:
-    explicit SysObject(QString path)
-      : m_path(path.toStdString()) {}
+    explicit SysObject(QString path);
     /*!
      * \brief The path to the sysfs interface
      * \return The path to the sysfs interface
@@ -79,7 +85,22 @@ namespace Oxide {
     QMap<QString, QString> uevent();
 
   private:
+    struct FdCache;
     std::string m_path;
+    std::shared_ptr<FdCache> m_fds;
+
+    /*!
+     * \brief Read a named property into a buffer
+     *
+     * The property is opened the first time it is read, and opened again if
+     * the device behind it has gone away.
+     * \param name The property name
+     * \param buffer Buffer to read into
+     * \param size Size of the buffer
+     * \return Number of bytes read, 0 if the property couldn't be read
+     * \retval -1 Unable to open the property
+     */
+    ssize_t readProperty(const std::string& name, char* buffer, size_t size);
   };
 } // namespace Oxide
 #endif // LIBOXIDE_SYSOBJECT_H
@@ -0,0 +1,247 @@
+#include "sysobjectwatcher.h"
+
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+#include "debug.h"
+#include "udev.h"
+
+// sysfs attributes are at most a page
+#define SYSFS_ATTRIBUTE_SIZE 4096
+#define NETLINK_BUFFER_SIZE 8192
+
+namespace Oxide {
+  SysObjectWatcher::SysObjectWatcher(QObject* parent)
+    : QObject(parent)
+    , m_attributes()
+    , m_fallback(this)
+    , m_refresh(this)
+    , m_interval(60 * 1000) // 1 minute
+    , m_enabled(true)
+    , m_linkFd(-1)
+    , m_linkNotifier(nullptr) {
+    m_fallback.setSingleShot(false);
+    m_fallback.setTimerType(Qt::VeryCoarseTimer);
+    m_fallback.setInterval(m_interval);
+    connect(&m_fallback, &QTimer::timeout, this, [this] { refresh(); });
+    m_fallback.start();
+    // Collapse bursts of uevents into a single read
+    m_refresh.setSingleShot(true);
+    m_refresh.setInterval(0);
+    connect(&m_refresh, &QTimer::timeout, this, [this] { refresh(); });
+  }
+
+  SysObjectWatcher::~SysObjectWatcher() {
+    for (auto& attribute : m_attributes) {
+      delete attribute.notifier;
+      ::close(attribute.fd);
+    }
+    if (m_linkFd != -1) {
+      delete m_linkNotifier;
+      ::close(m_linkFd);
+    }
+  }
+
+  bool SysObjectWatcher::watch(const QString& path) {
+    if (m_attributes.contains(path)) {
+      return true;
+    }
+    int fd = ::open(path.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+      O_DEBUG("Unable to watch" << path << strerror(errno));
+      return false;
+    }
+    Attribute attribute{
+      .fd = fd,
+      .value = QByteArray(),
+      .notifier = new QSocketNotifier(fd, QSocketNotifier::Exception, this),
+    };
+    // The kernel reports POLLPRI for attributes it calls sysfs_notify() on,
+    // and only after they have been read once
+    read(attribute);
+    attribute.notifier->setEnabled(m_enabled);
+    connect(
+      attribute.notifier,
+      &QSocketNotifier::activated,
+      this,
+      [this, path] {
+        auto it = m_attributes.find(path);
+        if (it != m_attributes.end() && read(*it)) {
+          emit changed();
+        }
+      }
+    );
+    m_attributes.insert(path, attribute);
+    return true;
+  }
+
+  bool SysObjectWatcher::watch(SysObject& object, const std::string& name) {
+    if (!object.hasProperty(name)) {
+      return false;
+    }
+    return watch(QString::fromStdString(object.propertyPath(name)));
+  }
+
+  void SysObjectWatcher::watchSubsystem(const QString& subsystem) {
+    connect(
+      UDev::singleton(),
+      &UDev::event,
+      this,
+      [this, subsystem](const UDev::Device& device) {
+        if (m_enabled && device.subsystem == subsystem) {
+          m_refresh.start();
+        }
+      },
+      Qt::QueuedConnection
+    );
+    UDev::singleton()->addMonitor(subsystem, "");
+  }
+
+  bool SysObjectWatcher::watchLinks() {
+    if (m_linkFd != -1) {
+      return true;
+    }
+    int fd = ::socket(
+      AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE
+    );
+    if (fd == -1) {
+      O_WARNING("Unable to open rtnetlink socket" << strerror(errno));
+      return false;
+    }
+    sockaddr_nl address;
+    std::memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = RTMGRP_LINK;
+    if (::bind(fd, (sockaddr*)&address, sizeof(address)) == -1) {
+      O_WARNING("Unable to bind rtnetlink socket" << strerror(errno));
+      ::close(fd);
+      return false;
+    }
+    m_linkFd = fd;
+    m_linkNotifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    m_linkNotifier->setEnabled(m_enabled);
+    connect(m_linkNotifier, &QSocketNotifier::activated, this, [this] {
+      char buffer[NETLINK_BUFFER_SIZE];
+      bool changed = false;
+      while (true) {
+        auto size = ::recv(m_linkFd, buffer, sizeof(buffer), 0);
+        if (size < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          if (errno == ENOBUFS) {
+            // Messages were lost, so something may have changed
+            changed = true;
+            continue;
+          }
+          break;
+        }
+        int length = size;
+        for (
+          auto header = reinterpret_cast<nlmsghdr*>(buffer);
+          NLMSG_OK(header, length);
+          header = NLMSG_NEXT(header, length)
+        ) {
+          if (
+            header->nlmsg_type == RTM_NEWLINK ||
+            header->nlmsg_type == RTM_DELLINK
+          ) {
+            changed = true;
+          }
+        }
+      }
+      if (changed) {
+        m_refresh.start();
+      }
+    });
+    return true;
+  }
+
+  QByteArray SysObjectWatcher::value(const QString& path) const {
+    return m_attributes.value(path).value;
+  }
+
+  int SysObjectWatcher::fallbackInterval() const {
+    return m_interval;
+  }
+
+  void SysObjectWatcher::setFallbackInterval(int msec) {
+    m_interval = msec;
+    if (msec <= 0) {
+      m_fallback.stop();
+      return;
+    }
+    m_fallback.setInterval(msec);
+    if (m_enabled) {
+      m_fallback.start();
+    }
+  }
+
+  bool SysObjectWatcher::isEnabled() const {
+    return m_enabled;
+  }
+
+  void SysObjectWatcher::setEnabled(bool enabled) {
+    if (m_enabled == enabled) {
+      return;
+    }
+    m_enabled = enabled;
+    for (auto& attribute : m_attributes) {
+      attribute.notifier->setEnabled(enabled);
+    }
+    if (m_linkNotifier != nullptr) {
+      m_linkNotifier->setEnabled(enabled);
+    }
+    if (!enabled) {
+      m_fallback.stop();
+      m_refresh.stop();
+      return;
+    }
+    if (m_interval > 0) {
+      m_fallback.start();
+    }
+    refresh();
+  }
+
+  bool SysObjectWatcher::refresh() {
+    bool changed = false;
+    for (auto& attribute : m_attributes) {
+      if (read(attribute)) {
+        changed = true;
+      }
+    }
+    if (changed) {
+      emit this->changed();
+    }
+    return changed;
+  }
+
+  bool SysObjectWatcher::read(Attribute& attribute) {
+    char buffer[SYSFS_ATTRIBUTE_SIZE];
+    // Reading from the start again is what re-arms POLLPRI
+    ssize_t size = ::pread(attribute.fd, buffer, sizeof(buffer), 0);
+    if (size < 0) {
+      // Some attributes, like carrier on an interface that is down, fail to
+      // read until they are valid again
+      size = 0;
+    }
+    while (size > 0 && std::isspace((unsigned char)buffer[size - 1])) {
+      size--;
+    }
+    if (
+      attribute.value.size() == size &&
+      std::memcmp(attribute.value.constData(), buffer, size) == 0
+    ) {
+      return false;
+    }
+    attribute.value = QByteArray(buffer, size);
+    return true;
+  }
+} // namespace Oxide
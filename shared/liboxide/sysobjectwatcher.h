@@ -0,0 +1,119 @@
+/*!
+ * \addtogroup Oxide
+ * @{
+ * \file
+ */
+#pragma once
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <string>
+
+#include "liboxide_global.h"
+#include "sysobject.h"
+
+namespace Oxide {
+  /*!
+   * \brief Watch sysfs attributes for changes without polling them
+   *
+   * Attributes are kept open and their last value is cached in memory.
+   * Attributes that the kernel notifies on with sysfs_notify() wake the
+   * watcher through POLLPRI, and uevents for the watched subsystems or
+   * network link changes cause all attributes to be read again. A slow
+   * fallback timer catches anything that changes without any of these.
+   *
+   * \snippet examples/oxide.cpp SysObjectWatcher
+   */
+  class LIBOXIDE_EXPORT SysObjectWatcher : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit SysObjectWatcher(QObject* parent = nullptr);
+    ~SysObjectWatcher();
+    /*!
+     * \brief Start watching an attribute
+     * \param path Path to the attribute
+     * \return If the attribute could be opened
+     */
+    bool watch(const QString& path);
+    /*!
+     * \brief Start watching a named property of a sysfs object
+     * \param object The sysfs object
+     * \param name The property name
+     * \return If the property exists and could be opened
+     */
+    bool watch(SysObject& object, const std::string& name);
+    /*!
+     * \brief Read all attributes again when a uevent for a subsystem is seen
+     * \param subsystem The subsystem name
+     */
+    void watchSubsystem(const QString& subsystem);
+    /*!
+     * \brief Read all attributes again when a network link changes
+     *
+     * Network interface attributes like operstate and carrier don't send
+     * uevents, the kernel announces their changes over rtnetlink instead.
+     * \return If the rtnetlink socket could be opened
+     */
+    bool watchLinks();
+    /*!
+     * \brief Get the cached value of an attribute
+     * \param path Path to the attribute
+     * \return The value with trailing whitespace removed, or an empty array
+     * if the attribute isn't watched or couldn't be read
+     */
+    QByteArray value(const QString& path) const;
+    /*!
+     * \brief How often attributes are read when nothing has notified
+     * \return The interval in milliseconds
+     */
+    int fallbackInterval() const;
+    /*!
+     * \brief Set how often attributes are read when nothing has notified
+     * \param msec The interval in milliseconds, 0 disables the fallback
+     */
+    void setFallbackInterval(int msec);
+    bool isEnabled() const;
+    /*!
+     * \brief Enable or disable the watcher
+     *
+     * No notifications are handled while disabled. Attributes are read again
+     * when it is enabled so that changes while disabled are not missed.
+     * \param enabled If the watcher should be enabled
+     */
+    void setEnabled(bool enabled);
+
+  public slots:
+    /*!
+     * \brief Read all attributes again
+     * \return If any value changed
+     */
+    bool refresh();
+
+  signals:
+    /*!
+     * \brief One or more attribute values have changed
+     */
+    void changed();
+
+  private:
+    struct Attribute {
+      int fd;
+      QByteArray value;
+      QSocketNotifier* notifier;
+    };
+    QMap<QString, Attribute> m_attributes;
+    QTimer m_fallback;
+    QTimer m_refresh;
+    int m_interval;
+    bool m_enabled;
+    int m_linkFd;
+    QSocketNotifier* m_linkNotifier;
+
+    static bool read(Attribute& attribute);
+  };
+} // namespace Oxide
+/*! @} */
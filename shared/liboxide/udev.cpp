@@ -38,6 +38,7 @@ namespace Oxide {
   }
 
   UDev::~UDev() {
+    closeMonitor();
     if (udevLib != nullptr) {
       udev_unref(udevLib);
       udevLib = nullptr;
@@ -89,28 +90,27 @@ namespace Oxide {
   }
 
   void UDev::start() {
-    statelock.lock();
+    QMutexLocker locker(&statelock);
     O_DEBUG("UDev::Starting...");
     exitRequested = false;
     if (running) {
-      statelock.unlock();
       O_DEBUG("UDev::Already running");
       return;
     }
-    QTimer::singleShot(0, [this]() {
-      monitor();
-      statelock.unlock();
-      O_DEBUG("UDev::Started");
-    });
+    running = true;
+    // The monitor and its notifier live on the UDev thread
+    QMetaObject::invokeMethod(this, &UDev::monitor, Qt::QueuedConnection);
   }
 
   void UDev::stop() {
-    statelock.lock();
+    QMutexLocker locker(&statelock);
     O_DEBUG("UDev::Stopping...");
     if (running) {
       exitRequested = true;
+      QMetaObject::invokeMethod(
+        this, &UDev::checkMonitor, Qt::QueuedConnection
+      );
     }
-    statelock.unlock();
   }
 
   bool UDev::isRunning() {
@@ -132,6 +132,9 @@ namespace Oxide {
     if (!list.contains(deviceType)) {
       list.append(deviceType);
       update = true;
+      QMetaObject::invokeMethod(
+        this, &UDev::checkMonitor, Qt::QueuedConnection
+      );
     }
   }
   void UDev::removeMonitor(QString subsystem, QString deviceType) {
@@ -144,6 +147,7 @@ namespace Oxide {
       monitors.remove(subsystem);
     }
     update = true;
+    QMetaObject::invokeMethod(this, &UDev::checkMonitor, Qt::QueuedConnection);
   }
 
   QList<UDev::Device> UDev::getDeviceList(const QString& subsystem) {
@@ -228,15 +232,17 @@ namespace Oxide {
   }
 
   void UDev::monitor() {
-    running = true;
     O_DEBUG("UDev::Monitor starting...");
-    udev_monitor* mon = udev_monitor_new_from_netlink(udevLib, "udev");
-    if (!mon) {
+    update = false;
+    udevMonitor = udev_monitor_new_from_netlink(udevLib, "udev");
+    if (udevMonitor == nullptr) {
       O_WARNING(
         "UDev::Monitor Unable to listen to UDev: Failed to create "
         "netlink monitor"
       );
       O_DEBUG(strerror(errno))
+      running = false;
+      emit stopped();
       return;
     }
     O_DEBUG("UDev::Monitor applying filters...");
@@ -244,7 +250,7 @@ namespace Oxide {
       for (QString deviceType : monitors[subsystem]) {
         O_DEBUG("UDev::Monitor filter" << subsystem << deviceType);
         int err = udev_monitor_filter_add_match_subsystem_devtype(
-          mon,
+          udevMonitor,
           subsystem.toUtf8().constData(),
           deviceType.isNull() || deviceType.isEmpty()
             ? NULL
@@ -256,54 +262,78 @@ namespace Oxide {
       }
     }
     O_DEBUG("UDev::Monitor enabling...");
-    int err = udev_monitor_enable_receiving(mon);
+    int err = udev_monitor_enable_receiving(udevMonitor);
     if (err < 0) {
       O_WARNING("UDev::Monitor Unable to listen to UDev:" << strerror(err));
-      udev_monitor_unref(mon);
+      closeMonitor();
+      running = false;
+      emit stopped();
       return;
     }
-    O_DEBUG("UDev::Monitor setting up timer...");
-    auto timer = new QTimer();
-    timer->setTimerType(Qt::PreciseTimer);
-    timer->setSingleShot(true);
-    connect(timer, &QTimer::timeout, [this, mon, timer] {
-      if (exitRequested) {
-        O_DEBUG("UDev::Monitor stopping...");
-        udev_monitor_unref(mon);
-        timer->deleteLater();
-        running = false;
-        O_DEBUG("UDev::Stopped");
-        emit stopped();
-        return;
-      }
-      if (update || !mon) {
-        O_DEBUG("UDev::Monitor reloading...");
-        update = false;
-        udev_monitor_unref(mon);
-        timer->deleteLater();
-        QTimer::singleShot(0, this, &UDev::monitor);
-        return;
-      }
-      udev_device* dev = udev_monitor_receive_device(mon);
-      if (dev != nullptr) {
-        Device device;
-        device.action = getActionType(dev);
-        auto devNode = udev_device_get_devnode(dev);
-        device.path = QString(devNode ? devNode : "");
-        auto devSubsystem = udev_device_get_subsystem(dev);
-        device.subsystem = QString(devSubsystem ? devSubsystem : "");
-        auto devType = udev_device_get_devtype(dev);
-        device.deviceType = QString(devType ? devType : "");
-        udev_device_unref(dev);
-        O_DEBUG("UDev::Monitor UDev event" << device);
-        emit event(device);
-      } else if (errno && errno != EAGAIN) {
+    // Only wake up when the netlink socket has something to read
+    notifier = new QSocketNotifier(
+      udev_monitor_get_fd(udevMonitor), QSocketNotifier::Read, this
+    );
+    connect(notifier, &QSocketNotifier::activated, this, &UDev::receive);
+    O_DEBUG("UDev::Monitor event loop started");
+  }
+
+  void UDev::checkMonitor() {
+    if (udevMonitor == nullptr) {
+      return;
+    }
+    statelock.lock();
+    if (exitRequested) {
+      O_DEBUG("UDev::Monitor stopping...");
+      closeMonitor();
+      running = false;
+      statelock.unlock();
+      O_DEBUG("UDev::Stopped");
+      emit stopped();
+      return;
+    }
+    statelock.unlock();
+    if (update) {
+      O_DEBUG("UDev::Monitor reloading...");
+      closeMonitor();
+      monitor();
+    }
+  }
+
+  void UDev::receive() {
+    if (udevMonitor == nullptr) {
+      return;
+    }
+    udev_device* dev = udev_monitor_receive_device(udevMonitor);
+    if (dev == nullptr) {
+      if (errno && errno != EAGAIN) {
         O_WARNING("UDev::Monitor error checking event:" << strerror(errno));
       }
-      timer->start(30);
-    });
-    timer->start(30);
-    O_DEBUG("UDev::Monitor event loop started");
+      return;
+    }
+    Device device;
+    device.action = getActionType(dev);
+    auto devNode = udev_device_get_devnode(dev);
+    device.path = QString(devNode ? devNode : "");
+    auto devSubsystem = udev_device_get_subsystem(dev);
+    device.subsystem = QString(devSubsystem ? devSubsystem : "");
+    auto devType = udev_device_get_devtype(dev);
+    device.deviceType = QString(devType ? devType : "");
+    udev_device_unref(dev);
+    O_DEBUG("UDev::Monitor UDev event" << device);
+    emit event(device);
+  }
+
+  void UDev::closeMonitor() {
+    if (notifier != nullptr) {
+      notifier->setEnabled(false);
+      notifier->deleteLater();
+      notifier = nullptr;
+    }
+    if (udevMonitor != nullptr) {
+      udev_monitor_unref(udevMonitor);
+      udevMonitor = nullptr;
+    }
   }
 
   QDebug operator<<(QDebug debug, const UDev::Device& device) {
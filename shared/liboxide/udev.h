@@ -9,6 +9,7 @@
 
 #include <QMutex>
 #include <QObject>
+#include <QSocketNotifier>
 
 #include "liboxide_global.h"
 
@@ -82,6 +83,8 @@ namespace Oxide {
 
   private:
     struct udev* udevLib = nullptr;
+    udev_monitor* udevMonitor = nullptr;
+    QSocketNotifier* notifier = nullptr;
     bool running = false;
     bool exitRequested = false;
     bool update = false;
@@ -89,8 +92,12 @@ namespace Oxide {
     QThread _thread;
     QMutex statelock;
 
+    void closeMonitor();
+
   protected:
     void monitor();
+    void checkMonitor();
+    void receive();
   };
   QDebug operator<<(QDebug debug, const UDev::Device& device);
 } // namespace Oxide
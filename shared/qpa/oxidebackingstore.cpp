@@ -10,6 +10,7 @@
 #include <private/qguiapplication_p.h>
 #include <qpa/qplatformscreen.h>
 
+#include <QDynamicPropertyChangeEvent>
 #include <QPainter>
 #include <QScreen>
 
@@ -25,6 +26,10 @@ OxideBackingStore::OxideBackingStore(QWindow* window)
   if (window != nullptr && window->handle()) {
     (static_cast<OxideWindow*>(window->handle()))->setBackingStore(this);
   }
+  if (window != nullptr) {
+    mInkOverlayFilter = std::make_unique<InkOverlayFilter>(this);
+    window->installEventFilter(mInkOverlayFilter.get());
+  }
 }
 
 OxideBackingStore::~OxideBackingStore() {
@@ -50,18 +55,23 @@ OxideBackingStore::flush(
     qDebug() << "OxideBackingStore::repaint:" << mBuffer->surface << offset
              << region;
   }
+  std::vector<Blight::rect_t> rects;
+  rects.reserve(region.rectCount());
   for (auto rect : region) {
-    Blight::connection()->repaint(
-      mBuffer,
-      rect.x(),
-      rect.y(),
-      rect.width(),
-      rect.height(),
-      Oxide::QML::getSingleton()->waveform(),
-      Oxide::QML::getSingleton()->contentType(),
-      Oxide::QML::getSingleton()->updateMode()
-    );
+    rects.push_back(Blight::rect_t{
+      .x = rect.x(),
+      .y = rect.y(),
+      .width = (unsigned int)rect.width(),
+      .height = (unsigned int)rect.height()
+    });
   }
+  Blight::connection()->repaint(
+    mBuffer,
+    rects,
+    Oxide::QML::getSingleton()->waveform(),
+    Oxide::QML::getSingleton()->contentType(),
+    Oxide::QML::getSingleton()->updateMode()
+  );
   static QImage* (*previousBuffer)() =
     (QImage * (*)()) dlsym(RTLD_DEFAULT, "__PREVIOUS_BUFFER");
   if (previousBuffer != nullptr && previousBuffer() != nullptr) {
@@ -187,11 +197,66 @@ OxideBackingStore::resize(const QSize& size, const QRegion& region) {
     mBuffer->height,
     (QImage::Format)mBuffer->format
   );
+  // Surfaces are replaced when resized, so the settings have to be sent again
+  mInkOverlay = false;
+  updateInkOverlay();
   if (debug()) {
     qDebug() << "OxideBackingStore::resized" << mBuffer->surface;
   }
 }
 
+void
+OxideBackingStore::updateInkOverlay() {
+  // Windows opt in with WA_INK_OVERLAY set to the width of the pen in pixels,
+  // and optionally WA_INK_PREDICTION set to how far ahead of the pen to draw
+  // in milliseconds
+  if (mBuffer == nullptr || !mBuffer->surface) {
+    // Sent once the surface exists
+    return;
+  }
+  bool ok;
+  auto width = window()->property("WA_INK_OVERLAY").toUInt(&ok);
+  if (!ok) {
+    width = 0;
+  }
+  auto prediction = window()->property("WA_INK_PREDICTION").toUInt(&ok);
+  if (!ok) {
+    prediction = 0;
+  }
+  if (!width && !mInkOverlay) {
+    return;
+  }
+  if (
+    width && mInkOverlay && width == mInkWidth && prediction == mInkPrediction
+  ) {
+    return;
+  }
+  if (debug()) {
+    qDebug() << "OxideBackingStore::updateInkOverlay" << mBuffer->surface
+             << width << prediction;
+  }
+  // Clearing WA_INK_OVERLAY turns the overlay off again
+  Blight::connection()->inkOverlay(mBuffer, width != 0, width, prediction);
+  mInkOverlay = width != 0;
+  mInkWidth = width;
+  mInkPrediction = prediction;
+}
+
+OxideBackingStore::InkOverlayFilter::InkOverlayFilter(OxideBackingStore* store)
+  : QObject()
+  , store(store) {}
+
+bool
+OxideBackingStore::InkOverlayFilter::eventFilter(QObject* obj, QEvent* ev) {
+  if (ev->type() == QEvent::DynamicPropertyChange) {
+    auto name = static_cast<QDynamicPropertyChangeEvent*>(ev)->propertyName();
+    if (name == "WA_INK_OVERLAY" || name == "WA_INK_PREDICTION") {
+      store->updateInkOverlay();
+    }
+  }
+  return QObject::eventFilter(obj, ev);
+}
+
 bool
 OxideBackingStore::scroll(const QRegion& area, int dx, int dy) {
   Q_UNUSED(area)
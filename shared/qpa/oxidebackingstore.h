@@ -4,7 +4,9 @@
 #include <qpa/qplatformbackingstore.h>
 #include <qpa/qplatformwindow.h>
 
+#include <QtCore/QObject>
 #include <QtGui/QImage>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -24,10 +26,28 @@ public:
   Blight::shared_buf_t buffer();
 
 private:
+  // Sends the ink overlay settings again when the window properties change
+  class InkOverlayFilter : public QObject {
+  public:
+    InkOverlayFilter(OxideBackingStore* store);
+
+  protected:
+    bool eventFilter(QObject* obj, QEvent* ev) override;
+
+  private:
+    OxideBackingStore* store;
+  };
+
   QImage image;
   Blight::shared_buf_t mBuffer = nullptr;
+  std::unique_ptr<InkOverlayFilter> mInkOverlayFilter;
+  // What the current surface was last told
+  bool mInkOverlay = false;
+  unsigned int mInkWidth = 0;
+  unsigned int mInkPrediction = 0;
   bool debug();
   bool shareBackingStore();
+  void updateInkOverlay();
 };
 
 QT_END_NAMESPACE
@@ -38,9 +38,13 @@ typedef struct TabletData {
     int lastReportTiltX;
     int lastReportTiltY;
     QPointF lastReportPos;
+    // Position of the last frame, even if it was coalesced
+    QPointF lastFramePos;
   } state;
   int lastEventType;
   QPointingDevice* device = nullptr;
+  // Samples coalesced since the last delivered event
+  QVariantList history;
 
   TabletData()
     : lastEventType{0} {
@@ -121,7 +125,8 @@ DeviceData::DeviceData(
 )
   : device(device)
   , type(type)
-  , stopFlag(false) {
+  , stopFlag(false)
+  , pending(0) {
   auto path = QString("/dev/input/event%1").arg(device);
   auto fd = ::open(path.toStdString().c_str(), O_RDWR);
   char name[1024];
@@ -265,6 +270,7 @@ DeviceData::DeviceData(
       }
       auto event = maybe.value();
       auto self = shared_from_this();
+      pending++;
       QMetaObject::invokeMethod(
         eventHandler,
         [self, event, eventHandler]() {
@@ -302,6 +308,10 @@ DeviceData::~DeviceData() {
   }
 }
 
+std::atomic<quint64> OxideEventHandler::s_tabletDelivered{0};
+std::atomic<quint64> OxideEventHandler::s_tabletCoalesced{0};
+QVariantList OxideEventHandler::s_tabletHistory;
+
 OxideEventHandler::OxideEventHandler(
   OxideEventManager* manager,
   const QStringList& parameters
@@ -311,7 +321,15 @@ OxideEventHandler::OxideEventHandler(
   , m_keymap{0}
   , m_keymap_size{0}
   , m_keycompose{0}
-  , m_keycompose_size{0} {
+  , m_keycompose_size{0}
+  , m_compressTablet{
+      !qEnvironmentVariableIsSet("OXIDE_QPA_TABLET_COMPRESSION") ||
+      qEnvironmentVariableIntValue("OXIDE_QPA_TABLET_COMPRESSION") > 0
+    }
+  , m_tabletHistory{
+      qEnvironmentVariableIsSet("OXIDE_QPA_TABLET_HISTORY") &&
+      qEnvironmentVariableIntValue("OXIDE_QPA_TABLET_HISTORY") > 0
+    } {
   parseKeyParams(parameters);
   parseTouchParams(
     QString(deviceSettings.getTouchEnvSetting()).split(QLatin1Char(':'))
@@ -353,6 +371,7 @@ OxideEventHandler::handleInputEvent(
   std::shared_ptr<DeviceData> data,
   struct input_event event
 ) {
+  data->pending--;
   switch (data->type) {
     case QInputDeviceManager::DeviceTypeKeyboard:
       processKeyboardEvent(data, &event);
@@ -679,9 +698,10 @@ OxideEventHandler::processTabletEvent(
     // Prevent sending confusing values of 0 when moving the pen outside the
     // active area.
     if (!state.down && state.lastReportDown) {
-      globalPos = state.lastReportPos;
+      globalPos = state.lastFramePos;
       pointer = state.lastReportTool;
     }
+    state.lastFramePos = globalPos;
     int pressureRange = tabletData->maxValues.p - tabletData->minValues.p;
     qreal pressure =
       pressureRange ? (state.p - tabletData->minValues.p) / qreal(pressureRange)
@@ -698,6 +718,42 @@ OxideEventHandler::processTabletEvent(
     qreal tiltY = tiltYRange
                     ? (state.ty - tabletData->minValues.ty) / qreal(tiltYRange)
                     : qreal(1);
+    bool changed =
+      state.tool != state.lastReportTool ||
+      state.down != state.lastReportDown || globalPos != state.lastReportPos ||
+      state.p != state.lastReportPressure ||
+      state.tx != state.lastReportTiltX || state.ty != state.lastReportTiltY ||
+      state.d != state.lastReportZ;
+    if (!changed) {
+      tabletData->lastEventType = event->type;
+      return;
+    }
+    // Only plain motion can be merged, proximity, contact and the pen
+    // starting or stopping pressing down are always delivered
+    bool edge =
+      pointer != state.lastReportTool || state.down != state.lastReportDown ||
+      (state.p > tabletData->minValues.p) !=
+        (state.lastReportPressure > tabletData->minValues.p);
+    if (m_compressTablet && !edge && data->pending.load() > 0) {
+      // More input from the tablet is already waiting behind this frame, so
+      // the application is behind and this position would be stale before
+      // it could be drawn
+      s_tabletCoalesced++;
+      if (m_tabletHistory) {
+        tabletData->history.append(QVariantMap{
+          {"x", globalPos.x()},
+          {"y", globalPos.y()},
+          {"pressure", pressure},
+          {"xTilt", tiltX},
+          {"yTilt", tiltY},
+          {"z", z},
+          {"timestamp",
+           quint64(event->time.tv_sec) * 1000 + event->time.tv_usec / 1000},
+        });
+      }
+      tabletData->lastEventType = event->type;
+      return;
+    }
     auto modifiers = qGuiApp->keyboardModifiers();
     auto button = state.down ? Qt::LeftButton : Qt::NoButton;
     if (!state.lastReportTool && pointer) {
@@ -716,34 +772,30 @@ OxideEventHandler::processTabletEvent(
         modifiers
       );
     }
-    if (
-      state.tool != state.lastReportTool ||
-      state.down != state.lastReportDown || globalPos != state.lastReportPos ||
-      state.p != state.lastReportPressure ||
-      state.tx != state.lastReportTiltX || state.ty != state.lastReportTiltY ||
-      state.d != state.lastReportZ
-    ) {
-      QWindowSystemInterface::handleTabletEvent(
-        nullptr,
-        tabletData->device,
-        QPointF(),
-        globalPos,
-        button,
-        pressure,
-        tiltX,
-        tiltY,
-        0,
-        0,
-        z,
-        modifiers
-      );
-      state.lastReportPos = globalPos;
-      state.lastReportPressure = state.p;
-      state.lastReportDown = state.down;
-      state.lastReportTiltX = state.tx;
-      state.lastReportTiltY = state.ty;
-      state.lastReportZ = state.d;
-    }
+    // Read by the application while the event is delivered
+    s_tabletHistory.swap(tabletData->history);
+    tabletData->history.clear();
+    s_tabletDelivered++;
+    QWindowSystemInterface::handleTabletEvent(
+      nullptr,
+      tabletData->device,
+      QPointF(),
+      globalPos,
+      button,
+      pressure,
+      tiltX,
+      tiltY,
+      0,
+      0,
+      z,
+      modifiers
+    );
+    state.lastReportPos = globalPos;
+    state.lastReportPressure = state.p;
+    state.lastReportDown = state.down;
+    state.lastReportTiltX = state.tx;
+    state.lastReportTiltY = state.ty;
+    state.lastReportZ = state.d;
     if (state.lastReportTool && !pointer) {
       QWindowSystemInterface::handleTabletEnterLeaveProximityEvent(
         nullptr,
@@ -762,10 +814,26 @@ OxideEventHandler::processTabletEvent(
     }
     state.lastReportTool = pointer;
     QWindowSystemInterface::flushWindowSystemEvents();
+    s_tabletHistory.clear();
   }
   tabletData->lastEventType = event->type;
 }
 
+void
+OxideEventHandler::tabletEventCounters(quint64* delivered, quint64* coalesced) {
+  if (delivered != nullptr) {
+    *delivered = s_tabletDelivered.load();
+  }
+  if (coalesced != nullptr) {
+    *coalesced = s_tabletCoalesced.load();
+  }
+}
+
+QVariantList
+OxideEventHandler::tabletEventHistory() {
+  return s_tabletHistory;
+}
+
 void
 addTouchPoint(
   QTransform rotate,
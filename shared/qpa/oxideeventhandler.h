@@ -9,6 +9,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QVariantList>
 
 #include <atomic>
 #include <linux/prctl.h>
@@ -39,6 +40,8 @@ public:
   QInputDeviceManager::DeviceType type;
   std::shared_ptr<Blight::input_buffer_t> buffer;
   std::atomic<bool> stopFlag;
+  // Events read from the buffer that haven't been handled yet
+  std::atomic<unsigned int> pending;
   std::unique_ptr<std::thread> thread;
   template<typename T>
   T* get() {
@@ -64,6 +67,22 @@ public:
   void remove(unsigned int number, QInputDeviceManager::DeviceType type);
   void
   handleInputEvent(std::shared_ptr<DeviceData> data, struct input_event event);
+  /*!
+   * \brief Get how many tablet events have been delivered and coalesced
+   * \param delivered Set to the number of tablet events delivered
+   * \param coalesced Set to the number of tablet frames merged into a later
+   * event because the application was behind
+   */
+  static void tabletEventCounters(quint64* delivered, quint64* coalesced);
+  /*!
+   * \brief Samples that were merged into the tablet event being delivered
+   *
+   * Only recorded when OXIDE_QPA_TABLET_HISTORY is set. Each sample has the
+   * x, y, pressure, xTilt, yTilt, z and timestamp of a coalesced frame,
+   * oldest first.
+   * \return The samples, empty outside of a tablet event
+   */
+  static QVariantList tabletEventHistory();
 
 private:
   void processKeyboardEvent(
@@ -92,6 +111,11 @@ private:
   bool m_no_zap;
   bool m_do_compose;
   QTransform m_rotate;
+  bool m_compressTablet;
+  bool m_tabletHistory;
+  static std::atomic<quint64> s_tabletDelivered;
+  static std::atomic<quint64> s_tabletCoalesced;
+  static QVariantList s_tabletHistory;
 
   static const KeyboardMap::Mapping s_keymap_default[];
   static const KeyboardMap::Composing s_keycompose_default[];
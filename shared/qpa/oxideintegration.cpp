@@ -154,24 +154,30 @@ OxideIntegration::initialize() {
     QDBusConnection::sessionBus()
 #endif
   );
+  // Only the generation is sent with changes, the data is fetched when
+  // something actually reads the clipboard
   connect(
     compositor,
     &Compositor::clipboardChanged,
     this,
-    [this](const QByteArray& data) {
-      m_clipboard->setData("application/octet-stream", data);
+    [this](qulonglong generation) {
+      if (generation != m_clipboardGeneration) {
+        m_clipboardStale = true;
+        QPlatformClipboard::emitChanged(QClipboard::Clipboard);
+      }
     }
   );
-  m_clipboard->setData("application/octet-stream", compositor->clipboard());
   connect(
     compositor,
     &Compositor::selectionChanged,
     this,
-    [this](const QByteArray& data) {
-      m_selection->setData("application/octet-stream", data);
+    [this](qulonglong generation) {
+      if (generation != m_selectionGeneration) {
+        m_selectionStale = true;
+        QPlatformClipboard::emitChanged(QClipboard::Selection);
+      }
     }
   );
-  m_selection->setData("application/octet-stream", compositor->selection());
 #endif
 }
 
@@ -305,6 +311,12 @@ OxideIntegration::platformFunction(const QByteArray& function) const {
   if (function == "getSurfaceForWindow") {
     return QFunctionPointer((void(*))getSurfaceForWindowStatic);
   }
+  if (function == "tabletEventCounters") {
+    return QFunctionPointer(OxideEventHandler::tabletEventCounters);
+  }
+  if (function == "tabletEventHistory") {
+    return QFunctionPointer(OxideEventHandler::tabletEventHistory);
+  }
   return nullptr;
 }
 
@@ -353,12 +365,56 @@ OxideIntegration::desktopEnvironment() const {
 }
 
 #ifndef Q_NO_CLIPBOARD
+static void
+loadMimeData(
+  QPointer<QMimeData>& mimeData,
+  std::optional<Blight::clipboard_t> clipboard,
+  qulonglong& generation
+) {
+  if (!clipboard.has_value()) {
+    return;
+  }
+  if (mimeData.isNull()) {
+    mimeData = new QMimeData();
+  }
+  mimeData->clear();
+  mimeData->setData(
+    QString::fromStdString(clipboard->mimeType),
+    QByteArray(
+      reinterpret_cast<const char*>(clipboard->data.get()), clipboard->size
+    )
+  );
+  generation = clipboard->generation;
+}
+
+static qulonglong
+storeMimeData(const std::string& name, QMimeData* data) {
+  Blight::clipboard_t clipboard(name);
+  if (data != nullptr && !data->formats().isEmpty()) {
+    auto format = data->formats().first();
+    clipboard.mimeType = format.toStdString();
+    auto bytes = data->data(format);
+    clipboard.set(bytes.constData(), bytes.size());
+  } else {
+    clipboard.set("", 0);
+  }
+  return clipboard.generation;
+}
+
 QMimeData*
 OxideIntegration::mimeData(QClipboard::Mode mode) {
   switch (mode) {
     case QClipboard::Clipboard:
+      if (m_clipboardStale) {
+        loadMimeData(m_clipboard, Blight::clipboard(), m_clipboardGeneration);
+        m_clipboardStale = false;
+      }
       return m_clipboard.data();
     case QClipboard::Selection:
+      if (m_selectionStale) {
+        loadMimeData(m_selection, Blight::selection(), m_selectionGeneration);
+        m_selectionStale = false;
+      }
       return m_selection.data();
     default:
       return nullptr;
@@ -368,22 +424,18 @@ OxideIntegration::mimeData(QClipboard::Mode mode) {
 void
 OxideIntegration::setMimeData(QMimeData* data, QClipboard::Mode mode) {
   switch (mode) {
-    case QClipboard::Clipboard: {
+    case QClipboard::Clipboard:
       m_clipboard = data;
-      auto clipboard = Blight::clipboard();
-      auto constData = data->data("");
-      clipboard->set(constData, constData.size());
+      m_clipboardGeneration = storeMimeData("clipboard", data);
+      m_clipboardStale = false;
       QPlatformClipboard::emitChanged(mode);
       break;
-    }
-    case QClipboard::Selection: {
+    case QClipboard::Selection:
       m_selection = data;
-      auto selection = Blight::selection();
-      auto constData = data->data("");
-      selection->set(constData, constData.size());
+      m_selectionGeneration = storeMimeData("selection", data);
+      m_selectionStale = false;
       QPlatformClipboard::emitChanged(mode);
       break;
-    }
     default:
       break;
   }
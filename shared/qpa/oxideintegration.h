@@ -85,6 +85,10 @@ private:
 #ifndef QT_NO_CLIPBOARD
   QPointer<QMimeData> m_clipboard;
   QPointer<QMimeData> m_selection;
+  qulonglong m_clipboardGeneration = 0;
+  qulonglong m_selectionGeneration = 0;
+  bool m_clipboardStale = true;
+  bool m_selectionStale = true;
 #endif
   OxideEventManager* m_eventManager = nullptr;
   Options m_options;
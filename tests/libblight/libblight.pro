@@ -15,14 +15,18 @@ SOURCES +=  \
     main.cpp \
     test_clock.cpp \
     test_connection.cpp \
+    test_debug.cpp \
     test_socket.cpp \
+    test_trace.cpp \
     test_types.cpp
 
 HEADERS += \
     autotest.h \
     test_clock.h \
     test_connection.h \
+    test_debug.h \
     test_socket.h \
+    test_trace.h \
     test_types.h
 
 include(../../qmake/common.pri)
@@ -0,0 +1,109 @@
+#include "test_debug.h"
+
+#include <fcntl.h>
+#include <libblight/debug.h>
+#include <unistd.h>
+
+#include <thread>
+
+test_Debug::test_Debug()
+  : m_level{0}
+  , m_stderr{-1}
+  , m_pipe{-1, -1} {}
+test_Debug::~test_Debug() {}
+
+void
+test_Debug::init() {
+  m_level = get_blight_debug_level();
+  QCOMPARE(pipe2(m_pipe, O_NONBLOCK | O_CLOEXEC), 0);
+  m_stderr = dup(STDERR_FILENO);
+  QVERIFY(m_stderr != -1);
+  QVERIFY(dup2(m_pipe[1], STDERR_FILENO) != -1);
+}
+
+void
+test_Debug::cleanup() {
+  blight_log_flush();
+  if (m_stderr != -1) {
+    dup2(m_stderr, STDERR_FILENO);
+    close(m_stderr);
+    m_stderr = -1;
+  }
+  for (auto& fd : m_pipe) {
+    if (fd != -1) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  set_blight_debug_level(m_level);
+}
+
+QString
+test_Debug::capture() {
+  blight_log_flush();
+  QByteArray output;
+  char buffer[4096];
+  ssize_t res;
+  while ((res = read(m_pipe[0], buffer, sizeof(buffer))) > 0) {
+    output.append(buffer, res);
+  }
+  return QString::fromUtf8(output);
+}
+
+void
+test_Debug::test_level() {
+  set_blight_debug_level(LOG_INFO);
+  QCOMPARE(get_blight_debug_level(), LOG_INFO);
+  auto env = getenv("DEBUG");
+  QByteArray debug = env == nullptr ? QByteArray() : QByteArray(env);
+  unsetenv("DEBUG");
+  QCOMPARE(blight_debug_level_from_environment(), LOG_WARNING);
+  for (auto value : {"0", "n", "No", "false"}) {
+    setenv("DEBUG", value, true);
+    QCOMPARE(blight_debug_level_from_environment(), LOG_WARNING);
+  }
+  setenv("DEBUG", "1", true);
+  QCOMPARE(blight_debug_level_from_environment(), LOG_DEBUG);
+  // Changing the environment doesn't change the current level
+  QCOMPARE(get_blight_debug_level(), LOG_INFO);
+  if (env == nullptr) {
+    unsetenv("DEBUG");
+  } else {
+    setenv("DEBUG", debug.constData(), true);
+  }
+}
+
+void
+test_Debug::test_log() {
+  set_blight_debug_level(LOG_INFO);
+  _DEBUG("hidden %d", 1);
+  _INFO("first %d", 1);
+  std::thread([] { _WARN("second %s", "thread"); }).join();
+  _CRIT("third");
+  auto output = capture();
+  QVERIFY(!output.contains("hidden"));
+  auto first = output.indexOf("] Info: first 1 (");
+  auto second = output.indexOf("] Warning: second thread (");
+  auto third = output.indexOf("] Critical: third (");
+  QVERIFY(first != -1);
+  QVERIFY(second != -1);
+  QVERIFY(third != -1);
+  // Critical messages write out everything queued before them first
+  QVERIFY(first < third);
+  QVERIFY(second < third);
+  QVERIFY(output.startsWith(QString("[%1:%2:").arg(getpgrp()).arg(getpid())));
+  QCOMPARE(output.count('\n'), 3);
+}
+
+void
+test_Debug::test_truncate() {
+  set_blight_debug_level(LOG_INFO);
+  std::string message(4096, 'x');
+  _INFO("%s", message.c_str());
+  auto output = capture();
+  QVERIFY(output.contains("xxx... ("));
+  QVERIFY(output.size() < 1024);
+  QCOMPARE(output.count('\n'), 1);
+}
+
+DECLARE_TEST(test_Debug)
@@ -0,0 +1,24 @@
+#pragma once
+#include "autotest.h"
+
+class test_Debug : public QObject {
+  Q_OBJECT
+
+public:
+  test_Debug();
+  ~test_Debug();
+
+private slots:
+  void init();
+  void cleanup();
+  void test_level();
+  void test_log();
+  void test_truncate();
+
+private:
+  int m_level;
+  int m_stderr;
+  int m_pipe[2];
+
+  QString capture();
+};
@@ -0,0 +1,85 @@
+#include "test_trace.h"
+
+#include <libblight/trace.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+using namespace Blight;
+
+test_Trace::test_Trace() {}
+test_Trace::~test_Trace() {}
+
+void
+test_Trace::cleanupTestCase() {
+  Trace::set_enabled(false);
+  Trace::remove(getpid());
+}
+
+void
+test_Trace::test_timestamp() {
+  timeval time{.tv_sec = 2, .tv_usec = 5};
+  QCOMPARE(Trace::timestamp(time), 2000005000ull);
+  QVERIFY(Trace::now() > 0);
+}
+
+void
+test_Trace::test_input() {
+  Trace::set_enabled(false);
+  timeval time{.tv_sec = 1, .tv_usec = 0};
+  Trace::input(Trace::EvdevRead, time);
+  QVERIFY(Trace::read(getpid()).empty());
+  Trace::set_enabled(true);
+  Trace::input(Trace::EvdevRead, time);
+  auto samples = Trace::read(getpid());
+  QCOMPARE(samples.size(), (size_t)1);
+  QCOMPARE(samples.front().stage, Trace::EvdevRead);
+  QCOMPARE(samples.front().input, 1000000000ull);
+  QVERIFY(samples.front().stamp >= samples.front().input);
+  auto pids = Trace::processes();
+  QVERIFY(std::find(pids.begin(), pids.end(), getpid()) != pids.end());
+}
+
+void
+test_Trace::test_mark() {
+  Trace::set_enabled(true);
+  auto before = Trace::read(getpid()).size();
+  timeval time{.tv_sec = 3, .tv_usec = 0};
+  Trace::input(Trace::ClientRead, time);
+  Trace::mark(Trace::RepaintSend);
+  Trace::mark(Trace::RepaintSend);
+  auto samples = Trace::read(getpid());
+  QCOMPARE(samples.size(), before + 2);
+  QCOMPARE(samples.back().stage, Trace::RepaintSend);
+  QCOMPARE(samples.back().input, 3000000000ull);
+}
+
+void
+test_Trace::test_markInput() {
+  Trace::set_enabled(true);
+  timeval time{.tv_sec = 4, .tv_usec = 0};
+  Trace::input(Trace::EvdevRead, time);
+  auto input = Trace::last_input();
+  QCOMPARE(input, 4000000000ull);
+  time.tv_sec = 5;
+  Trace::input(Trace::EvdevRead, time);
+  QCOMPARE(Trace::last_input(), 5000000000ull);
+  Trace::mark(Trace::UpdateComplete, input);
+  auto samples = Trace::read(getpid());
+  QCOMPARE(samples.back().stage, Trace::UpdateComplete);
+  QCOMPARE(samples.back().input, input);
+}
+
+void
+test_Trace::test_wrap() {
+  Trace::set_enabled(true);
+  for (uint32_t i = 0; i < Trace::capacity + 10; i++) {
+    timeval time{.tv_sec = (time_t)(i + 10), .tv_usec = 0};
+    Trace::input(Trace::RingInsert, time);
+  }
+  auto samples = Trace::read(getpid());
+  QCOMPARE(samples.size(), (size_t)Trace::capacity);
+  QCOMPARE(samples.back().input, (uint64_t)(Trace::capacity + 19) * 1000000000ull);
+}
+
+DECLARE_TEST(test_Trace)
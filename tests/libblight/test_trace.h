@@ -0,0 +1,18 @@
+#pragma once
+#include "autotest.h"
+
+class test_Trace : public QObject {
+  Q_OBJECT
+
+public:
+  test_Trace();
+  ~test_Trace();
+
+private slots:
+  void cleanupTestCase();
+  void test_timestamp();
+  void test_input();
+  void test_mark();
+  void test_markInput();
+  void test_wrap();
+};
@@ -7,7 +7,14 @@ test_Types::~test_Types() {}
 
 void
 test_Types::test_clipboard_t() {
-  // TODO - test to_string()
+  Blight::clipboard_t clipboard("clipboard");
+  QCOMPARE(clipboard.to_string(), std::string());
+  QCOMPARE(clipboard.mimeType, std::string("application/octet-stream"));
+  QCOMPARE(clipboard.generation, (uint64_t)0);
+  auto data = new unsigned char[4];
+  memcpy(data, "test", 4);
+  Blight::clipboard_t other("selection", data, 4);
+  QCOMPARE(other.to_string(), std::string("test"));
   // TODO - test update()
   // TODO - test set()
 }
@@ -0,0 +1,29 @@
+QT += testlib
+QT -= gui
+
+CONFIG += qt
+CONFIG += console
+CONFIG += warn_on
+CONFIG += depend_includepath
+CONFIG += testcase
+CONFIG += no_testcase_installs
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES +=  \
+    main.cpp \
+    test_fdtable.cpp \
+    ../../shared/libblight_client/fdtable.cpp
+
+HEADERS += \
+    autotest.h \
+    test_fdtable.h \
+    ../../shared/libblight_client/fdtable.h
+
+INCLUDEPATH += ../../shared/libblight_client
+
+include(../../qmake/common.pri)
+
+target.path = $$TESTS_INSTALL_PATH
+INSTALLS += target
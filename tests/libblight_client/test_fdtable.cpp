@@ -0,0 +1,189 @@
+#include "test_fdtable.h"
+
+#include <fdtable.h>
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using namespace Input;
+
+// Roughly what a Qt event loop polls: wakeup pipes, sockets, and the input
+// devices when they are open
+static const int BENCHMARK_FDS = 12;
+static const int BENCHMARK_INPUT_FDS = 3;
+static const int BENCHMARK_FIRST_FD = 3;
+static const int BENCHMARK_EVENT_FD = 100;
+
+// The std::map and mutex based translation that FdTable replaced
+static std::map<int, int> mapEventFds;
+static std::mutex mapMutex;
+
+static pollfd*
+mapTranslate(pollfd* fds, nfds_t nfds) {
+  std::scoped_lock lock(mapMutex);
+  auto size = sizeof(pollfd) * nfds;
+  auto* backup = (pollfd*)malloc(size);
+  memcpy(backup, fds, size);
+  for (nfds_t i = 0; i < nfds; i++) {
+    auto it = mapEventFds.find(fds[i].fd);
+    if (it != mapEventFds.end()) {
+      fds[i].fd = it->second;
+    }
+  }
+  return backup;
+}
+
+static void
+mapRestore(pollfd* fds, nfds_t nfds, pollfd* backup) {
+  for (nfds_t i = 0; i < nfds; i++) {
+    fds[i].fd = backup[i].fd;
+  }
+  free(backup);
+}
+
+test_FdTable::test_FdTable() {}
+test_FdTable::~test_FdTable() {}
+
+void
+test_FdTable::test_lookup() {
+  FdTable table;
+  QVERIFY(table.size() > 0);
+  QVERIFY(table.empty());
+  QCOMPARE(table.highest(), -1);
+  QCOMPARE(table.eventFd(5), -1);
+  QVERIFY(table.insert(5, 20));
+  QVERIFY(!table.empty());
+  QCOMPARE(table.highest(), 5);
+  QCOMPARE(table.eventFd(5), 20);
+  QCOMPARE(table.inputFd(20), 5);
+  QCOMPARE(table.eventFd(20), -1);
+  QCOMPARE(table.inputFd(5), -1);
+  // fd 0 and eventfd 0 are valid
+  QVERIFY(table.insert(0, 0));
+  QCOMPARE(table.eventFd(0), 0);
+  QCOMPARE(table.inputFd(0), 0);
+  QCOMPARE(table.highest(), 5);
+}
+
+void
+test_FdTable::test_remove() {
+  FdTable table;
+  // Two fds open on the same device share an eventfd
+  QVERIFY(table.insert(5, 20));
+  QVERIFY(table.insert(6, 20));
+  QCOMPARE(table.inputFd(20), 5);
+  table.remove(5, 6);
+  QCOMPARE(table.eventFd(5), -1);
+  QCOMPARE(table.inputFd(20), 6);
+  QVERIFY(!table.empty());
+  // Removing an fd that isn't the reverse entry leaves it alone
+  QVERIFY(table.insert(5, 20));
+  table.remove(5, 6);
+  QCOMPARE(table.inputFd(20), 6);
+  table.remove(6);
+  QCOMPARE(table.eventFd(6), -1);
+  QCOMPARE(table.inputFd(20), -1);
+  QVERIFY(table.empty());
+  // Removing twice doesn't underflow the count
+  table.remove(6);
+  QVERIFY(table.empty());
+}
+
+void
+test_FdTable::test_bounds() {
+  FdTable table;
+  int size = (int)table.size();
+  QVERIFY(!table.insert(-1, 20));
+  QVERIFY(!table.insert(5, -1));
+  QVERIFY(!table.insert(size, 20));
+  QVERIFY(!table.insert(5, size));
+  QVERIFY(table.empty());
+  QCOMPARE(table.eventFd(-1), -1);
+  QCOMPARE(table.eventFd(size), -1);
+  QCOMPARE(table.inputFd(size), -1);
+  QVERIFY(table.insert(size - 1, 20));
+  QCOMPARE(table.eventFd(size - 1), 20);
+  table.remove(size);
+  table.remove(-1);
+  QCOMPARE(table.eventFd(size - 1), 20);
+}
+
+void
+test_FdTable::test_translate() {
+  FdTable table;
+  // Larger than the stack backup, so that the heap backup is used too
+  for (nfds_t nfds : {(nfds_t)4, PollBackup::STACK_SIZE + 1}) {
+    std::vector<pollfd> fds(nfds);
+    for (nfds_t i = 0; i < nfds; i++) {
+      fds[i] = {.fd = (int)i + 3, .events = POLLIN, .revents = 0};
+    }
+    fds[1].fd = -1;
+    {
+      PollBackup backup;
+      QVERIFY(!table.translate(fds.data(), nfds, backup));
+    }
+    QVERIFY(table.insert(5, 40));
+    {
+      PollBackup backup;
+      QVERIFY(table.translate(fds.data(), nfds, backup));
+      QCOMPARE(fds[0].fd, 3);
+      QCOMPARE(fds[1].fd, -1);
+      QCOMPARE(fds[2].fd, 40);
+      fds[2].revents = POLLIN;
+      FdTable::restore(fds.data(), nfds, backup);
+    }
+    QCOMPARE(fds[1].fd, -1);
+    QCOMPARE(fds[2].fd, 5);
+    QCOMPARE(fds[2].revents, (short)POLLIN);
+    table.remove(5);
+  }
+}
+
+void
+test_FdTable::benchmark_translate_data() {
+  QTest::addColumn<bool>("table");
+  QTest::addColumn<bool>("inputs");
+  QTest::newRow("FdTable no input") << true << false;
+  QTest::newRow("FdTable input") << true << true;
+  QTest::newRow("std::map no input") << false << false;
+  QTest::newRow("std::map input") << false << true;
+}
+
+void
+test_FdTable::benchmark_translate() {
+  QFETCH(bool, table);
+  QFETCH(bool, inputs);
+  pollfd fds[BENCHMARK_FDS];
+  for (int i = 0; i < BENCHMARK_FDS; i++) {
+    fds[i] = {.fd = BENCHMARK_FIRST_FD + i, .events = POLLIN, .revents = 0};
+  }
+  FdTable fdTable;
+  mapEventFds.clear();
+  if (inputs) {
+    for (int i = 0; i < BENCHMARK_INPUT_FDS; i++) {
+      int fd = BENCHMARK_FIRST_FD + BENCHMARK_FDS - 1 - i;
+      QVERIFY(fdTable.insert(fd, BENCHMARK_EVENT_FD + i));
+      mapEventFds[fd] = BENCHMARK_EVENT_FD + i;
+    }
+  }
+  if (table) {
+    QBENCHMARK {
+      PollBackup backup;
+      if (fdTable.translate(fds, BENCHMARK_FDS, backup)) {
+        FdTable::restore(fds, BENCHMARK_FDS, backup);
+      }
+    }
+  } else {
+    QBENCHMARK {
+      mapRestore(fds, BENCHMARK_FDS, mapTranslate(fds, BENCHMARK_FDS));
+    }
+  }
+  // Translation must always be undone
+  for (int i = 0; i < BENCHMARK_FDS; i++) {
+    QCOMPARE(fds[i].fd, BENCHMARK_FIRST_FD + i);
+  }
+}
+
+DECLARE_TEST(test_FdTable)
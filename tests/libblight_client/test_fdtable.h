@@ -0,0 +1,18 @@
+#pragma once
+#include "autotest.h"
+
+class test_FdTable : public QObject {
+  Q_OBJECT
+
+public:
+  test_FdTable();
+  ~test_FdTable();
+
+private slots:
+  void test_lookup();
+  void test_remove();
+  void test_bounds();
+  void test_translate();
+  void benchmark_translate_data();
+  void benchmark_translate();
+};
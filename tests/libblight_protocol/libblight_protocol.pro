@@ -1,5 +1,5 @@
 QT += testlib
-QT -= gui
+QT += gui
 
 CONFIG += qt
 CONFIG += console
@@ -13,11 +13,17 @@ TEMPLATE = app
 
 SOURCES +=  \
     main.cpp \
-    test.c
+    test.c \
+    test_pixel.cpp \
+    test_ringbuffer.cpp \
+    test_socket.cpp
 
 HEADERS += \
     autotest.h \
-    test.h
+    test.h \
+    test_pixel.h \
+    test_ringbuffer.h \
+    test_socket.h
 
 QMAKE_CFLAGS_DEBUG += -save-temps
 
@@ -266,6 +266,49 @@ test_blight_cast_to_repaint_packet() {
   assert(packet->identifier == 0);
 }
 void
+test_blight_cast_to_repaint_region_packet() {
+  assert(blight_cast_to_repaint_region_packet(NULL) == NULL);
+  assert(errno == EINVAL);
+  blight_message_t message;
+  blight_header_t header;
+  header.type = Repaint;
+  header.ackid = 1;
+  header.size = 0;
+  message.header = header;
+  message.data = NULL;
+  assert(blight_cast_to_repaint_region_packet(&message) == NULL);
+  assert(errno == EINVAL);
+  message.header.type = RepaintRegion;
+  assert(blight_cast_to_repaint_region_packet(&message) == NULL);
+  assert(errno == ENODATA);
+  struct {
+    blight_packet_repaint_region_t packet;
+    blight_rect_t rects[2];
+  } data = {0};
+  data.packet.count = 2;
+  data.rects[1].x = 10;
+  data.rects[1].width = 20;
+  message.data = (blight_data_t)&data;
+  assert(blight_cast_to_repaint_region_packet(&message) == NULL);
+  assert(errno == EMSGSIZE);
+  message.header.size =
+    sizeof(blight_packet_repaint_region_t) + sizeof(blight_rect_t);
+  assert(blight_cast_to_repaint_region_packet(&message) == NULL);
+  assert(errno == EMSGSIZE);
+  message.header.size =
+    sizeof(blight_packet_repaint_region_t) + sizeof(blight_rect_t) * 2;
+  blight_packet_repaint_region_t* packet =
+    blight_cast_to_repaint_region_packet(&message);
+  assert(errno == 0);
+  assert(packet != NULL);
+  assert(packet->count == 2);
+  blight_rect_t* rects = blight_packet_repaint_region_rects(packet);
+  assert(rects != NULL);
+  assert(rects[0].x == 0);
+  assert(rects[1].x == 10);
+  assert(rects[1].width == 20);
+}
+void
 test_blight_cast_to_move_packet() {
   assert(blight_cast_to_move_packet(NULL) == NULL);
   assert(errno == EINVAL);
@@ -294,6 +337,40 @@ test_blight_cast_to_move_packet() {
   assert(packet->y == 0);
 }
 void
+test_blight_cast_to_ink_overlay_packet() {
+  assert(blight_cast_to_ink_overlay_packet(NULL) == NULL);
+  assert(errno == EINVAL);
+  blight_message_t message;
+  blight_header_t header;
+  header.type = Move;
+  header.ackid = 1;
+  header.size = 0;
+  message.header = header;
+  message.data = NULL;
+  assert(blight_cast_to_ink_overlay_packet(&message) == NULL);
+  assert(errno == EINVAL);
+  message.header.type = InkOverlay;
+  assert(blight_cast_to_ink_overlay_packet(&message) == NULL);
+  assert(errno == ENODATA);
+  blight_packet_ink_overlay_t data = {0};
+  data.identifier = 3;
+  data.enabled = 1;
+  data.width = 2;
+  data.prediction = 16;
+  message.data = (blight_data_t)&data;
+  assert(blight_cast_to_ink_overlay_packet(&message) == NULL);
+  assert(errno == EMSGSIZE);
+  message.header.size = sizeof(blight_packet_ink_overlay_t);
+  blight_packet_ink_overlay_t* packet =
+    blight_cast_to_ink_overlay_packet(&message);
+  assert(errno == 0);
+  assert(packet != NULL);
+  assert(packet->identifier == 3);
+  assert(packet->enabled == 1);
+  assert(packet->width == 2);
+  assert(packet->prediction == 16);
+}
+void
 test_blight_cast_to_surface_info_packet() {
   assert(blight_cast_to_surface_info_packet(NULL) == NULL);
   assert(errno == EINVAL);
@@ -664,7 +741,9 @@ test_c() {
     bus != NULL && buf != NULL
   );
   TEST(test_blight_cast_to_repaint_packet, true);
+  TEST(test_blight_cast_to_repaint_region_packet, true);
   TEST(test_blight_cast_to_move_packet, true);
+  TEST(test_blight_cast_to_ink_overlay_packet, true);
   TEST(test_blight_cast_to_surface_info_packet, true);
   TEST(test_blight_recv, true);
   TEST(test_blight_wait_for_read, true);
@@ -0,0 +1,296 @@
+#include "test_pixel.h"
+
+#include <libblight_protocol/pixel.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QRandomGenerator>
+
+using namespace BlightProtocol;
+
+// Size of the screen on the reMarkable
+static const QSize BENCHMARK_SIZE(1404, 1872);
+
+static QImage
+source(QSize size, bool opaque) {
+  QImage image(size, QImage::Format_ARGB32_Premultiplied);
+  QRandomGenerator random(42);
+  for (int y = 0; y < size.height(); y++) {
+    auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+    for (int x = 0; x < size.width(); x++) {
+      int a = opaque ? 255 : random.bounded(256);
+      line[x] = qRgba(
+        random.bounded(a + 1), random.bounded(a + 1), random.bounded(a + 1), a
+      );
+    }
+  }
+  return image;
+}
+
+static QImage
+destination(QSize size, QImage::Format format) {
+  QImage image(size, QImage::Format_RGB32);
+  QRandomGenerator random(7);
+  for (int y = 0; y < size.height(); y++) {
+    auto* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+    for (int x = 0; x < size.width(); x++) {
+      line[x] = random.generate() | 0xff000000;
+    }
+  }
+  return image.convertToFormat(format);
+}
+
+static int
+over(int s, int d, int a) {
+  return qMin(255, qRound(s + d * (255 - a) / 255.0));
+}
+
+static bool
+similar(QRgb a, QRgb b, int tolerance) {
+  return qAbs(qRed(a) - qRed(b)) <= tolerance &&
+         qAbs(qGreen(a) - qGreen(b)) <= tolerance &&
+         qAbs(qBlue(a) - qBlue(b)) <= tolerance;
+}
+
+// Width that isn't a multiple of 8 so the tail handling gets tested
+static const QSize TEST_SIZE(37, 5);
+
+test_Pixel::test_Pixel() {}
+test_Pixel::~test_Pixel() {}
+
+void
+test_Pixel::test_to_rgb16() {
+  auto src = source(TEST_SIZE, false);
+  QImage dst(TEST_SIZE, QImage::Format_RGB16);
+  for (int y = 0; y < TEST_SIZE.height(); y++) {
+    auto* in = reinterpret_cast<const uint32_t*>(src.constScanLine(y));
+    auto* out = reinterpret_cast<const uint16_t*>(dst.constScanLine(y));
+    Pixel::argb32pm_to_rgb16(
+      in, reinterpret_cast<uint16_t*>(dst.scanLine(y)), TEST_SIZE.width()
+    );
+    for (int x = 0; x < TEST_SIZE.width(); x++) {
+      uint16_t expected = ((qRed(in[x]) >> 3) << 11) |
+                          ((qGreen(in[x]) >> 2) << 5) | (qBlue(in[x]) >> 3);
+      QCOMPARE(out[x], expected);
+    }
+  }
+}
+
+void
+test_Pixel::test_to_rgb888() {
+  auto src = source(TEST_SIZE, false);
+  QImage dst(TEST_SIZE, QImage::Format_RGB888);
+  for (int y = 0; y < TEST_SIZE.height(); y++) {
+    auto* in = reinterpret_cast<const QRgb*>(src.constScanLine(y));
+    Pixel::argb32pm_to_rgb888(
+      reinterpret_cast<const uint32_t*>(in), dst.scanLine(y), TEST_SIZE.width()
+    );
+    for (int x = 0; x < TEST_SIZE.width(); x++) {
+      QRgb pixel = dst.pixel(x, y);
+      QCOMPARE(qRed(pixel), qRed(in[x]));
+      QCOMPARE(qGreen(pixel), qGreen(in[x]));
+      QCOMPARE(qBlue(pixel), qBlue(in[x]));
+    }
+  }
+}
+
+void
+test_Pixel::test_to_grayscale8() {
+  auto src = source(TEST_SIZE, true);
+  QImage dst(TEST_SIZE, QImage::Format_Grayscale8);
+  for (int y = 0; y < TEST_SIZE.height(); y++) {
+    auto* in = reinterpret_cast<const QRgb*>(src.constScanLine(y));
+    Pixel::argb32pm_to_grayscale8(
+      reinterpret_cast<const uint32_t*>(in), dst.scanLine(y), TEST_SIZE.width()
+    );
+    for (int x = 0; x < TEST_SIZE.width(); x++) {
+      QCOMPARE((int)dst.constScanLine(y)[x], qGray(in[x]));
+    }
+  }
+}
+
+void
+test_Pixel::test_over() {
+  auto src = source(TEST_SIZE, false);
+  auto dst = destination(TEST_SIZE, QImage::Format_ARGB32_Premultiplied);
+  auto expected = dst.copy();
+  for (int y = 0; y < TEST_SIZE.height(); y++) {
+    auto* in = reinterpret_cast<const QRgb*>(src.constScanLine(y));
+    Pixel::argb32pm_over(
+      reinterpret_cast<const uint32_t*>(in),
+      reinterpret_cast<uint32_t*>(dst.scanLine(y)),
+      TEST_SIZE.width()
+    );
+    auto* before = reinterpret_cast<const QRgb*>(expected.constScanLine(y));
+    auto* after = reinterpret_cast<const QRgb*>(dst.constScanLine(y));
+    for (int x = 0; x < TEST_SIZE.width(); x++) {
+      int a = qAlpha(in[x]);
+      QCOMPARE(qAlpha(after[x]), over(a, qAlpha(before[x]), a));
+      QCOMPARE(qRed(after[x]), over(qRed(in[x]), qRed(before[x]), a));
+      QCOMPARE(qGreen(after[x]), over(qGreen(in[x]), qGreen(before[x]), a));
+      QCOMPARE(qBlue(after[x]), over(qBlue(in[x]), qBlue(before[x]), a));
+    }
+  }
+}
+
+void
+test_Pixel::test_over_rgb16() {
+  auto src = source(TEST_SIZE, false);
+  auto dst = destination(TEST_SIZE, QImage::Format_RGB16);
+  auto expected = dst.copy();
+  QPainter painter(&expected);
+  painter.drawImage(0, 0, src);
+  painter.end();
+  for (int y = 0; y < TEST_SIZE.height(); y++) {
+    Pixel::argb32pm_over_rgb16(
+      reinterpret_cast<const uint32_t*>(src.constScanLine(y)),
+      reinterpret_cast<uint16_t*>(dst.scanLine(y)),
+      TEST_SIZE.width()
+    );
+    for (int x = 0; x < TEST_SIZE.width(); x++) {
+      // One step of the 5 bit channels
+      QVERIFY(similar(dst.pixel(x, y), expected.pixel(x, y), 8));
+    }
+  }
+}
+
+void
+test_Pixel::test_over_rgb888() {
+  auto src = source(TEST_SIZE, false);
+  auto dst = destination(TEST_SIZE, QImage::Format_RGB888);
+  auto expected = dst.copy();
+  QPainter painter(&expected);
+  painter.drawImage(0, 0, src);
+  painter.end();
+  for (int y = 0; y < TEST_SIZE.height(); y++) {
+    Pixel::argb32pm_over_rgb888(
+      reinterpret_cast<const uint32_t*>(src.constScanLine(y)),
+      dst.scanLine(y),
+      TEST_SIZE.width()
+    );
+    for (int x = 0; x < TEST_SIZE.width(); x++) {
+      QVERIFY(similar(dst.pixel(x, y), expected.pixel(x, y), 1));
+    }
+  }
+}
+
+void
+test_Pixel::test_over_grayscale8() {
+  auto src = source(TEST_SIZE, false);
+  auto dst = destination(TEST_SIZE, QImage::Format_Grayscale8);
+  auto expected = dst.copy();
+  for (int y = 0; y < TEST_SIZE.height(); y++) {
+    auto* in = reinterpret_cast<const QRgb*>(src.constScanLine(y));
+    Pixel::argb32pm_over_grayscale8(
+      reinterpret_cast<const uint32_t*>(in), dst.scanLine(y), TEST_SIZE.width()
+    );
+    for (int x = 0; x < TEST_SIZE.width(); x++) {
+      QCOMPARE(
+        (int)dst.constScanLine(y)[x],
+        over(qGray(in[x]), expected.constScanLine(y)[x], qAlpha(in[x]))
+      );
+    }
+  }
+}
+
+void
+test_Pixel::test_blit() {
+  QVERIFY(Pixel::supported(
+    BlightImageFormat::Format_ARGB32_Premultiplied,
+    BlightImageFormat::Format_RGB16
+  ));
+  QVERIFY(!Pixel::supported(
+    BlightImageFormat::Format_RGB16, BlightImageFormat::Format_RGB16
+  ));
+  QVERIFY(!Pixel::supported(
+    BlightImageFormat::Format_ARGB32_Premultiplied,
+    BlightImageFormat::Format_Mono
+  ));
+  // Blit a rectangle out of the middle of an image
+  auto src = source(TEST_SIZE, true);
+  auto dst = destination(TEST_SIZE, QImage::Format_RGB888);
+  auto expected = dst.copy();
+  QRect rect(3, 1, 20, 3);
+  QPainter painter(&expected);
+  painter.drawImage(rect, src, rect);
+  painter.end();
+  QVERIFY(Pixel::blit(
+    src.constBits() + rect.y() * src.bytesPerLine() + rect.x() * 4,
+    src.bytesPerLine(),
+    BlightImageFormat::Format_ARGB32_Premultiplied,
+    dst.bits() + rect.y() * dst.bytesPerLine() + rect.x() * 3,
+    dst.bytesPerLine(),
+    BlightImageFormat::Format_RGB888,
+    rect.width(),
+    rect.height(),
+    true
+  ));
+  QCOMPARE(dst, expected);
+  QVERIFY(!Pixel::blit(
+    dst.constBits(),
+    dst.bytesPerLine(),
+    BlightImageFormat::Format_RGB888,
+    dst.bits(),
+    dst.bytesPerLine(),
+    BlightImageFormat::Format_RGB888,
+    rect.width(),
+    rect.height(),
+    false
+  ));
+}
+
+void
+test_Pixel::benchmark_blit_data() {
+  QTest::addColumn<int>("format");
+  QTest::addColumn<bool>("blend");
+  QTest::addColumn<bool>("painter");
+  qDebug() << "Vectorized:" << Pixel::simd();
+  for (auto format :
+       {QImage::Format_RGB16,
+        QImage::Format_RGB888,
+        QImage::Format_Grayscale8,
+        QImage::Format_ARGB32_Premultiplied}) {
+    for (bool blend : {false, true}) {
+      auto name = QString("%1 %2").arg(format).arg(blend ? "over" : "copy");
+      QTest::newRow(qPrintable(name + " pixel"))
+        << (int)format << blend << false;
+      QTest::newRow(qPrintable(name + " QPainter"))
+        << (int)format << blend << true;
+    }
+  }
+}
+
+void
+test_Pixel::benchmark_blit() {
+  QFETCH(int, format);
+  QFETCH(bool, blend);
+  QFETCH(bool, painter);
+  auto src = source(BENCHMARK_SIZE, !blend);
+  auto dst = destination(BENCHMARK_SIZE, (QImage::Format)format);
+  if (painter) {
+    QBENCHMARK {
+      QPainter painter(&dst);
+      painter.setCompositionMode(
+        blend ? QPainter::CompositionMode_SourceOver
+              : QPainter::CompositionMode_Source
+      );
+      painter.drawImage(0, 0, src);
+    }
+    return;
+  }
+  QBENCHMARK {
+    Pixel::blit(
+      src.constBits(),
+      src.bytesPerLine(),
+      BlightImageFormat::Format_ARGB32_Premultiplied,
+      dst.bits(),
+      dst.bytesPerLine(),
+      (BlightImageFormat)format,
+      dst.width(),
+      dst.height(),
+      blend
+    );
+  }
+}
+
+DECLARE_TEST(test_Pixel)
@@ -0,0 +1,22 @@
+#pragma once
+#include "autotest.h"
+
+class test_Pixel : public QObject {
+  Q_OBJECT
+
+public:
+  test_Pixel();
+  ~test_Pixel();
+
+private slots:
+  void test_to_rgb16();
+  void test_to_rgb888();
+  void test_to_grayscale8();
+  void test_over();
+  void test_over_rgb16();
+  void test_over_rgb888();
+  void test_over_grayscale8();
+  void test_blit();
+  void benchmark_blit_data();
+  void benchmark_blit();
+};
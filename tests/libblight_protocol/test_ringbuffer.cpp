@@ -0,0 +1,94 @@
+#include "test_ringbuffer.h"
+
+#include <libblight_protocol/ringbuffer.h>
+
+#include <memory>
+
+using namespace BlightProtocol;
+
+static input_event
+event(int value) {
+  input_event ev{};
+  ev.type = EV_ABS;
+  ev.code = ABS_X;
+  ev.value = value;
+  return ev;
+}
+
+test_RingBuffer::test_RingBuffer() {}
+test_RingBuffer::~test_RingBuffer() {}
+
+void
+test_RingBuffer::test_capacity() {
+  QCOMPARE(
+    EvdevRingBuffer::normalize(0), (uint32_t)EVDEV_RING_BUFFER_MAX_SIZE
+  );
+  QCOMPARE(EvdevRingBuffer::normalize(1), 1u);
+  QCOMPARE(EvdevRingBuffer::normalize(100), 128u);
+  QCOMPARE(EvdevRingBuffer::normalize(256), 256u);
+  QCOMPARE(
+    EvdevRingBuffer::normalize(5000), (uint32_t)EVDEV_RING_BUFFER_MAX_SIZE
+  );
+  auto buffer = std::make_unique<EvdevRingBuffer>(true, 100);
+  QCOMPARE(buffer->capacity(), (size_t)128);
+  QVERIFY(buffer->empty());
+  QVERIFY(!buffer->full());
+}
+
+void
+test_RingBuffer::test_insert_range() {
+  auto buffer = std::make_unique<EvdevRingBuffer>(false, 8);
+  input_event events[5];
+  for (int i = 0; i < 5; i++) {
+    events[i] = event(i);
+  }
+  QCOMPARE(buffer->insert_range(events, 5), (size_t)5);
+  QCOMPARE(buffer->size(), (size_t)5);
+  for (int i = 0; i < 5; i++) {
+    auto maybe = buffer->take();
+    QVERIFY(maybe.has_value());
+    QCOMPARE(maybe.value().value, i);
+  }
+  QVERIFY(buffer->empty());
+  QCOMPARE(buffer->insert_range(events, 0), (size_t)0);
+  QVERIFY(buffer->empty());
+}
+
+void
+test_RingBuffer::test_take_many() {
+  auto buffer = std::make_unique<EvdevRingBuffer>(false, 8);
+  input_event out[8];
+  QCOMPARE(buffer->take_many(out, 8), (size_t)0);
+  // Wrap around the end of the buffer
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 6; i++) {
+      buffer->insert(event(round * 6 + i));
+    }
+    QCOMPARE(buffer->take_many(out, 4), (size_t)4);
+    QCOMPARE(buffer->take_many(&out[4], 8), (size_t)2);
+    for (int i = 0; i < 6; i++) {
+      QCOMPARE(out[i].value, round * 6 + i);
+    }
+  }
+  QVERIFY(buffer->empty());
+}
+
+void
+test_RingBuffer::test_dropped() {
+  auto buffer = std::make_unique<EvdevRingBuffer>(true, 4);
+  input_event events[3] = {event(0), event(1), event(2)};
+  QCOMPARE(buffer->insert_range(events, 3), (size_t)3);
+  QCOMPARE(buffer->dropped(), 0u);
+  // A frame that doesn't fit is dropped as a whole
+  QCOMPARE(buffer->insert_range(events, 2), (size_t)0);
+  QCOMPARE(buffer->dropped(), 2u);
+  QVERIFY(buffer->overflowed());
+  input_event out[4];
+  QCOMPARE(buffer->take_many(out, 4), (size_t)3);
+  QVERIFY(!buffer->overflowed());
+  QCOMPARE(out[2].value, 2);
+  QCOMPARE(buffer->insert_range(events, 2), (size_t)2);
+  QCOMPARE(buffer->dropped(), 2u);
+}
+
+DECLARE_TEST(test_RingBuffer)
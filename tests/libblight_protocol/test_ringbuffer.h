@@ -0,0 +1,16 @@
+#pragma once
+#include "autotest.h"
+
+class test_RingBuffer : public QObject {
+  Q_OBJECT
+
+public:
+  test_RingBuffer();
+  ~test_RingBuffer();
+
+private slots:
+  void test_capacity();
+  void test_insert_range();
+  void test_take_many();
+  void test_dropped();
+};
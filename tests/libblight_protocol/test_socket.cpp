@@ -0,0 +1,147 @@
+#include "test_socket.h"
+
+#include <libblight_protocol/pool.h>
+#include <libblight_protocol/socket.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+using namespace BlightProtocol;
+
+static std::vector<unsigned char>
+payload(unsigned int ackid, size_t size) {
+  std::vector<unsigned char> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = (ackid + i) & 0xff;
+  }
+  return data;
+}
+
+test_Socket::test_Socket() {}
+test_Socket::~test_Socket() {}
+
+void
+test_Socket::init() {
+  QVERIFY(socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+}
+
+void
+test_Socket::cleanup() {
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+void
+test_Socket::test_send_blocking_iovec() {
+  blight_header_t header{
+    .type = BlightMessageType::Ping, .ackid = 1, .size = 4
+  };
+  unsigned char data[] = {1, 2, 3, 4};
+  iovec iov[3];
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof(header);
+  iov[1].iov_base = nullptr;
+  iov[1].iov_len = 0;
+  iov[2].iov_base = data;
+  iov[2].iov_len = sizeof(data);
+  QVERIFY(send_blocking(fds[0], iov, 3));
+  unsigned char buf[sizeof(header) + sizeof(data)];
+  QCOMPARE(::recv(fds[1], buf, sizeof(buf), 0), (ssize_t)sizeof(buf));
+  QCOMPARE(memcmp(buf, &header, sizeof(header)), 0);
+  QCOMPARE(memcmp(&buf[sizeof(header)], data, sizeof(data)), 0);
+}
+
+void
+test_Socket::test_message_reader() {
+  MessageReader reader(fds[1], 256);
+  blight_header_t header;
+  blight_data_t data;
+  QCOMPARE(reader.next(&header, &data, 0), -EAGAIN);
+  for (unsigned int i = 1; i <= 20; i++) {
+    auto buf = payload(i, i % 5);
+    header = {.type = BlightMessageType::Ack, .ackid = i, .size = i % 5};
+    QVERIFY(send_blocking(fds[0], header, buf.empty() ? nullptr : buf.data()));
+  }
+  for (unsigned int i = 1; i <= 20; i++) {
+    QCOMPARE(reader.next(&header, &data, 0), 0);
+    QCOMPARE(header.type, BlightMessageType::Ack);
+    QCOMPARE(header.ackid, i);
+    QCOMPARE(header.size, i % 5);
+    if (!header.size) {
+      QVERIFY(data == nullptr);
+      continue;
+    }
+    QVERIFY(data != nullptr);
+    QCOMPARE(memcmp(data, payload(i, i % 5).data(), header.size), 0);
+    Pool::deallocate(data);
+  }
+  QCOMPARE(reader.buffered(), (size_t)0);
+  QCOMPARE(reader.next(&header, &data, 0), -EAGAIN);
+}
+
+void
+test_Socket::test_message_reader_large() {
+  MessageReader reader(fds[1], 256);
+  auto buf = payload(2, 1000);
+  blight_header_t header{
+    .type = BlightMessageType::Ack, .ackid = 1, .size = 0
+  };
+  QVERIFY(send_blocking(fds[0], header, nullptr));
+  header = {.type = BlightMessageType::Ack, .ackid = 2, .size = 1000};
+  QVERIFY(send_blocking(fds[0], header, buf.data()));
+  blight_data_t data;
+  QCOMPARE(reader.next(&header, &data, 0), 0);
+  QCOMPARE(header.ackid, 1u);
+  QCOMPARE(reader.next(&header, &data, 0), 0);
+  QCOMPARE(header.ackid, 2u);
+  QCOMPARE(header.size, 1000u);
+  QVERIFY(!Pool::owns(data));
+  QCOMPARE(memcmp(data, buf.data(), buf.size()), 0);
+  Pool::deallocate(data);
+  QCOMPARE(reader.buffered(), (size_t)0);
+}
+
+void
+test_Socket::test_message_reader_invalid() {
+  MessageReader reader(fds[1]);
+  blight_header_t header{
+    .type = BlightMessageType::Repaint, .ackid = 1, .size = 0
+  };
+  QCOMPARE(::send(fds[0], &header, sizeof(header), 0), (ssize_t)sizeof(header));
+  blight_data_t data;
+  QCOMPARE(reader.next(&header, &data, 0), -EBADMSG);
+  QVERIFY(data == nullptr);
+  QCOMPARE(reader.buffered(), (size_t)0);
+}
+
+void
+test_Socket::test_pool() {
+  size_t available = Pool::available();
+  void* small = Pool::allocate(Pool::block_size);
+  QVERIFY(Pool::owns(small));
+  QCOMPARE(Pool::available(), available - 1);
+  void* large = Pool::allocate(Pool::block_size + 1);
+  QVERIFY(!Pool::owns(large));
+  QCOMPARE(Pool::available(), available - 1);
+  Pool::deallocate(large);
+  Pool::deallocate(small);
+  QCOMPARE(Pool::available(), available);
+  // Freed blocks are reused
+  void* again = Pool::allocate(1);
+  QCOMPARE(again, small);
+  Pool::deallocate(again);
+  std::vector<void*> blocks;
+  for (size_t i = 0; i < Pool::block_count + 1; i++) {
+    blocks.push_back(Pool::allocate(1));
+  }
+  QCOMPARE(Pool::available(), (size_t)0);
+  QVERIFY(!Pool::owns(blocks.back()));
+  for (auto block : blocks) {
+    Pool::deallocate(block);
+  }
+  QCOMPARE(Pool::available(), Pool::block_count);
+}
+
+DECLARE_TEST(test_Socket)
@@ -0,0 +1,22 @@
+#pragma once
+#include "autotest.h"
+
+class test_Socket : public QObject {
+  Q_OBJECT
+
+public:
+  test_Socket();
+  ~test_Socket();
+
+private slots:
+  void init();
+  void cleanup();
+  void test_send_blocking_iovec();
+  void test_message_reader();
+  void test_message_reader_large();
+  void test_message_reader_invalid();
+  void test_pool();
+
+private:
+  int fds[2];
+};
@@ -13,9 +13,12 @@ TEMPLATE = app
 
 SOURCES += \
     main.cpp \
+    test_Applications.cpp \
     test_Debug.cpp \
     test_Event_Device.cpp \
     test_Json.cpp \
+    test_SysObject.cpp \
+    test_SysObjectWatcher.cpp \
     test_Threading.cpp
 
 include(../../qmake/common.pri)
@@ -28,7 +31,10 @@ DEFINES += TESTS_INSTALL_PATH=\\\"$$TESTS_INSTALL_PATH\\\"
 
 HEADERS += \
     autotest.h \
+    test_Applications.h \
     test_Debug.h \
     test_Event_Device.h \
     test_Json.h \
+    test_SysObject.h \
+    test_SysObjectWatcher.h \
     test_Threading.h
@@ -0,0 +1,154 @@
+#include "test_Applications.h"
+
+#include <liboxide/applications.h>
+#include <sys/stat.h>
+
+using namespace Oxide::Applications;
+
+test_Applications::test_Applications() {}
+test_Applications::~test_Applications() {}
+
+void
+test_Applications::write(const QString& path, const QByteArray& data) {
+  QFile file(path);
+  QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+  QCOMPARE(file.write(data), data.size());
+}
+
+void
+test_Applications::setMtime(const QString& path, const timespec& mtime) {
+  timespec times[2] = {mtime, mtime};
+  QCOMPARE(utimensat(AT_FDCWD, path.toLocal8Bit().constData(), times, 0), 0);
+}
+
+timespec
+test_Applications::getMtime(const QString& path) {
+  struct stat st;
+  if (stat(path.toLocal8Bit().constData(), &st) == -1) {
+    return timespec{0, 0};
+  }
+  return st.st_mtim;
+}
+
+void
+test_Applications::test_getRegistrations() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  auto cachePath = dir.filePath("oxide.cache");
+  write(
+    dir.filePath("a.oxide"), "{\"bin\":\"/bin/true\",\"flags\":[\"hidden\"]}"
+  );
+  write(dir.filePath("b.oxide"), "not json");
+  write(dir.filePath("c.txt"), "{\"bin\":\"/bin/true\"}");
+  auto registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations.size(), 2);
+  QCOMPARE(registrations[0].name, "a");
+  QCOMPARE(registrations[0].path, dir.filePath("a.oxide"));
+  QCOMPARE(registrations[0].properties["name"].toString(), "a");
+  QCOMPARE(registrations[0].properties["bin"].toString(), "/bin/true");
+  QCOMPARE(
+    registrations[0].properties["flags"].toStringList(),
+    QStringList() << "hidden"
+  );
+  QCOMPARE(registrations[1].name, "b");
+  QVERIFY(registrations[1].properties.isEmpty());
+  QCOMPARE(registrations[1].errors.size(), 1);
+  QCOMPARE(registrations[1].errors[0].level, ErrorLevel::Critical);
+  QVERIFY(QFile::exists(cachePath));
+  // Loading from the cache returns the same result
+  auto cached = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(cached.size(), 2);
+  QCOMPARE(cached[0].properties, registrations[0].properties);
+  QCOMPARE(cached[0].errors, registrations[0].errors);
+  QCOMPARE(cached[1].errors, registrations[1].errors);
+}
+
+void
+test_Applications::test_getRegistrations_cache() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  auto cachePath = dir.filePath("oxide.cache");
+  auto path = dir.filePath("a.oxide");
+  write(path, "{\"bin\":\"/bin/true\"}");
+  auto registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations.size(), 1);
+  QCOMPARE(registrations[0].properties["bin"].toString(), "/bin/true");
+  // Same size and mtime, so the cached entry is used without parsing
+  auto mtime = getMtime(path);
+  write(path, "{\"bin\":\"/bin/echo\"}");
+  setMtime(path, mtime);
+  registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations[0].properties["bin"].toString(), "/bin/true");
+  // A different mtime causes the file to be parsed again
+  mtime.tv_sec -= 10;
+  setMtime(path, mtime);
+  registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations[0].properties["bin"].toString(), "/bin/echo");
+  // As does a different size
+  write(path, "{\"bin\":\"/bin/false\"}");
+  setMtime(path, mtime);
+  registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations[0].properties["bin"].toString(), "/bin/false");
+  // New files are added and removed files are dropped
+  write(dir.filePath("b.oxide"), "{\"bin\":\"/bin/true\"}");
+  registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations.size(), 2);
+  QVERIFY(QFile::remove(path));
+  registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations.size(), 1);
+  QCOMPARE(registrations[0].name, "b");
+}
+
+void
+test_Applications::test_getRegistrations_revalidate() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  auto cachePath = dir.filePath("oxide.cache");
+  auto bin = dir.filePath("app");
+  write(
+    dir.filePath("a.oxide"), QString("{\"bin\":\"%1\"}").arg(bin).toUtf8()
+  );
+  auto registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations.size(), 1);
+  QVERIFY(!registrations[0].errors.isEmpty());
+  QCOMPARE(registrations[0].errors[0].level, ErrorLevel::Error);
+  // The registration is unchanged and comes from the cache, but is validated
+  // against the binary that now exists
+  write(bin, "#!/bin/sh\n");
+  QVERIFY(QFile::setPermissions(
+    bin, QFile::permissions(bin) | QFile::ExeOwner | QFile::ExeUser
+  ));
+  registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations.size(), 1);
+  for (auto& error : registrations[0].errors) {
+    QVERIFY(error.level != ErrorLevel::Error);
+  }
+  QCOMPARE(registrations[0].properties["bin"].toString(), bin);
+}
+
+void
+test_Applications::test_getRegistrations_invalidCache() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  auto cachePath = dir.filePath("oxide.cache");
+  write(dir.filePath("a.oxide"), "{\"bin\":\"/bin/true\"}");
+  const QList<QByteArray> invalid{
+    QByteArray(), QByteArray("garbage"), QByteArray(64, '\xff')
+  };
+  for (auto data : invalid) {
+    write(cachePath, data);
+    auto registrations = getRegistrations(dir.path(), cachePath);
+    QCOMPARE(registrations.size(), 1);
+    QCOMPARE(registrations[0].properties["bin"].toString(), "/bin/true");
+  }
+  // A truncated cache is rebuilt
+  QFile cache(cachePath);
+  QVERIFY(cache.open(QFile::ReadWrite));
+  QVERIFY(cache.resize(cache.size() / 2));
+  cache.close();
+  auto registrations = getRegistrations(dir.path(), cachePath);
+  QCOMPARE(registrations.size(), 1);
+  QCOMPARE(registrations[0].properties["bin"].toString(), "/bin/true");
+}
+
+DECLARE_TEST(test_Applications)
@@ -0,0 +1,23 @@
+#pragma once
+#include "autotest.h"
+
+#include <QTemporaryDir>
+
+class test_Applications : public QObject {
+  Q_OBJECT
+
+public:
+  test_Applications();
+  ~test_Applications();
+
+private slots:
+  void test_getRegistrations();
+  void test_getRegistrations_cache();
+  void test_getRegistrations_revalidate();
+  void test_getRegistrations_invalidCache();
+
+private:
+  static void write(const QString& path, const QByteArray& data);
+  static void setMtime(const QString& path, const timespec& mtime);
+  static timespec getMtime(const QString& path);
+};
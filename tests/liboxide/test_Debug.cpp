@@ -47,23 +47,41 @@ test_Debug::test_getDebugLocation() {
 void
 test_Debug::test_debugEnabled() {
   unsetenv("DEBUG");
+  Oxide::reloadDebugEnabled();
   QVERIFY(!Oxide::debugEnabled());
   ::setenv("DEBUG", "0", true);
+  Oxide::reloadDebugEnabled();
   QVERIFY(!Oxide::debugEnabled());
   ::setenv("DEBUG", "n", true);
+  Oxide::reloadDebugEnabled();
   QVERIFY(!Oxide::debugEnabled());
   ::setenv("DEBUG", "no", true);
+  Oxide::reloadDebugEnabled();
   QVERIFY(!Oxide::debugEnabled());
-  ::setenv("DEBUG", "false", true);
+  ::setenv("DEBUG", "FALSE", true);
+  Oxide::reloadDebugEnabled();
   QVERIFY(!Oxide::debugEnabled());
   ::setenv("DEBUG", "1", true);
+  // The environment is only read at startup or when asked to
+  QVERIFY(!Oxide::debugEnabled());
+  Oxide::reloadDebugEnabled();
+  QVERIFY(Oxide::debugEnabled());
+  Oxide::setDebugEnabled(false);
+  QVERIFY(!Oxide::debugEnabled());
+  Oxide::setDebugEnabled(true);
+  QVERIFY(Oxide::debugEnabled());
+  // The preload library changes the libblight level in its host
+  auto level = get_blight_debug_level();
+  set_blight_debug_level(0);
   QVERIFY(Oxide::debugEnabled());
+  set_blight_debug_level(level);
   // Cleanup
   if (envWasSet) {
     setenv("DEBUG", debug.c_str(), true);
   } else {
     unsetenv("DEBUG");
   }
+  Oxide::reloadDebugEnabled();
 }
 
 void
@@ -0,0 +1,171 @@
+#include "test_SysObject.h"
+
+#include <liboxide/sysobject.h>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+using Oxide::SysObject;
+
+// The QFile and QTextStream based read that SysObject used to do on every
+// call
+static int
+qfileIntProperty(const std::string& path) {
+  if (!QFile::exists(path.c_str())) {
+    return 0;
+  }
+  QFile file(path.c_str());
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return 0;
+  }
+  QTextStream in(&file);
+  std::string text = in.readLine().toStdString();
+  try {
+    return std::stoi(text);
+  } catch (const std::invalid_argument&) {
+    return 0;
+  }
+}
+
+test_SysObject::test_SysObject() {}
+test_SysObject::~test_SysObject() {}
+
+void
+test_SysObject::write(const QString& path, const QByteArray& data) {
+  QFile file(path);
+  QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+  QCOMPARE(file.write(data), data.size());
+}
+
+void
+test_SysObject::test_strProperty() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  SysObject object(dir.path());
+  write(dir.filePath("status"), "Charging\n");
+  QCOMPARE(object.strProperty("status"), std::string("Charging"));
+  // The file is kept open and read again from the start
+  write(dir.filePath("status"), "Discharging  \nsecond line\n");
+  QCOMPARE(object.strProperty("status"), std::string("Discharging"));
+  write(dir.filePath("status"), "");
+  QCOMPARE(object.strProperty("status"), std::string());
+  QCOMPARE(object.strProperty("missing"), std::string("0"));
+}
+
+void
+test_SysObject::test_intProperty() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  SysObject object(dir.path());
+  write(dir.filePath("capacity"), "42\n");
+  QCOMPARE(object.intProperty("capacity"), 42);
+  write(dir.filePath("capacity"), "  -7\n");
+  QCOMPARE(object.intProperty("capacity"), -7);
+  write(dir.filePath("capacity"), "100 trailing\n");
+  QCOMPARE(object.intProperty("capacity"), 100);
+  write(dir.filePath("capacity"), "Unknown\n");
+  QCOMPARE(object.intProperty("capacity"), 0);
+  write(dir.filePath("capacity"), "99999999999999999999\n");
+  QCOMPARE(object.intProperty("capacity"), 0);
+  QCOMPARE(object.intProperty("missing"), 0);
+}
+
+void
+test_SysObject::test_hasProperty() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  SysObject object(dir.path());
+  QVERIFY(object.exists());
+  QVERIFY(!object.hasProperty("capacity"));
+  write(dir.filePath("capacity"), "42\n");
+  QVERIFY(object.hasProperty("capacity"));
+  QCOMPARE(object.intProperty("capacity"), 42);
+  QVERIFY(object.hasProperty("capacity"));
+  QVERIFY(QDir(dir.path()).mkdir("power"));
+  QVERIFY(object.hasDirectory("power"));
+  QVERIFY(!object.hasDirectory("capacity"));
+}
+
+void
+test_SysObject::test_setProperty() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  SysObject object(dir.path());
+  write(dir.filePath("brightness"), "");
+  QVERIFY(object.setProperty("brightness", "10"));
+  QCOMPARE(object.intProperty("brightness"), 10);
+  QVERIFY(!object.setProperty("missing/brightness", "10"));
+}
+
+void
+test_SysObject::test_uevent() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  SysObject object(dir.path());
+  QVERIFY(object.uevent().isEmpty());
+  write(
+    dir.filePath("uevent"),
+    "USB_CHARGER_STATE=USB_CHARGER_PRESENT\nDRIVER=usbphy\ninvalid\n"
+  );
+  auto props = object.uevent();
+  QCOMPARE(props.size(), 2);
+  QCOMPARE(props["USB_CHARGER_STATE"], QString("USB_CHARGER_PRESENT"));
+  QCOMPARE(props["DRIVER"], QString("usbphy"));
+}
+
+void
+test_SysObject::test_copy() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  write(dir.filePath("capacity"), "42\n");
+  QList<SysObject> objects;
+  {
+    SysObject object(dir.path());
+    QCOMPARE(object.intProperty("capacity"), 42);
+    objects.append(object);
+  }
+  // Copies share the open files, and they stay valid after the original is
+  // gone
+  write(dir.filePath("capacity"), "41\n");
+  QCOMPARE(objects.first().intProperty("capacity"), 41);
+  for (SysObject object : objects) {
+    QCOMPARE(object.intProperty("capacity"), 41);
+  }
+}
+
+void
+test_SysObject::benchmark_intProperty_data() {
+  QTest::addColumn<bool>("cached");
+  QTest::newRow("SysObject") << true;
+  QTest::newRow("QFile") << false;
+}
+
+void
+test_SysObject::benchmark_intProperty() {
+  QFETCH(bool, cached);
+  // Prefer a real sysfs attribute, since that is what is read on device
+  QString path = "/sys/class/net/lo";
+  QString name = "mtu";
+  QTemporaryDir dir;
+  if (!QFile::exists(path + "/" + name)) {
+    QVERIFY(dir.isValid());
+    path = dir.path();
+    name = "capacity";
+    write(dir.filePath(name), "42\n");
+  }
+  SysObject object(path);
+  auto property = name.toStdString();
+  auto propertyPath = object.propertyPath(property);
+  int expected = qfileIntProperty(propertyPath);
+  QVERIFY(expected > 0);
+  int value = 0;
+  if (cached) {
+    QBENCHMARK { value = object.intProperty(property); }
+  } else {
+    QBENCHMARK { value = qfileIntProperty(propertyPath); }
+  }
+  QCOMPARE(value, expected);
+}
+
+DECLARE_TEST(test_SysObject)
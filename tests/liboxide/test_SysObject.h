@@ -0,0 +1,23 @@
+#pragma once
+#include "autotest.h"
+
+class test_SysObject : public QObject {
+  Q_OBJECT
+
+public:
+  test_SysObject();
+  ~test_SysObject();
+
+private slots:
+  void test_strProperty();
+  void test_intProperty();
+  void test_hasProperty();
+  void test_setProperty();
+  void test_uevent();
+  void test_copy();
+  void benchmark_intProperty_data();
+  void benchmark_intProperty();
+
+private:
+  static void write(const QString& path, const QByteArray& data);
+};
@@ -0,0 +1,113 @@
+#include "test_SysObjectWatcher.h"
+
+#include <liboxide/sysobjectwatcher.h>
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+using Oxide::SysObject;
+using Oxide::SysObjectWatcher;
+
+test_SysObjectWatcher::test_SysObjectWatcher() {}
+test_SysObjectWatcher::~test_SysObjectWatcher() {}
+
+void
+test_SysObjectWatcher::write(const QString& path, const QByteArray& data) {
+  QFile file(path);
+  QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+  QCOMPARE(file.write(data), data.size());
+}
+
+void
+test_SysObjectWatcher::test_watch() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  write(dir.filePath("capacity"), "42\n");
+  SysObjectWatcher watcher;
+  QVERIFY(watcher.watch(dir.filePath("capacity")));
+  QVERIFY(!watcher.watch(dir.filePath("missing")));
+  QCOMPARE(watcher.value(dir.filePath("capacity")), QByteArray("42"));
+  QCOMPARE(watcher.value(dir.filePath("missing")), QByteArray());
+  SysObject object(dir.path());
+  write(dir.filePath("status"), "Charging\n");
+  QVERIFY(watcher.watch(object, "status"));
+  QVERIFY(!watcher.watch(object, "missing"));
+  QCOMPARE(watcher.value(dir.filePath("status")), QByteArray("Charging"));
+}
+
+void
+test_SysObjectWatcher::test_refresh() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  write(dir.filePath("capacity"), "42\n");
+  write(dir.filePath("status"), "Charging\n");
+  SysObjectWatcher watcher;
+  QVERIFY(watcher.watch(dir.filePath("capacity")));
+  QVERIFY(watcher.watch(dir.filePath("status")));
+  QSignalSpy spy(&watcher, &SysObjectWatcher::changed);
+  QVERIFY(!watcher.refresh());
+  QCOMPARE(spy.count(), 0);
+  // The cached value is served until the attribute is read again
+  write(dir.filePath("capacity"), "41\n");
+  QCOMPARE(watcher.value(dir.filePath("capacity")), QByteArray("42"));
+  write(dir.filePath("status"), "Discharging\n");
+  QVERIFY(watcher.refresh());
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(watcher.value(dir.filePath("capacity")), QByteArray("41"));
+  QCOMPARE(watcher.value(dir.filePath("status")), QByteArray("Discharging"));
+  QVERIFY(!watcher.refresh());
+  QCOMPARE(spy.count(), 1);
+}
+
+void
+test_SysObjectWatcher::test_fallback() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  write(dir.filePath("capacity"), "42\n");
+  SysObjectWatcher watcher;
+  QCOMPARE(watcher.fallbackInterval(), 60 * 1000);
+  QVERIFY(watcher.watch(dir.filePath("capacity")));
+  QSignalSpy spy(&watcher, &SysObjectWatcher::changed);
+  watcher.setFallbackInterval(10);
+  QCOMPARE(watcher.fallbackInterval(), 10);
+  write(dir.filePath("capacity"), "41\n");
+  QVERIFY(spy.wait(1000));
+  QCOMPARE(watcher.value(dir.filePath("capacity")), QByteArray("41"));
+  watcher.setFallbackInterval(0);
+  write(dir.filePath("capacity"), "40\n");
+  QVERIFY(!spy.wait(100));
+  QCOMPARE(watcher.value(dir.filePath("capacity")), QByteArray("41"));
+}
+
+void
+test_SysObjectWatcher::test_enabled() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  write(dir.filePath("capacity"), "42\n");
+  SysObjectWatcher watcher;
+  QVERIFY(watcher.isEnabled());
+  QVERIFY(watcher.watch(dir.filePath("capacity")));
+  watcher.setFallbackInterval(10);
+  watcher.setEnabled(false);
+  QVERIFY(!watcher.isEnabled());
+  QSignalSpy spy(&watcher, &SysObjectWatcher::changed);
+  write(dir.filePath("capacity"), "41\n");
+  QVERIFY(!spy.wait(100));
+  QCOMPARE(watcher.value(dir.filePath("capacity")), QByteArray("42"));
+  // Changes while disabled are picked up straight away
+  watcher.setEnabled(true);
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(watcher.value(dir.filePath("capacity")), QByteArray("41"));
+}
+
+void
+test_SysObjectWatcher::test_watchLinks() {
+  SysObjectWatcher watcher;
+  QVERIFY(watcher.watchLinks());
+  // Only one socket is opened
+  QVERIFY(watcher.watchLinks());
+  watcher.setEnabled(false);
+  watcher.setEnabled(true);
+}
+
+DECLARE_TEST(test_SysObjectWatcher)
@@ -0,0 +1,20 @@
+#pragma once
+#include "autotest.h"
+
+class test_SysObjectWatcher : public QObject {
+  Q_OBJECT
+
+public:
+  test_SysObjectWatcher();
+  ~test_SysObjectWatcher();
+
+private slots:
+  void test_watch();
+  void test_refresh();
+  void test_fallback();
+  void test_enabled();
+  void test_watchLinks();
+
+private:
+  static void write(const QString& path, const QByteArray& data);
+};
@@ -0,0 +1,29 @@
+QT += testlib
+QT += gui
+
+CONFIG += qt
+CONFIG += console
+CONFIG += warn_on
+CONFIG += depend_includepath
+CONFIG += testcase
+CONFIG += no_testcase_installs
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+SOURCES +=  \
+    main.cpp \
+    test_framebuffersnapshot.cpp \
+    ../../applications/system-service/framebuffersnapshot.cpp
+
+HEADERS += \
+    autotest.h \
+    test_framebuffersnapshot.h \
+    ../../applications/system-service/framebuffersnapshot.h
+
+INCLUDEPATH += ../../applications/system-service
+
+include(../../qmake/common.pri)
+
+target.path = $$TESTS_INSTALL_PATH
+INSTALLS += target
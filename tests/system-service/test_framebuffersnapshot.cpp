@@ -0,0 +1,159 @@
+#include "test_framebuffersnapshot.h"
+
+#include <framebuffersnapshot.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Not a multiple of the tile size, so the right and bottom tiles are partial
+static const int IMAGE_WIDTH = FrameBufferSnapshot::TILE_SIZE + 36;
+static const int IMAGE_HEIGHT = FrameBufferSnapshot::TILE_SIZE + 6;
+
+// Pixels are set by writing the same byte to every byte of the pixel, so the
+// runs and literals are the same whatever the format is
+static void
+setPixel(QImage& image, int x, int y, uchar value) {
+  auto bpp = image.depth() / 8;
+  std::memset(image.scanLine(y) + x * bpp, value, bpp);
+}
+
+static void
+append(std::vector<uchar>& values, int count, uchar value) {
+  values.insert(values.end(), count, value);
+}
+
+static void
+appendLiterals(std::vector<uchar>& values, int count) {
+  // Neighbouring values always differ, so none of these form a run
+  for (int i = 0; i < count; i++) {
+    values.push_back(i % 2 ? 17 : 18 + i % 7);
+  }
+}
+
+// Contents of the first tile in the order the encoder reads it, one row of
+// the tile after the other
+static std::vector<uchar>
+firstTile() {
+  std::vector<uchar> values;
+  // Longer than the longest run, split into runs of 129, 129 and 42
+  append(values, 300, 255);
+  // Exactly the longest run
+  append(values, 129, 0);
+  // One pixel past the longest run, leaving a single literal
+  append(values, 130, 10);
+  // Shortest run
+  append(values, 3, 6);
+  // Exactly the most literals one control byte can hold
+  appendLiterals(values, 128);
+  append(values, 3, 1);
+  // One more literal than fits, so a second control byte is needed
+  appendLiterals(values, 129);
+  // Repeats too short to be a run are stored as literals
+  append(values, 3, 2);
+  append(values, 2, 3);
+  append(values, 1, 4);
+  append(values, 2, 5);
+  int size = FrameBufferSnapshot::TILE_SIZE * FrameBufferSnapshot::TILE_SIZE;
+  append(values, size - (int)values.size(), 200);
+  return values;
+}
+
+static QImage
+createImage(QImage::Format format) {
+  QImage image(IMAGE_WIDTH, IMAGE_HEIGHT, format);
+  auto values = firstTile();
+  const int tile = FrameBufferSnapshot::TILE_SIZE;
+  for (int y = 0; y < image.height(); y++) {
+    for (int x = 0; x < image.width(); x++) {
+      // Position within the tile, in the order the encoder reads it
+      int width = std::min(tile, image.width() - x / tile * tile);
+      int index = y % tile * width + x % tile;
+      uchar value;
+      if (x < tile && y < tile) {
+        value = values[index];
+      } else {
+        // Runs that continue from one row of a tile into the next
+        value = (index / 16) % 3 ? 255 : 40;
+      }
+      setPixel(image, x, y, value);
+    }
+  }
+  return image;
+}
+
+static bool
+sameContent(const QImage& a, const QImage& b) {
+  if (a.size() != b.size() || a.format() != b.format()) {
+    return false;
+  }
+  auto length = a.width() * a.depth() / 8;
+  for (int y = 0; y < a.height(); y++) {
+    if (std::memcmp(a.constScanLine(y), b.constScanLine(y), length)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+test_FrameBufferSnapshot::test_FrameBufferSnapshot() {}
+test_FrameBufferSnapshot::~test_FrameBufferSnapshot() {}
+
+void
+test_FrameBufferSnapshot::test_roundTrip_data() {
+  QTest::addColumn<int>("format");
+  QTest::newRow("Grayscale8") << (int)QImage::Format_Grayscale8;
+  QTest::newRow("RGB16") << (int)QImage::Format_RGB16;
+  QTest::newRow("RGB888") << (int)QImage::Format_RGB888;
+  QTest::newRow("ARGB32") << (int)QImage::Format_ARGB32;
+  QTest::newRow("RGBA64") << (int)QImage::Format_RGBA64;
+}
+
+void
+test_FrameBufferSnapshot::test_roundTrip() {
+  QFETCH(int, format);
+  auto image = createImage((QImage::Format)format);
+  FrameBufferSnapshot snapshot(image);
+  QVERIFY(snapshot.isValid());
+  QCOMPARE(
+    snapshot.size(), (qsizetype)IMAGE_WIDTH * IMAGE_HEIGHT * image.depth() / 8
+  );
+  // Every tile is mostly runs, so none of them are stored raw
+  QVERIFY(snapshot.compressedSize() < snapshot.size() / 4);
+  QImage restored(image.size(), image.format());
+  restored.fill(Qt::black);
+  QVERIFY(snapshot.restore(&restored));
+  QVERIFY(sameContent(image, restored));
+}
+
+void
+test_FrameBufferSnapshot::test_noise() {
+  QImage image(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_RGB16);
+  quint32 state = 1;
+  for (int y = 0; y < image.height(); y++) {
+    auto* line = image.scanLine(y);
+    for (int i = 0; i < image.width() * 2; i++) {
+      state = state * 1664525 + 1013904223;
+      line[i] = state >> 24;
+    }
+  }
+  FrameBufferSnapshot snapshot(image);
+  QVERIFY(snapshot.isValid());
+  // Tiles that would grow are kept raw
+  QCOMPARE(snapshot.compressedSize(), snapshot.size());
+  QImage restored(image.size(), image.format());
+  QVERIFY(snapshot.restore(&restored));
+  QVERIFY(sameContent(image, restored));
+}
+
+void
+test_FrameBufferSnapshot::test_invalid() {
+  FrameBufferSnapshot snapshot{QImage()};
+  QVERIFY(!snapshot.isValid());
+  QImage mono(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_Mono);
+  QVERIFY(!FrameBufferSnapshot(mono).isValid());
+  QImage image(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_RGB16);
+  QVERIFY(!snapshot.restore(&image));
+}
+
+DECLARE_TEST(test_FrameBufferSnapshot)
@@ -0,0 +1,16 @@
+#pragma once
+#include "autotest.h"
+
+class test_FrameBufferSnapshot : public QObject {
+  Q_OBJECT
+
+public:
+  test_FrameBufferSnapshot();
+  ~test_FrameBufferSnapshot();
+
+private slots:
+  void test_roundTrip_data();
+  void test_roundTrip();
+  void test_noise();
+  void test_invalid();
+};
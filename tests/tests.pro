@@ -2,8 +2,10 @@ TEMPLATE = subdirs
 
 SUBDIRS =  \
     libblight \
+    libblight_client \
     liboxide \
     libblight_protocol \
+    system-service \
     test_app
 
 INSTALLS += $$SUBDIRS